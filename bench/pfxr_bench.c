@@ -0,0 +1,544 @@
+// PFXR benchmark suite
+//
+// Measures template render throughput, the render stages in isolation, the
+// public API entry points, RNG throughput, URL and binary config round-trips
+// and the mixer. Results are printed as a table and can be written as JSON
+// for comparing runs.
+//
+// Usage: pfxr_bench [--seeds N] [--repeat N] [--json FILE]
+
+#define _POSIX_C_SOURCE 199309L
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_RESULTS 64
+#define STAGE_SAMPLES (1 << 20)
+
+typedef struct {
+    const char* group;
+    char name[32];
+    const char* unit;       // What one operation is
+    long ops;               // Operations per run
+    double seconds;         // Fastest run
+} bench_result_t;
+
+typedef long (*bench_fn)(void* arg);
+
+static bench_result_t results[MAX_RESULTS];
+static int result_count = 0;
+static int seed_count = 50;
+static int repeat_count = 5;
+
+static float* render_buffer;
+
+static const char* template_names[] = {
+    "default", "pickup", "laser", "jump", "fall", "powerup",
+    "explosion", "blip", "hit", "fart", "random"
+};
+#define TEMPLATE_COUNT ((int)(sizeof(template_names) / sizeof(template_names[0])))
+
+static const char* wave_names[] = { "sine", "sawtooth", "square", "triangle" };
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Run fn repeat_count times and record the fastest run
+static void run_bench(const char* group, const char* name, const char* unit, bench_fn fn, void* arg) {
+    if (result_count >= MAX_RESULTS) return;
+    
+    bench_result_t* r = &results[result_count++];
+    r->group = group;
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->unit = unit;
+    r->seconds = 0.0;
+    r->ops = 0;
+    
+    fn(arg); // warm up
+    for (int i = 0; i < repeat_count; i++) {
+        double start = now_seconds();
+        long ops = fn(arg);
+        double elapsed = now_seconds() - start;
+        if (i == 0 || elapsed < r->seconds) r->seconds = elapsed;
+        r->ops = ops;
+    }
+    
+    double ns = r->ops > 0 ? r->seconds * 1e9 / (double)r->ops : 0.0;
+    printf("  %-10s %-20s %10.2f ns/%-9s %12.0f %s/s\n", group, name, ns, unit,
+           r->seconds > 0.0 ? (double)r->ops / r->seconds : 0.0, unit);
+}
+
+// ============================================================================
+// TEMPLATES AND API
+// ============================================================================
+
+static long bench_template(void* arg) {
+    pfxr_template_t template = *(const pfxr_template_t*)arg;
+    pfxr_audio_buffer_t buffer = { render_buffer, 0, PFXR_MAX_SAMPLES, 0 };
+    long samples = 0;
+    
+    for (int seed = 1; seed <= seed_count; seed++) {
+        pfxr_sound_t config = pfxr_apply_template(template, seed);
+        pfxr_generate_sound(&config, &buffer);
+        samples += buffer.sample_count;
+    }
+    return samples;
+}
+
+static long bench_apply_template(void* arg) {
+    volatile float sink = 0.0f;
+    long calls = 0;
+    (void)arg;
+    
+    for (int seed = 1; seed <= seed_count * 20; seed++) {
+        for (int t = 0; t < TEMPLATE_COUNT; t++) {
+            pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)t, seed);
+            sink += config.frequency;
+            calls++;
+        }
+    }
+    return calls;
+}
+
+typedef struct {
+    int sample_count;
+    pfxr_sample_format_t format;
+} wav_bench_t;
+
+static long bench_create_wav_data(void* arg) {
+    const wav_bench_t* bench = (const wav_bench_t*)arg;
+    int sample_count = bench->sample_count;
+    long samples = 0;
+    
+    for (int i = 0; i < seed_count; i++) {
+        int size = 0;
+        char* wav = pfxr_create_wav_data_format(render_buffer, sample_count, 0, bench->format, &size);
+        if (!wav) break;
+        pfxr_free_wav_data(wav);
+        samples += sample_count;
+    }
+    return samples;
+}
+
+// Dithered conversion alone, into a reused buffer
+static long bench_convert_dither(void* arg) {
+    const wav_bench_t* bench = (const wav_bench_t*)arg;
+    int sample_count = bench->sample_count;
+    void* pcm = malloc((size_t)sample_count * pfxr_sample_size(bench->format));
+    long samples = 0;
+    if (!pcm) return 0;
+    
+    pfxr_dither_t dither;
+    pfxr_dither_init(&dither, 1);
+    for (int i = 0; i < seed_count; i++) {
+        pfxr_convert_samples_dither(render_buffer, pcm, sample_count, bench->format, &dither);
+        samples += sample_count;
+    }
+    free(pcm);
+    return samples;
+}
+
+// Lookups of sounds already in the cache
+static long bench_cache_hit(void* arg) {
+    pfxr_cache_t* cache = (pfxr_cache_t*)arg;
+    long calls = 0;
+    
+    for (int seed = 1; seed <= seed_count; seed++) {
+        const pfxr_cached_sound_t* sound = pfxr_cache_get_template(cache, PFXR_TEMPLATE_EXPLOSION, seed);
+        if (!sound) break;
+        pfxr_cache_release(cache, sound);
+        calls++;
+    }
+    return calls;
+}
+
+static long bench_create_sound(void* arg) {
+    pfxr_template_t template = *(const pfxr_template_t*)arg;
+    long samples = 0;
+    
+    for (int seed = 1; seed <= seed_count; seed++) {
+        pfxr_sound_t config = pfxr_apply_template(template, seed);
+        char* wav = pfxr_create_sound_from_config(&config);
+        if (!wav) break;
+        pfxr_free_wav_data(wav);
+        samples += pfxr_sound_sample_count(&config);
+    }
+    return samples;
+}
+
+typedef struct {
+    pfxr_timeline_event_t* events;
+    int count;
+    float* track;
+    int length;
+} timeline_bench_t;
+
+// Overlapping sounds 50 ms apart mixed into one track on the calling thread
+static long bench_timeline(void* arg) {
+    timeline_bench_t* timeline = (timeline_bench_t*)arg;
+    long samples = 0;
+    
+    if (pfxr_render_timeline(timeline->events, timeline->count, 0, timeline->track, timeline->length, 1) < 0) {
+        return 0;
+    }
+    for (int i = 0; i < timeline->count; i++) {
+        samples += pfxr_sound_sample_count(&timeline->events[i].config);
+    }
+    return samples;
+}
+
+// ============================================================================
+// STAGES
+// ============================================================================
+
+// The stage benchmarks call the generator's internal stage functions on a
+// sound that enables every effect, one 64-sample block at a time
+
+typedef struct {
+    pfxr_generator_t gen;
+    float history[PFXR_PHASER_HISTORY];
+} stage_bench_t;
+
+static stage_bench_t stage_state;
+
+static void stage_reset(int wave) {
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = wave;
+    config.sustainTime = 2.0f;
+    config.pitchDelta = 400.0f;
+    config.vibratoRate = 12.0f;
+    config.vibratoDepth = 30.0f;
+    config.tremoloRate = 8.0f;
+    config.tremoloDepth = 0.5f;
+    config.noiseAmount = 20.0f;
+    config.lowPassCutoff = 2000.0f;
+    config.highPassCutoff = 200.0f;
+    config.phaserBaseFrequency = 400.0f;
+    config.phaserLfoFrequency = 3.0f;
+    config.phaserDepth = 300.0f;
+    
+    pfxr_generator_init(&stage_state.gen, &config);
+}
+
+// Start sample of the i-th block, cycling through the sound
+static int stage_start(int block) {
+    int blocks = stage_state.gen.total_samples / PFXR_OSC_BLOCK;
+    return (block % blocks) * PFXR_OSC_BLOCK;
+}
+
+static long bench_stage_envelope(void* arg) {
+    float envelopes[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_envelope(&stage_state.gen, envelopes, stage_start(b), PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_frequency(void* arg) {
+    float freqs[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_frequency(&stage_state.gen, freqs, stage_start(b), PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_lfo(void* arg) {
+    float values[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_lfo(&stage_state.gen, &stage_state.gen.tremolo, values, PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_oscillator(void* arg) {
+    float freqs[PFXR_OSC_BLOCK];
+    float samples[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int k = 0; k < PFXR_OSC_BLOCK; k++) freqs[k] = 440.0f + (float)k;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_oscillator(&stage_state.gen, freqs, samples, PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_noise(void* arg) {
+    float samples[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        for (int k = 0; k < PFXR_OSC_BLOCK; k++) samples[k] = (k & 8) ? 0.5f : -0.5f;
+        stage_noise(&stage_state.gen, samples, PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_biquad(void* arg) {
+    float samples[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        for (int k = 0; k < PFXR_OSC_BLOCK; k++) samples[k] = (k & 8) ? 0.5f : -0.5f;
+        stage_biquad(&stage_state.gen.lowpass, samples, PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_output(void* arg) {
+    float samples[PFXR_OSC_BLOCK];
+    float envelopes[PFXR_OSC_BLOCK];
+    float out[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int k = 0; k < PFXR_OSC_BLOCK; k++) {
+        samples[k] = (k & 8) ? 0.5f : -0.5f;
+        envelopes[k] = 0.8f;
+    }
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_output(&stage_state.gen, samples, envelopes, out, PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_stage_phaser(void* arg) {
+    float samples[PFXR_OSC_BLOCK];
+    float envelopes[PFXR_OSC_BLOCK];
+    float out[PFXR_OSC_BLOCK];
+    (void)arg;
+    for (int k = 0; k < PFXR_OSC_BLOCK; k++) {
+        samples[k] = (k & 8) ? 0.5f : -0.5f;
+        envelopes[k] = 0.8f;
+    }
+    for (int b = 0; b < STAGE_SAMPLES / PFXR_OSC_BLOCK; b++) {
+        stage_phaser_output(&stage_state.gen, samples, envelopes, out, stage_start(b), PFXR_OSC_BLOCK);
+    }
+    return STAGE_SAMPLES;
+}
+
+// ============================================================================
+// RNG AND URL
+// ============================================================================
+
+static long bench_random(void* arg) {
+    pfxr_random_t rng;
+    volatile float sink = 0.0f;
+    (void)arg;
+    
+    pfxr_random_init(&rng, 12345);
+    for (int i = 0; i < STAGE_SAMPLES; i++) {
+        sink += pfxr_random_float(&rng, -1.0f, 1.0f);
+    }
+    return STAGE_SAMPLES;
+}
+
+static long bench_url_roundtrip(void* arg) {
+    long roundtrips = 0;
+    (void)arg;
+    
+    for (int seed = 1; seed <= seed_count * 4; seed++) {
+        pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)(seed % TEMPLATE_COUNT), seed);
+        char* url = pfxr_get_url_from_params(&config);
+        if (!url) break;
+        pfxr_sound_t* parsed = pfxr_create_params_from_url(url);
+        PFXR_FREE(url);
+        if (!parsed) break;
+        pfxr_free_sound_config(parsed);
+        roundtrips++;
+    }
+    return roundtrips;
+}
+
+static long bench_codec_roundtrip(void* arg) {
+    pfxr_codec_mode_t mode = *(const pfxr_codec_mode_t*)arg;
+    unsigned char data[PFXR_CODEC_LOSSLESS_SIZE];
+    volatile float sink = 0.0f;
+    long roundtrips = 0;
+    
+    for (int seed = 1; seed <= seed_count * 4; seed++) {
+        pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)(seed % TEMPLATE_COUNT), seed);
+        int size = pfxr_sound_encode(&config, mode, data, sizeof(data));
+        pfxr_sound_t decoded;
+        if (pfxr_sound_decode(data, size, &decoded) != size) break;
+        sink += decoded.volume;
+        roundtrips++;
+    }
+    return roundtrips;
+}
+
+// 32 overlapping sounds mixed in 256-frame blocks until all have finished
+static long bench_mixer(void* arg) {
+    pfxr_mixer_t* mixer = (pfxr_mixer_t*)arg;
+    long frames = 0;
+    
+    for (int i = 0; i < 32; i++) {
+        pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)(i % TEMPLATE_COUNT), i + 1);
+        pfxr_mixer_trigger(mixer, &config, 0.25f, (float)(i % 5 - 2) * 0.5f, 0);
+    }
+    while (pfxr_mixer_render(mixer, render_buffer, 256) > 0) frames += 256;
+    return frames;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static int write_json(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) return -1;
+    
+    fprintf(file, "{\n");
+    fprintf(file, "  \"seeds\": %d,\n", seed_count);
+    fprintf(file, "  \"repeat\": %d,\n", repeat_count);
+#ifdef PFXR_SINE_FAST
+    fprintf(file, "  \"sine\": \"fast\",\n");
+#else
+    fprintf(file, "  \"sine\": \"exact\",\n");
+#endif
+#ifdef PFXR_NO_SIMD
+    fprintf(file, "  \"simd\": false,\n");
+#else
+    fprintf(file, "  \"simd\": true,\n");
+#endif
+    fprintf(file, "  \"control_interval\": %d,\n", PFXR_CONTROL_INTERVAL);
+    fprintf(file, "  \"results\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const bench_result_t* r = &results[i];
+        double ns = r->ops > 0 ? r->seconds * 1e9 / (double)r->ops : 0.0;
+        double rate = r->seconds > 0.0 ? (double)r->ops / r->seconds : 0.0;
+        fprintf(file, "    {\"group\": \"%s\", \"name\": \"%s\", \"unit\": \"%s\", "
+                "\"ops\": %ld, \"seconds\": %.9f, \"ns_per_op\": %.3f, \"ops_per_second\": %.1f}%s\n",
+                r->group, r->name, r->unit, r->ops, r->seconds, ns, rate,
+                i + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--seeds N] [--repeat N] [--json FILE]\n", program);
+}
+
+int main(int argc, char** argv) {
+    const char* json_file = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seeds") == 0 && i + 1 < argc) {
+            seed_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_file = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (seed_count < 1) seed_count = 1;
+    if (repeat_count < 1) repeat_count = 1;
+    
+    render_buffer = (float*)malloc(PFXR_MAX_SAMPLES * sizeof(float));
+    if (!render_buffer) return 1;
+    
+    printf("PFXR benchmark (%d seeds, best of %d runs)\n", seed_count, repeat_count);
+    printf("===========================================\n");
+    
+    printf("\nTemplates (pfxr_apply_template + pfxr_generate_sound):\n");
+    pfxr_template_t templates[TEMPLATE_COUNT];
+    for (int t = 0; t < TEMPLATE_COUNT; t++) {
+        templates[t] = (pfxr_template_t)t;
+        run_bench("template", template_names[t], "sample", bench_template, &templates[t]);
+    }
+    
+    printf("\nAPI:\n");
+    run_bench("api", "apply_template", "call", bench_apply_template, NULL);
+    int wav_samples = PFXR_SAMPLE_RATE;
+    for (int i = 0; i < wav_samples; i++) render_buffer[i] = (float)(i % 200) / 100.0f - 1.0f;
+    wav_bench_t wav_formats[] = {
+        { wav_samples, PFXR_FORMAT_PCM16 }, { wav_samples, PFXR_FORMAT_FLOAT32 },
+        { wav_samples, PFXR_FORMAT_PCM8 }, { wav_samples, PFXR_FORMAT_PCM24 }
+    };
+    run_bench("api", "create_wav_data", "sample", bench_create_wav_data, &wav_formats[0]);
+    run_bench("api", "create_wav_float", "sample", bench_create_wav_data, &wav_formats[1]);
+    run_bench("api", "create_wav_pcm8", "sample", bench_create_wav_data, &wav_formats[2]);
+    run_bench("api", "create_wav_pcm24", "sample", bench_create_wav_data, &wav_formats[3]);
+    run_bench("api", "convert_dither_pcm16", "sample", bench_convert_dither, &wav_formats[0]);
+    run_bench("api", "create_sound_explosion", "sample", bench_create_sound, &templates[PFXR_TEMPLATE_EXPLOSION]);
+    timeline_bench_t timeline;
+    timeline.count = seed_count * 4;
+    timeline.events = (pfxr_timeline_event_t*)malloc(timeline.count * sizeof(pfxr_timeline_event_t));
+    if (timeline.events) {
+        for (int i = 0; i < timeline.count; i++) {
+            timeline.events[i].offset = i * (PFXR_SAMPLE_RATE / 20);
+            timeline.events[i].gain = 0.25f;
+            timeline.events[i].config = pfxr_apply_template((pfxr_template_t)(i % TEMPLATE_COUNT), i + 1);
+        }
+        timeline.length = pfxr_timeline_length(timeline.events, timeline.count, 0);
+        timeline.track = (float*)malloc((size_t)timeline.length * sizeof(float));
+        if (timeline.track) {
+            run_bench("api", "render_timeline", "sample", bench_timeline, &timeline);
+        }
+        free(timeline.track);
+        free(timeline.events);
+    }
+    pfxr_cache_t* cache = pfxr_cache_create((size_t)1 << 30);
+    if (cache) {
+        bench_cache_hit(cache);
+        run_bench("api", "cache_hit_explosion", "call", bench_cache_hit, cache);
+        pfxr_cache_destroy(cache);
+    }
+    
+    printf("\nStages (%d-sample blocks):\n", PFXR_OSC_BLOCK);
+    stage_reset(PFXR_WAVE_SINE);
+    run_bench("stage", "envelope", "sample", bench_stage_envelope, NULL);
+    run_bench("stage", "frequency", "sample", bench_stage_frequency, NULL);
+    run_bench("stage", "lfo", "sample", bench_stage_lfo, NULL);
+    for (int w = 0; w < 4; w++) {
+        char name[32];
+        snprintf(name, sizeof(name), "oscillator_%s", wave_names[w]);
+        stage_reset(w);
+        run_bench("stage", name, "sample", bench_stage_oscillator, NULL);
+    }
+    run_bench("stage", "noise", "sample", bench_stage_noise, NULL);
+    run_bench("stage", "biquad", "sample", bench_stage_biquad, NULL);
+    run_bench("stage", "output_tremolo", "sample", bench_stage_output, NULL);
+    pfxr_generator_set_history(&stage_state.gen, stage_state.history, PFXR_PHASER_HISTORY);
+    run_bench("stage", "phaser_output", "sample", bench_stage_phaser, NULL);
+    
+    printf("\nMisc:\n");
+    run_bench("misc", "random_float", "call", bench_random, NULL);
+    run_bench("misc", "url_roundtrip", "roundtrip", bench_url_roundtrip, NULL);
+    pfxr_mixer_t* mixer = pfxr_mixer_create(32, 0);
+    if (mixer) {
+        run_bench("misc", "mixer_32_voices", "frame", bench_mixer, mixer);
+        pfxr_mixer_destroy(mixer);
+    }
+    pfxr_codec_mode_t lossless = PFXR_CODEC_LOSSLESS, quantized = PFXR_CODEC_QUANTIZED;
+    run_bench("misc", "codec_lossless", "roundtrip", bench_codec_roundtrip, &lossless);
+    run_bench("misc", "codec_quantized", "roundtrip", bench_codec_roundtrip, &quantized);
+    
+    // A benchmark that did no work failed to render or allocate
+    int idle = 0;
+    for (int i = 0; i < result_count; i++) {
+        if (results[i].ops <= 0) {
+            fprintf(stderr, "Benchmark %s/%s did no work\n", results[i].group, results[i].name);
+            idle++;
+        }
+    }
+    
+    if (json_file) {
+        if (write_json(json_file) != 0) {
+            fprintf(stderr, "Failed to write %s\n", json_file);
+            return 1;
+        }
+        printf("\nWrote %s\n", json_file);
+    }
+    
+    free(render_buffer);
+    return idle ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Route the library's heap calls through counters, optionally filling new
+// blocks with garbage so fields left uninitialized show
+static int heap_allocs = 0;
+static int heap_frees = 0;
+static int heap_garbage = 0;
+
+static void* counted_malloc(size_t size) {
+    heap_allocs++;
+    void* ptr = malloc(size);
+    if (ptr && heap_garbage) memset(ptr, 0x41, size);
+    return ptr;
+}
+
+static void* counted_realloc(void* ptr, size_t size) {
+    if (!ptr) heap_allocs++;
+    return realloc(ptr, size);
+}
+
+static void counted_free(void* ptr) {
+    if (ptr) heap_frees++;
+    free(ptr);
+}
+
+#define PFXR_MALLOC(size) counted_malloc(size)
+#define PFXR_REALLOC(ptr, size) counted_realloc(ptr, size)
+#define PFXR_FREE(ptr) counted_free(ptr)
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+
+// Allocator callbacks that count what passes through them
+typedef struct {
+    int allocs;
+    int frees;
+} tally_t;
+
+static void* tally_alloc(void* user, size_t size) {
+    ((tally_t*)user)->allocs++;
+    return malloc(size);
+}
+
+static void* tally_realloc(void* user, void* ptr, size_t size) {
+    if (!ptr) ((tally_t*)user)->allocs++;
+    return realloc(ptr, size);
+}
+
+static void tally_free(void* user, void* ptr) {
+    if (ptr) ((tally_t*)user)->frees++;
+    free(ptr);
+}
+
+static void test_macros(void) {
+    printf("\nPFXR_MALLOC, PFXR_REALLOC and PFXR_FREE\n");
+    
+    heap_allocs = heap_frees = 0;
+    pfxr_free_wav_data(pfxr_create_sound_from_template(PFXR_TEMPLATE_EXPLOSION, 2));
+    pfxr_free_audio_buffer(pfxr_create_audio_buffer(1024));
+    pfxr_free_sound_config(pfxr_create_params_from_url("?fx=1,0.5,0,0.1,0,0.2,440"));
+    
+    pfxr_sound_t configs[4];
+    for (int i = 0; i < 4; i++) configs[i] = pfxr_apply_template(PFXR_TEMPLATE_RANDOM, i + 1);
+    pfxr_free_batch(pfxr_render_batch(configs, 4, NULL), 4);
+    
+    check(heap_allocs > 0, "allocations go through PFXR_MALLOC");
+    check(heap_allocs == heap_frees, "every allocation is freed through PFXR_FREE");
+}
+
+static void test_uninitialized(void) {
+    printf("\nNew objects do not depend on heap contents\n");
+    
+    heap_garbage = 1;
+    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
+    heap_garbage = 0;
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    int ok = buffer && buffer->sample_count == 0 && buffer->sample_rate == 0;
+    if (ok) {
+        pfxr_generate_sound(&config, buffer);
+        ok = buffer->sample_count == pfxr_sound_sample_count(&config);
+    }
+    check(ok, "pfxr_generate_sound on a new audio buffer renders at PFXR_SAMPLE_RATE");
+    pfxr_free_audio_buffer(buffer);
+}
+
+static void test_allocator_context(void) {
+    printf("\nAllocator callbacks\n");
+    
+    tally_t tally = { 0, 0 };
+    pfxr_allocator_t allocator = { tally_alloc, tally_realloc, tally_free, &tally };
+    pfxr_context_t ctx;
+    pfxr_context_init(&ctx, &allocator);
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_LASER, 4);
+    char* expected = pfxr_create_sound_from_config(&config);
+    heap_allocs = heap_frees = 0;
+    
+    int size = 0;
+    char* wav = pfxr_create_sound_from_config_ctx(&ctx, &config, &size);
+    check(wav && expected && memcmp(wav, expected, size) == 0, "output matches the default allocator");
+    pfxr_context_free(&ctx, wav);
+    
+    char* url = pfxr_get_url_from_params_ctx(&ctx, &config);
+    pfxr_sound_t* parsed = url ? pfxr_create_params_from_url_ctx(&ctx, url) : NULL;
+    check(parsed != NULL, "URL round trip through the context");
+    pfxr_context_free(&ctx, parsed);
+    pfxr_context_free(&ctx, url);
+    
+    check(tally.allocs > 0 && tally.allocs == tally.frees, "every allocation comes back to the callbacks");
+    check(heap_allocs == 0, "nothing goes through PFXR_MALLOC");
+    pfxr_free_wav_data(expected);
+}
+
+static void test_arena(void) {
+    printf("\nArena\n");
+    
+    static char memory[256 * 1024];
+    pfxr_context_t ctx;
+    pfxr_context_init_arena(&ctx, memory, sizeof(memory));
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_BLIP, 6);
+    char* expected = pfxr_create_sound_from_config(&config);
+    heap_allocs = 0;
+    
+    int size = 0;
+    char* wav = pfxr_create_sound_from_config_ctx(&ctx, &config, &size);
+    check(wav && wav >= memory && wav + size <= memory + sizeof(memory), "WAV data lives in the arena");
+    check(wav && expected && memcmp(wav, expected, size) == 0, "output matches the default allocator");
+    check(heap_allocs == 0, "nothing goes through PFXR_MALLOC");
+    
+    pfxr_context_reset(&ctx);
+    char* again = pfxr_create_sound_from_config_ctx(&ctx, &config, &size);
+    check(again == wav, "reset releases everything at once");
+    
+    pfxr_context_reset(&ctx);
+    char* block = (char*)pfxr_context_alloc(&ctx, 100);
+    char* grown = (char*)pfxr_context_realloc(&ctx, block, 1000);
+    check(block && grown == block, "the latest block grows in place");
+    
+    pfxr_sound_t long_sound = pfxr_apply_template(PFXR_TEMPLATE_EXPLOSION, 1);
+    long_sound.sustainTime = 2.0f;
+    pfxr_context_reset(&ctx);
+    check(pfxr_create_sound_from_config_ctx(&ctx, &long_sound, &size) == NULL, "a full arena returns NULL");
+    pfxr_free_wav_data(expected);
+}
+
+int main(void) {
+    printf("Allocator tests\n");
+    printf("===============\n");
+    
+    test_macros();
+    test_uninitialized();
+    test_allocator_context();
+    test_arena();
+    
+    return test_summary("allocator");
+}
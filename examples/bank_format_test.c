@@ -0,0 +1,183 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BANK_PATH "bank_format_test.pfxb"
+#define RENDERED 40
+
+static pfxr_sound_t configs[RENDERED];
+static float float_samples[1000];
+static uint8_t pcm8_samples[333];
+
+static void sound_name(int i, char* name, size_t size) {
+    snprintf(name, size, "sfx/sound_%02d", i);
+}
+
+static int build_bank(void) {
+    pfxr_bank_builder_t* builder = pfxr_bank_builder_create(BANK_PATH);
+    if (!builder) return -1;
+    
+    int ok = 1;
+    for (int i = 0; i < RENDERED; i++) {
+        char name[64];
+        sound_name(i, name, sizeof(name));
+        configs[i] = pfxr_apply_template((pfxr_template_t)(PFXR_TEMPLATE_PICKUP + i % 9), i + 1);
+        ok = ok && pfxr_bank_builder_add(builder, name, &configs[i]) == 0;
+    }
+    for (int i = 0; i < 1000; i++) float_samples[i] = (float)i / 1000.0f - 0.5f;
+    for (int i = 0; i < 333; i++) pcm8_samples[i] = (uint8_t)(i * 7);
+    ok = ok && pfxr_bank_builder_add_data(builder, "float", &configs[0], PFXR_BANK_FLOAT32, 48000,
+                                          float_samples, 1000) == 0;
+    ok = ok && pfxr_bank_builder_add_data(builder, "pcm8", &configs[1], PFXR_BANK_PCM8, 22050,
+                                          pcm8_samples, 333) == 0;
+    ok = ok && pfxr_bank_builder_add_data(builder, "empty", &configs[2], PFXR_BANK_PCM16, PFXR_SAMPLE_RATE,
+                                          NULL, 0) == 0;
+    if (!ok) {
+        pfxr_bank_builder_discard(builder);
+        return -1;
+    }
+    return pfxr_bank_builder_finish(builder);
+}
+
+// Check every sound of an open bank against what was added
+static void check_bank(const pfxr_bank_t* bank, const char* how) {
+    int mismatches = 0;
+    for (int i = 0; i < RENDERED; i++) {
+        char name[64];
+        sound_name(i, name, sizeof(name));
+        pfxr_bank_sound_t sound;
+        int index = pfxr_bank_find(bank, name);
+        if (pfxr_bank_get(bank, index, &sound) != 0 || pfxr_bank_verify(bank, index) != 0) {
+            mismatches++;
+            continue;
+        }
+        
+        int capacity = pfxr_render_wav_into(&configs[i], NULL, 0);
+        char* wav = (char*)malloc(capacity);
+        int size = wav ? pfxr_render_wav_into(&configs[i], wav, capacity) : 0;
+        int header = pfxr_wav_header_size(PFXR_FORMAT_PCM16);
+        if (!wav || strcmp(sound.name, name) != 0 || sound.format != PFXR_BANK_PCM16 ||
+            sound.sample_rate != PFXR_SAMPLE_RATE || sound.size != size - header ||
+            sound.sample_count != sound.size / 2 || ((uintptr_t)sound.data & 15) != 0 ||
+            memcmp(sound.data, wav + header, sound.size) != 0 ||
+            memcmp(&sound.config, &configs[i], sizeof(pfxr_sound_t)) != 0) {
+            mismatches++;
+        }
+        free(wav);
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%s: %d sounds, %d rendered sounds mismatched", how, pfxr_bank_count(bank),
+             mismatches);
+    check(pfxr_bank_count(bank) == RENDERED + 3 && mismatches == 0, what);
+    
+    pfxr_bank_sound_t sound;
+    int ok = pfxr_bank_get(bank, pfxr_bank_find(bank, "float"), &sound) == 0 &&
+             sound.format == PFXR_BANK_FLOAT32 && sound.sample_rate == 48000 && sound.sample_count == 1000 &&
+             memcmp(sound.data, float_samples, sizeof(float_samples)) == 0;
+    ok = ok && pfxr_bank_get(bank, pfxr_bank_find(bank, "pcm8"), &sound) == 0 &&
+         sound.format == PFXR_BANK_PCM8 && sound.size == 333 && ((uintptr_t)sound.data & 15) == 0 &&
+         memcmp(sound.data, pcm8_samples, sizeof(pcm8_samples)) == 0;
+    ok = ok && pfxr_bank_get(bank, pfxr_bank_find(bank, "empty"), &sound) == 0 &&
+         sound.sample_count == 0 && sound.size == 0;
+    snprintf(what, sizeof(what), "%s: float, PCM8 and empty data", how);
+    check(ok, what);
+}
+
+static void test_file(void) {
+    printf("\nBuilding and opening a bank file\n");
+    
+    check(build_bank() == 0, "the bank is built");
+    pfxr_bank_t* bank = pfxr_bank_open(BANK_PATH);
+    check(bank != NULL, "the bank opens");
+    if (!bank) return;
+    
+    check_bank(bank, "file");
+    check(pfxr_bank_find(bank, "sfx/sound_99") == -1 && pfxr_bank_find(bank, "") == -1,
+          "unknown names are not found");
+    pfxr_bank_sound_t sound;
+    check(pfxr_bank_get(bank, -1, &sound) == -1 && pfxr_bank_get(bank, RENDERED + 3, &sound) == -1 &&
+          pfxr_bank_verify(bank, RENDERED + 3) == -1, "out of range indices fail");
+    pfxr_bank_close(bank);
+}
+
+static void test_memory(void) {
+    printf("\nOpening a bank image in memory\n");
+    
+    FILE* file = fopen(BANK_PATH, "rb");
+    if (!file) {
+        check(0, "read the bank file");
+        return;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* buffer = (char*)malloc(size + 32);
+    char* image = buffer + (16 - ((uintptr_t)buffer & 15));
+    int read = buffer && fread(image, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!read) {
+        check(0, "read the bank file");
+        free(buffer);
+        return;
+    }
+    
+    pfxr_bank_t* bank = pfxr_bank_open_memory(image, size);
+    check(bank != NULL, "an aligned image opens");
+    if (!bank) {
+        free(buffer);
+        return;
+    }
+    check_bank(bank, "memory");
+    
+    // Damage one sound's payload
+    pfxr_bank_sound_t sound;
+    int index = pfxr_bank_find(bank, "sfx/sound_07");
+    pfxr_bank_get(bank, index, &sound);
+    ((char*)sound.data)[sound.size / 2] ^= 1;
+    int others = 0;
+    for (int i = 0; i < pfxr_bank_count(bank); i++) {
+        if (i != index && pfxr_bank_verify(bank, i) != 0) others++;
+    }
+    check(pfxr_bank_verify(bank, index) == -1 && others == 0, "verify finds the damaged sound only");
+    pfxr_bank_close(bank);
+    
+    memmove(image + 1, image, size);
+    check(pfxr_bank_open_memory(image + 1, size) == NULL, "a misaligned image is refused");
+    memmove(image, image + 1, size);
+    check(pfxr_bank_open_memory(image, size - 1) == NULL, "a truncated image is refused");
+    image[0] ^= 1;
+    check(pfxr_bank_open_memory(image, size) == NULL, "a bad magic is refused");
+    free(buffer);
+}
+
+static void test_builder_failures(void) {
+    printf("\nBuilder failures leave no bank\n");
+    
+    remove(BANK_PATH);
+    pfxr_bank_builder_t* builder = pfxr_bank_builder_create(BANK_PATH);
+    pfxr_bank_builder_add(builder, "same", &configs[0]);
+    pfxr_bank_builder_add(builder, "same", &configs[1]);
+    check(pfxr_bank_builder_finish(builder) == -1 && pfxr_bank_open(BANK_PATH) == NULL, "duplicate names fail");
+    
+    builder = pfxr_bank_builder_create(BANK_PATH);
+    pfxr_bank_builder_add(builder, "a", &configs[0]);
+    pfxr_bank_builder_discard(builder);
+    FILE* temp = fopen(BANK_PATH ".tmp", "rb");
+    check(pfxr_bank_open(BANK_PATH) == NULL && temp == NULL, "discard removes the partial file");
+    if (temp) fclose(temp);
+}
+
+int main(void) {
+    printf("Sound bank format tests\n");
+    printf("=======================\n");
+    
+    test_file();
+    test_memory();
+    test_builder_failures();
+    remove(BANK_PATH);
+    
+    return test_summary("bank format");
+}
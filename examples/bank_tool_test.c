@@ -0,0 +1,202 @@
+// Runs the pfxr-bank tool, whose path is the only argument:
+//   build/bank_tool_test build/pfxr-bank
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MANIFEST "bank_tool_test.txt"
+#define BANK "bank_tool_test.pfxb"
+#define LOG "bank_tool_test.log"
+
+static const char* tool;
+static pfxr_sound_t url_sound;
+
+// Run the tool with args, its output going to LOG; returns its exit status
+static int run_tool(const char* args) {
+    char command[1024];
+    snprintf(command, sizeof(command), "%s %s > %s 2>&1", tool, args, LOG);
+    return system(command);
+}
+
+// Sounds rendered and left unchanged by the last build, from its summary line
+static int last_build(int* rendered, int* unchanged) {
+    char line[512];
+    int sounds = -1;
+    FILE* log = fopen(LOG, "r");
+    while (log && fgets(line, sizeof(line), log)) {
+        if (sscanf(line, "Wrote %*[^:]: %d sounds (%d rendered, %d unchanged)", &sounds, rendered, unchanged) == 3) {
+            break;
+        }
+    }
+    if (log) fclose(log);
+    return sounds;
+}
+
+static void write_manifest(const char* extra) {
+    char url[PFXR_URL_WRITE_MAX];
+    pfxr_url_write(&url_sound, url, sizeof(url));
+    FILE* file = fopen(MANIFEST, "w");
+    if (!file) return;
+    fprintf(file, "# test sounds\npickup 1-5\nlaser 3  # one seed\n\nurl custom https://example.com/%s\n%s",
+            url, extra);
+    fclose(file);
+}
+
+// The config a bank sound name stands for
+static int expected_config(const char* name, pfxr_sound_t* config) {
+    static const char* templates[] = { "pickup", "laser", "jump" };
+    static const pfxr_template_t ids[] = { PFXR_TEMPLATE_PICKUP, PFXR_TEMPLATE_LASER, PFXR_TEMPLATE_JUMP };
+    if (strcmp(name, "custom") == 0) {
+        *config = url_sound;
+        return 0;
+    }
+    for (int t = 0; t < 3; t++) {
+        size_t length = strlen(templates[t]);
+        if (strncmp(name, templates[t], length) == 0 && name[length] == '_') {
+            *config = pfxr_apply_template(ids[t], atoi(name + length + 1));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Check every sound of a bank against a fresh render in format
+static int bank_matches(const char* path, int count, pfxr_bank_format_t format) {
+    pfxr_bank_t* bank = pfxr_bank_open(path);
+    int ok = bank && pfxr_bank_count(bank) == count;
+    for (int i = 0; ok && i < count; i++) {
+        pfxr_bank_sound_t sound;
+        pfxr_sound_t config;
+        ok = pfxr_bank_get(bank, i, &sound) == 0 && pfxr_bank_verify(bank, i) == 0 &&
+             expected_config(sound.name, &config) == 0 && sound.format == format &&
+             memcmp(&sound.config, &config, sizeof(config)) == 0;
+        if (!ok) break;
+        
+        pfxr_sample_format_t sample_format = (pfxr_sample_format_t)format;
+        int capacity = pfxr_render_samples_into(&config, 0, sample_format, NULL, 0);
+        char* samples = (char*)malloc(capacity);
+        int size = samples ? pfxr_render_samples_into(&config, 0, sample_format, samples, capacity) : 0;
+        ok = samples && sound.size == size && memcmp(sound.data, samples, size) == 0;
+        free(samples);
+    }
+    pfxr_bank_close(bank);
+    return ok;
+}
+
+static void test_build(void) {
+    printf("\nBuilding from a manifest\n");
+    
+    write_manifest("");
+    int rendered = 0, unchanged = 0;
+    check(run_tool("-j 2 -o " BANK " " MANIFEST) == 0 && last_build(&rendered, &unchanged) == 7 &&
+          rendered == 7 && unchanged == 0, "seven sounds rendered");
+    check(bank_matches(BANK, 7, PFXR_BANK_PCM16), "the bank holds the rendered sounds");
+    
+    remove(BANK);
+    write_manifest("pickup 0\n");
+    check(run_tool("-o " BANK " " MANIFEST) != 0 && pfxr_bank_open(BANK) == NULL,
+          "a bad manifest line fails without a bank");
+    check(run_tool(BANK) != 0, "a missing -o fails");
+}
+
+static void test_incremental(void) {
+    printf("\nIncremental rebuilds\n");
+    
+    write_manifest("");
+    int rendered = 0, unchanged = 0;
+    run_tool("-o " BANK " " MANIFEST);
+    check(run_tool("-o " BANK " " MANIFEST) == 0 && last_build(&rendered, &unchanged) == 7 &&
+          rendered == 0 && unchanged == 7, "an unchanged manifest renders nothing");
+    
+    write_manifest("jump 1-2\n");
+    check(run_tool("-j 3 -o " BANK " " MANIFEST) == 0 && last_build(&rendered, &unchanged) == 9 &&
+          rendered == 2 && unchanged == 7, "only added sounds render");
+    check(bank_matches(BANK, 9, PFXR_BANK_PCM16), "copied and rendered sounds match fresh renders");
+    
+    check(run_tool("--format float -o " BANK " " MANIFEST) == 0 && last_build(&rendered, &unchanged) == 9 &&
+          rendered == 9, "a format change renders everything");
+    check(bank_matches(BANK, 9, PFXR_BANK_FLOAT32), "the float bank matches fresh renders");
+}
+
+// Build shard i of n to bank_tool_test_<i>.pfxb
+static int build_shard(int i, int n) {
+    char args[256];
+    snprintf(args, sizeof(args), "--shard %d/%d -o bank_tool_test_%d.pfxb " MANIFEST, i, n, i);
+    return run_tool(args);
+}
+
+static void remove_shards(int n) {
+    for (int i = 0; i < n; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "bank_tool_test_%d.pfxb", i);
+        remove(path);
+        snprintf(path, sizeof(path), "bank_tool_test_%d.pfxb.hashes", i);
+        remove(path);
+    }
+}
+
+#define MERGE_ALL "merge -o " BANK " bank_tool_test_0.pfxb bank_tool_test_1.pfxb bank_tool_test_2.pfxb"
+
+static void test_shards(void) {
+    printf("\nSharded builds and merging\n");
+    
+    write_manifest("jump 1-2\n");
+    int shards_ok = build_shard(0, 3) == 0 && build_shard(1, 3) == 0 && build_shard(2, 3) == 0;
+    int rendered = 0, unchanged = 0;
+    check(shards_ok && last_build(&rendered, &unchanged) == 3 && rendered == 3, "each of three shards renders three");
+    
+    remove(BANK);
+    check(run_tool(MERGE_ALL) == 0 && bank_matches(BANK, 9, PFXR_BANK_PCM16), "the merged bank holds every sound");
+    
+    remove(BANK);
+    check(run_tool("merge -o " BANK " bank_tool_test_0.pfxb bank_tool_test_2.pfxb") != 0 &&
+          pfxr_bank_open(BANK) == NULL, "a missing shard fails the merge");
+    
+    // Shard 1 of a different manifest
+    write_manifest("jump 1-3\n");
+    build_shard(1, 3);
+    check(run_tool(MERGE_ALL) != 0 && pfxr_bank_open(BANK) == NULL, "a shard of another manifest fails the merge");
+    
+    // Shard 1 again, then damage a payload byte in it
+    write_manifest("jump 1-2\n");
+    build_shard(1, 3);
+    pfxr_bank_t* shard = pfxr_bank_open("bank_tool_test_1.pfxb");
+    pfxr_bank_sound_t sound;
+    long offset = shard && pfxr_bank_get(shard, 0, &sound) == 0 ? (long)((const char*)sound.data - shard->data) : -1;
+    pfxr_bank_close(shard);
+    FILE* file = offset > 0 ? fopen("bank_tool_test_1.pfxb", "r+b") : NULL;
+    if (file) {
+        fseek(file, offset, SEEK_SET);
+        int byte = fgetc(file);
+        fseek(file, offset, SEEK_SET);
+        fputc(byte ^ 1, file);
+        fclose(file);
+    }
+    check(file && run_tool(MERGE_ALL) != 0 && pfxr_bank_open(BANK) == NULL,
+          "a damaged payload fails the merge");
+    remove_shards(3);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s PFXR_BANK_TOOL\n", argv[0]);
+        return 1;
+    }
+    tool = argv[1];
+    url_sound = pfxr_apply_template(PFXR_TEMPLATE_POWERUP, 12);
+    
+    printf("Sound bank tool tests\n");
+    printf("=====================\n");
+    
+    test_build();
+    test_incremental();
+    test_shards();
+    remove(MANIFEST);
+    remove(BANK);
+    remove(BANK ".hashes");
+    remove(LOG);
+    
+    return test_summary("bank tool");
+}
@@ -0,0 +1,122 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SOUND_COUNT 24
+
+static pfxr_sound_t configs[SOUND_COUNT];
+
+static void make_sounds(void) {
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        configs[i] = pfxr_apply_template((pfxr_template_t)(PFXR_TEMPLATE_PICKUP + i % 7), i + 1);
+    }
+}
+
+// The float samples pfxr_render_into gives for sound i
+static float* single_render(int i, int* count) {
+    *count = pfxr_sound_sample_count(&configs[i]);
+    float* out = (float*)malloc((*count + 1) * sizeof(float));
+    if (out) pfxr_render_into(&configs[i], out, *count);
+    return out;
+}
+
+// The WAV file of sound i, dithered with seed unless it is 0, built from a
+// single render
+static char* single_wav(int i, uint32_t seed, int* size) {
+    int count;
+    float* samples = single_render(i, &count);
+    *size = pfxr_wav_header_size(PFXR_FORMAT_PCM16) + count * 2;
+    char* wav = (char*)malloc(*size);
+    if (samples && wav) {
+        pfxr_dither_t dither;
+        pfxr_dither_init(&dither, seed);
+        pfxr_write_wav_header(wav, count, PFXR_SAMPLE_RATE, PFXR_FORMAT_PCM16);
+        pfxr_convert_samples_dither(samples, wav + pfxr_wav_header_size(PFXR_FORMAT_PCM16), count,
+                                    PFXR_FORMAT_PCM16, seed ? &dither : NULL);
+    }
+    free(samples);
+    return wav;
+}
+
+static void test_float_batches(void) {
+    printf("\nFloat batches match single renders\n");
+    
+    static const int thread_counts[] = { 1, 2, 5, 0 };
+    for (int t = 0; t < 4; t++) {
+        pfxr_batch_opts_t opts = { thread_counts[t], PFXR_BATCH_FLOAT, 0, PFXR_FORMAT_PCM16, 0, 0 };
+        pfxr_batch_result_t* results = pfxr_render_batch(configs, SOUND_COUNT, &opts);
+        int mismatches = results ? 0 : SOUND_COUNT;
+        for (int i = 0; results && i < SOUND_COUNT; i++) {
+            int count;
+            float* expected = single_render(i, &count);
+            if (!expected || results[i].size != count || results[i].sample_count != count ||
+                memcmp(results[i].data, expected, count * sizeof(float)) != 0) mismatches++;
+            free(expected);
+        }
+        pfxr_free_batch(results, SOUND_COUNT);
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%d threads, %d mismatches", thread_counts[t], mismatches);
+        check(mismatches == 0, what);
+    }
+}
+
+static void test_dithered_batches(void) {
+    printf("\nDithered WAV batches do not depend on the thread count\n");
+    
+    const uint32_t seed = 777;
+    static const int thread_counts[] = { 1, 3, 8 };
+    for (int t = 0; t < 3; t++) {
+        pfxr_batch_opts_t opts = { thread_counts[t], PFXR_BATCH_WAV, 0, PFXR_FORMAT_PCM16, seed, 0 };
+        pfxr_batch_result_t* results = pfxr_render_batch(configs, SOUND_COUNT, &opts);
+        int mismatches = results ? 0 : SOUND_COUNT;
+        for (int i = 0; results && i < SOUND_COUNT; i++) {
+            int size;
+            char* expected = single_wav(i, seed + (uint32_t)i, &size);
+            if (!expected || results[i].size != size || memcmp(results[i].data, expected, size) != 0) mismatches++;
+            free(expected);
+        }
+        pfxr_free_batch(results, SOUND_COUNT);
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%d threads, %d mismatches", thread_counts[t], mismatches);
+        check(mismatches == 0, what);
+    }
+}
+
+static void test_edge_cases(void) {
+    printf("\nEdge cases\n");
+    
+    check(pfxr_render_batch(configs, 0, NULL) == NULL, "no sounds gives NULL");
+    check(pfxr_render_batch(NULL, 4, NULL) == NULL, "no configs gives NULL");
+    
+    pfxr_sound_t sounds[3] = { configs[0], configs[1], configs[2] };
+    sounds[1].attackTime = sounds[1].sustainTime = sounds[1].decayTime = 0.0f;
+    pfxr_batch_opts_t opts = { 8, PFXR_BATCH_WAV, 0, PFXR_FORMAT_PCM16, 0, 0 };
+    pfxr_batch_result_t* results = pfxr_render_batch(sounds, 3, &opts);
+    check(results != NULL, "more threads than sounds");
+    if (!results) return;
+    
+    check(results[1].data == NULL && results[1].size == 0 && results[1].sample_count == 0,
+          "an empty sound has no data");
+    int size;
+    char* expected = single_wav(2, 0, &size);
+    check(expected && results[2].size == size && memcmp(results[2].data, expected, size) == 0,
+          "results stay in input order");
+    free(expected);
+    pfxr_free_batch(results, 3);
+}
+
+int main(void) {
+    printf("Batch tests\n");
+    printf("===========\n");
+    
+    make_sounds();
+    test_float_batches();
+    test_dithered_batches();
+    test_edge_cases();
+    
+    return test_summary("batch");
+}
@@ -0,0 +1,140 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// True when size bytes of data all equal value
+static int untouched(const void* data, int size, unsigned char value) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (int i = 0; i < size; i++) {
+        if (bytes[i] != value) return 0;
+    }
+    return 1;
+}
+
+// First RANDOM sound with a phaser deep enough to need scratch space
+static int find_deep_phaser(pfxr_sound_t* config) {
+    for (int seed = 1; seed <= 200; seed++) {
+        *config = pfxr_apply_template(PFXR_TEMPLATE_RANDOM, seed);
+        if (pfxr_render_scratch_size(config, 0) > 0) return 1;
+    }
+    return 0;
+}
+
+static void test_render_into(void) {
+    printf("\nFloat samples\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_LASER, 5);
+    int count = pfxr_sound_sample_count(&config);
+    float* out = (float*)malloc((count + 1) * sizeof(float));
+    if (!out) {
+        check(0, "allocate");
+        return;
+    }
+    
+    check(pfxr_render_into(&config, NULL, 0) == count, "NULL buffer returns the sample count");
+    memset(out, 0x55, (count + 1) * sizeof(float));
+    check(pfxr_render_into(&config, out, count - 1) == count && untouched(out, (count + 1) * sizeof(float), 0x55),
+          "too small a buffer is left untouched");
+    check(pfxr_render_into(&config, out, count) == count && untouched(out + count, sizeof(float), 0x55),
+          "exact capacity renders without writing past the end");
+    free(out);
+}
+
+static void test_render_wav_into(void) {
+    printf("\nWAV data\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_JUMP, 3);
+    int count = pfxr_sound_sample_count(&config);
+    int size = (int)sizeof(pfxr_wav_header_t) + count * 2;
+    char* expected = pfxr_create_sound_from_config(&config);
+    char* out = (char*)malloc(size + 16);
+    if (!expected || !out) {
+        check(0, "allocate");
+        pfxr_free_wav_data(expected);
+        free(out);
+        return;
+    }
+    
+    check(pfxr_render_scratch_size(&config, 0) == 0, "no scratch for a shallow phaser");
+    check(pfxr_render_wav_into(&config, NULL, 0) == size, "NULL buffer returns the file size");
+    memset(out, 0x55, size + 16);
+    check(pfxr_render_wav_into(&config, out, size - 1) == size && untouched(out, size + 16, 0x55),
+          "too small a buffer is left untouched");
+    check(pfxr_render_wav_into(&config, out, size) == size && memcmp(out, expected, size) == 0 &&
+          untouched(out + size, 16, 0x55), "exact capacity matches pfxr_create_sound_from_config");
+    free(out);
+    pfxr_free_wav_data(expected);
+}
+
+static void test_scratch(void) {
+    printf("\nScratch space for deep phasers\n");
+    
+    pfxr_sound_t config;
+    if (!find_deep_phaser(&config)) {
+        check(0, "find a sound with a deep phaser");
+        return;
+    }
+    
+    int count = pfxr_sound_sample_count(&config);
+    int size = (int)sizeof(pfxr_wav_header_t) + count * 2;
+    int scratch = pfxr_render_scratch_size(&config, 0);
+    int needed = ((size + 15) & ~15) + scratch;
+    char* expected = pfxr_create_sound_from_config(&config);
+    char* out = (char*)malloc(needed);
+    if (!expected || !out) {
+        check(0, "allocate");
+        pfxr_free_wav_data(expected);
+        free(out);
+        return;
+    }
+    
+    check(scratch > PFXR_PHASER_HISTORY * (int)sizeof(float), "scratch is larger than the inline history");
+    check(pfxr_render_wav_into(&config, NULL, 0) == needed, "NULL buffer returns output plus aligned scratch");
+    check(pfxr_render_wav_into(&config, out, needed - 1) == needed, "no room for the scratch returns the need");
+    check(pfxr_render_wav_into(&config, out, needed) == size && memcmp(out, expected, size) == 0,
+          "render returns the WAV size and matches pfxr_create_sound_from_config");
+    
+    int samples_needed = ((count * 2 + 15) & ~15) + scratch;
+    check(pfxr_render_samples_into(&config, 0, PFXR_FORMAT_PCM16, NULL, 0) == samples_needed,
+          "headerless samples need the same scratch");
+    check(pfxr_render_samples_into(&config, 0, PFXR_FORMAT_PCM16, out, needed) == count * 2 &&
+          memcmp(out, expected + sizeof(pfxr_wav_header_t), count * 2) == 0, "headerless samples match");
+    free(out);
+    pfxr_free_wav_data(expected);
+}
+
+static void test_url_write(void) {
+    printf("\nURL queries\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_POWERUP, 9);
+    char* expected = pfxr_get_url_from_params(&config);
+    char out[PFXR_URL_WRITE_MAX + 1];
+    if (!expected) {
+        check(0, "pfxr_get_url_from_params");
+        return;
+    }
+    
+    int size = (int)strlen(expected) + 1;
+    check(pfxr_url_write(&config, NULL, 0) == size, "NULL buffer returns the length with terminator");
+    memset(out, 0x55, sizeof(out));
+    check(pfxr_url_write(&config, out, size - 1) == size && untouched(out, sizeof(out), 0x55),
+          "too small a buffer is left untouched");
+    check(pfxr_url_write(&config, out, size) == size && strcmp(out, expected) == 0,
+          "exact capacity matches pfxr_get_url_from_params");
+    check(size <= PFXR_URL_WRITE_MAX, "within PFXR_URL_WRITE_MAX");
+    free(expected);
+}
+
+int main(void) {
+    printf("Caller-owned buffer tests\n");
+    printf("=========================\n");
+    
+    test_render_into();
+    test_render_wav_into();
+    test_scratch();
+    test_url_write();
+    
+    return test_summary("caller-owned buffer");
+}
@@ -0,0 +1,250 @@
+#include <stdlib.h>
+
+// Lets a test run other lookups while a sound renders, as another thread could
+static void* racing_malloc(size_t size);
+
+#define PFXR_MALLOC(size) racing_malloc(size)
+#define PFXR_REALLOC(ptr, size) realloc(ptr, size)
+#define PFXR_FREE(ptr) free(ptr)
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <string.h>
+
+static void (*racing_lookups)(void) = NULL;
+
+static void* racing_malloc(size_t size) {
+    void (*lookups)(void) = racing_lookups;
+    racing_lookups = NULL;
+    if (lookups) lookups();
+    return malloc(size);
+}
+
+// Sounds of one length that differ only in pitch, so their entries are the same size
+static pfxr_sound_t tone(int i) {
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_BLIP, 1);
+    config.frequency = 300.0f + 50.0f * i;
+    return config;
+}
+
+// Whether a cached sound holds exactly what pfxr_render_wav_into writes
+static int matches_render(const pfxr_cached_sound_t* sound, const pfxr_sound_t* config) {
+    int capacity = pfxr_render_wav_into(config, NULL, 0);
+    char* wav = (char*)malloc(capacity);
+    int size = wav ? pfxr_render_wav_into(config, wav, capacity) : 0;
+    int ok = wav && sound && sound->wav_size == size && memcmp(sound->wav_data, wav, size) == 0 &&
+             sound->sample_count == pfxr_sound_sample_count(config) &&
+             (const char*)sound->samples == sound->wav_data + sizeof(pfxr_wav_header_t);
+    free(wav);
+    return ok;
+}
+
+static void test_lookup(void) {
+    printf("\nLookups\n");
+    
+    pfxr_cache_t* cache = pfxr_cache_create(1 << 24);
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_EXPLOSION, 4);
+    config.pitchDelay = 0.0f;
+    const pfxr_cached_sound_t* first = pfxr_cache_get(cache, &config);
+    const pfxr_cached_sound_t* second = pfxr_cache_get(cache, &config);
+    check(matches_render(first, &config), "a miss holds the rendered WAV data");
+    check(second == first && first->key == pfxr_sound_hash(&config), "a hit returns the same sound");
+    
+    pfxr_sound_t negative_zero = config;
+    negative_zero.pitchDelay = -0.0f;
+    const pfxr_cached_sound_t* third = pfxr_cache_get(cache, &negative_zero);
+    check(third == first, "-0 finds the sound cached for +0");
+    
+    pfxr_cache_stats_t stats;
+    pfxr_cache_stats(cache, &stats);
+    check(stats.hits == 2 && stats.misses == 1 && stats.entries == 1 && stats.evictions == 0,
+          "two hits and one miss counted");
+    
+    const pfxr_cached_sound_t* by_template = pfxr_cache_get_template(cache, PFXR_TEMPLATE_BLIP, 2);
+    pfxr_sound_t blip = pfxr_apply_template(PFXR_TEMPLATE_BLIP, 2);
+    check(matches_render(by_template, &blip), "pfxr_cache_get_template renders the template");
+    
+    pfxr_cache_release(cache, first);
+    pfxr_cache_release(cache, second);
+    pfxr_cache_release(cache, third);
+    pfxr_cache_release(cache, by_template);
+    pfxr_cache_destroy(cache);
+}
+
+static void test_lru(void) {
+    printf("\nLeast recently used eviction\n");
+    
+    // Measure one entry, then allow exactly three
+    pfxr_cache_t* cache = pfxr_cache_create(1 << 24);
+    pfxr_sound_t config = tone(0);
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &config));
+    pfxr_cache_stats_t stats;
+    pfxr_cache_stats(cache, &stats);
+    size_t entry_bytes = stats.bytes;
+    pfxr_cache_destroy(cache);
+    
+    cache = pfxr_cache_create(entry_bytes * 3);
+    pfxr_sound_t sounds[4] = { tone(0), tone(1), tone(2), tone(3) };
+    for (int i = 0; i < 3; i++) pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[i]));
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[0]));
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[3]));
+    pfxr_cache_stats(cache, &stats);
+    check(stats.evictions == 1 && stats.entries == 3 && stats.bytes == entry_bytes * 3,
+          "a fourth sound evicts one");
+    
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[0]));
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[2]));
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[3]));
+    pfxr_cache_stats(cache, &stats);
+    check(stats.hits == 4 && stats.misses == 4, "the recently used sounds stay");
+    
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &sounds[1]));
+    pfxr_cache_stats(cache, &stats);
+    check(stats.misses == 5, "the least recently used sound was the one evicted");
+    pfxr_cache_destroy(cache);
+}
+
+// The lookups another thread makes while sounds[2] renders: it caches the
+// same sound first, then uses the others
+static pfxr_cache_t* race_cache;
+static pfxr_sound_t race_sounds[4];
+
+static void race_lookups(void) {
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[2]));
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[0]));
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[1]));
+}
+
+static void test_lru_race(void) {
+    printf("\nA sound cached during its render counts as used\n");
+    
+    pfxr_cache_t* cache = pfxr_cache_create(1 << 24);
+    pfxr_sound_t config = tone(0);
+    pfxr_cache_release(cache, pfxr_cache_get(cache, &config));
+    pfxr_cache_stats_t stats;
+    pfxr_cache_stats(cache, &stats);
+    size_t entry_bytes = stats.bytes;
+    pfxr_cache_destroy(cache);
+    
+    race_cache = pfxr_cache_create(entry_bytes * 3);
+    for (int i = 0; i < 4; i++) race_sounds[i] = tone(i);
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[0]));
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[1]));
+    racing_lookups = race_lookups;
+    const pfxr_cached_sound_t* sound = pfxr_cache_get(race_cache, &race_sounds[2]);
+    check(sound && matches_render(sound, &race_sounds[2]), "the lookup returns the sound cached meanwhile");
+    pfxr_cache_release(race_cache, sound);
+    
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[3]));
+    pfxr_cache_release(race_cache, pfxr_cache_get(race_cache, &race_sounds[2]));
+    pfxr_cache_stats(race_cache, &stats);
+    check(racing_lookups == NULL && stats.entries == 3 && stats.misses == 5,
+          "it stays cached when a fourth sound evicts one");
+    pfxr_cache_destroy(race_cache);
+}
+
+static void test_held_sounds(void) {
+    printf("\nHeld sounds outlive eviction\n");
+    
+    pfxr_cache_t* cache = pfxr_cache_create(1 << 24);
+    pfxr_sound_t config = tone(5);
+    const pfxr_cached_sound_t* held = pfxr_cache_get(cache, &config);
+    pfxr_cache_clear(cache);
+    
+    pfxr_cache_stats_t stats;
+    pfxr_cache_stats(cache, &stats);
+    check(stats.entries == 0 && stats.bytes == 0 && stats.evictions == 1, "clear empties the cache");
+    check(matches_render(held, &config), "a held sound stays valid after clear");
+    
+    const pfxr_cached_sound_t* again = pfxr_cache_get(cache, &config);
+    check(again != held && matches_render(again, &config), "the next lookup renders it again");
+    pfxr_cache_release(cache, held);
+    pfxr_cache_release(cache, again);
+    pfxr_cache_destroy(cache);
+    
+    cache = pfxr_cache_create(16);
+    const pfxr_cached_sound_t* big = pfxr_cache_get(cache, &config);
+    pfxr_cache_stats(cache, &stats);
+    check(matches_render(big, &config) && stats.entries == 0 && stats.bytes == 0,
+          "a sound over budget is handed out uncached");
+    pfxr_cache_release(cache, big);
+    pfxr_cache_destroy(cache);
+}
+
+#ifdef PFXR_MMAP
+// The file a cache directory keeps a sound in
+static void cache_file(const char* directory, const pfxr_sound_t* config, char* path, size_t size) {
+    uint64_t key = pfxr_sound_hash(config);
+    snprintf(path, size, "%s/%08x%08x.pfxc", directory, (unsigned int)(key >> 32), (unsigned int)key);
+}
+#endif
+
+static void test_directory(void) {
+    printf("\nCache directory\n");
+    
+#ifdef PFXR_MMAP
+    char directory[256];
+    char path[512];
+    snprintf(directory, sizeof(directory), "/tmp/pfxr_cache_test_%ld", (long)getpid());
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_LASER, 9);
+    cache_file(directory, &config, path, sizeof(path));
+    
+    // One process renders and stores the sound, the next maps it
+    pfxr_cache_t* writer = pfxr_cache_create(1 << 24);
+    check(pfxr_cache_set_directory(writer, directory) == 0, "the directory is created");
+    pfxr_cache_release(writer, pfxr_cache_get(writer, &config));
+    pfxr_cache_stats_t stats;
+    pfxr_cache_stats(writer, &stats);
+    FILE* file = fopen(path, "rb");
+    check(stats.disk_writes == 1 && stats.disk_hits == 0 && file != NULL, "a rendered sound is stored");
+    if (file) fclose(file);
+    pfxr_cache_destroy(writer);
+    
+    pfxr_cache_t* reader = pfxr_cache_create(1 << 24);
+    pfxr_cache_set_directory(reader, directory);
+    const pfxr_cached_sound_t* sound = pfxr_cache_get(reader, &config);
+    pfxr_cache_stats(reader, &stats);
+    check(stats.disk_hits == 1 && stats.disk_writes == 0 && matches_render(sound, &config),
+          "another cache maps the stored sound");
+    pfxr_cache_release(reader, sound);
+    pfxr_cache_destroy(reader);
+    
+    // A damaged file reads as a miss and is replaced
+    file = fopen(path, "r+b");
+    if (file) {
+        fwrite("XXXX", 1, 4, file);
+        fclose(file);
+    }
+    reader = pfxr_cache_create(1 << 24);
+    pfxr_cache_set_directory(reader, directory);
+    sound = pfxr_cache_get(reader, &config);
+    pfxr_cache_stats(reader, &stats);
+    check(stats.disk_hits == 0 && stats.disk_writes == 1 && matches_render(sound, &config),
+          "a damaged file is rendered again and rewritten");
+    pfxr_cache_release(reader, sound);
+    
+    check(pfxr_cache_set_directory(reader, path) == -1, "a file is not a usable directory");
+    check(pfxr_cache_set_directory(reader, NULL) == 0, "NULL turns the directory off");
+    pfxr_cache_destroy(reader);
+    
+    unlink(path);
+    rmdir(directory);
+#else
+    pfxr_cache_t* cache = pfxr_cache_create(1 << 24);
+    check(pfxr_cache_set_directory(cache, "pfxr_cache") == -1, "no directory without mmap");
+    pfxr_cache_destroy(cache);
+#endif
+}
+
+int main(void) {
+    printf("Sound cache tests\n");
+    printf("=================\n");
+    
+    test_lookup();
+    test_lru();
+    test_lru_race();
+    test_held_sounds();
+    test_directory();
+    
+    return test_summary("cache");
+}
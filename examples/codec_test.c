@@ -0,0 +1,186 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t next_random(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed ^ (*seed >> 15);
+}
+
+// Random bits in every float field, NaNs included
+static pfxr_sound_t random_bits(uint32_t* seed) {
+    pfxr_sound_t config;
+    config.waveForm = (int)(next_random(seed) % (2 * PFXR_CODEC_WAVE_LIMIT)) - PFXR_CODEC_WAVE_LIMIT;
+    for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+        uint32_t bits = next_random(seed);
+        memcpy((char*)&config + codec_fields[i].offset, &bits, sizeof(bits));
+    }
+    return config;
+}
+
+static void test_lossless(void) {
+    printf("\nLossless encoding\n");
+    
+    uint32_t seed = 5;
+    int mismatches = 0;
+    for (int n = 0; n < 100000; n++) {
+        pfxr_sound_t config = random_bits(&seed);
+        if (n == 0) config.waveForm = PFXR_CODEC_WAVE_LIMIT - 1;
+        if (n == 1) config.waveForm = -PFXR_CODEC_WAVE_LIMIT;
+        unsigned char data[PFXR_CODEC_LOSSLESS_SIZE];
+        pfxr_sound_t decoded;
+        if (pfxr_sound_encode(&config, PFXR_CODEC_LOSSLESS, data, sizeof(data)) != PFXR_CODEC_LOSSLESS_SIZE ||
+            pfxr_sound_decode(data, sizeof(data), &decoded) != PFXR_CODEC_LOSSLESS_SIZE ||
+            memcmp(&decoded, &config, sizeof(config)) != 0) {
+            mismatches++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "100000 random bit patterns, NaNs included, %d mismatches", mismatches);
+    check(mismatches == 0, what);
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    unsigned char data[PFXR_CODEC_LOSSLESS_SIZE];
+    pfxr_sound_encode(&config, PFXR_CODEC_LOSSLESS, data, sizeof(data));
+    float volume;
+    memcpy(&volume, data + 4, sizeof(volume));
+    check(data[0] == (PFXR_CODEC_VERSION << 4 | PFXR_CODEC_LOSSLESS) && data[1] == (unsigned char)config.waveForm &&
+          data[2] == 0 && data[3] == 0 && volume == config.volume, "tag byte, waveForm, then little-endian fields");
+    
+    config.waveForm = PFXR_CODEC_WAVE_LIMIT;
+    check(pfxr_sound_encode(&config, PFXR_CODEC_LOSSLESS, data, sizeof(data)) == 0,
+          "a waveForm past 24 bits is refused");
+}
+
+static void test_quantized(void) {
+    printf("\nQuantized encoding\n");
+    
+    int unstable = 0, far = 0;
+    for (int n = 0; n < 20000; n++) {
+        pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)(n % 11), n + 1);
+        unsigned char first[PFXR_CODEC_QUANTIZED_SIZE];
+        unsigned char second[PFXR_CODEC_QUANTIZED_SIZE];
+        pfxr_sound_t decoded;
+        pfxr_sound_encode(&config, PFXR_CODEC_QUANTIZED, first, sizeof(first));
+        if (pfxr_sound_decode(first, sizeof(first), &decoded) != PFXR_CODEC_QUANTIZED_SIZE) {
+            unstable++;
+            continue;
+        }
+        pfxr_sound_encode(&decoded, PFXR_CODEC_QUANTIZED, second, sizeof(second));
+        if (memcmp(first, second, sizeof(first)) != 0) unstable++;
+        
+        // Within half a step, plus the float rounding of the result, of the
+        // value clamped to the field's range
+        for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+            const codec_field_t* field = &codec_fields[i];
+            float value, result;
+            memcpy(&value, (char*)&config + field->offset, sizeof(value));
+            memcpy(&result, (char*)&decoded + field->offset, sizeof(result));
+            if (value < field->min) value = field->min;
+            if (value > field->max) value = field->max;
+            double step = ((double)field->max - field->min) / ((1u << field->bits) - 2);
+            if (fabs((double)result - value) > step * 0.5 + fabs((double)result) * 6e-8) far++;
+        }
+        if (decoded.waveForm != config.waveForm) far++;
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "20000 template sounds, %d changed by re-encoding", unstable);
+    check(unstable == 0, what);
+    snprintf(what, sizeof(what), "%d fields off by more than half a step", far);
+    check(far == 0, what);
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = 7;
+    config.pitchDelta = 0.0f;
+    config.volume = -3.0f;
+    config.frequency = 1e9f;
+    config.noiseAmount = NAN;
+    unsigned char data[PFXR_CODEC_QUANTIZED_SIZE];
+    pfxr_sound_t decoded;
+    pfxr_sound_encode(&config, PFXR_CODEC_QUANTIZED, data, sizeof(data));
+    pfxr_sound_decode(data, sizeof(data), &decoded);
+    check(decoded.waveForm == 0 && decoded.pitchDelta == 0.0f && decoded.volume == 0.0f &&
+          decoded.frequency == 4000.0f && decoded.noiseAmount == 0.0f,
+          "out of range values clamp and no pitch change stays exact");
+}
+
+static void test_bad_data(void) {
+    printf("\nBad data does not decode\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_HIT, 3);
+    pfxr_sound_t untouched = pfxr_get_default_sound();
+    pfxr_sound_t decoded = untouched;
+    unsigned char lossless[PFXR_CODEC_LOSSLESS_SIZE];
+    unsigned char quantized[PFXR_CODEC_QUANTIZED_SIZE];
+    pfxr_sound_encode(&config, PFXR_CODEC_LOSSLESS, lossless, sizeof(lossless));
+    pfxr_sound_encode(&config, PFXR_CODEC_QUANTIZED, quantized, sizeof(quantized));
+    
+    check(pfxr_sound_decode(lossless, sizeof(lossless) - 1, &decoded) == 0 &&
+          pfxr_sound_decode(quantized, sizeof(quantized) - 1, &decoded) == 0, "truncated data");
+    
+    lossless[0] = (unsigned char)((PFXR_CODEC_VERSION + 1) << 4 | PFXR_CODEC_LOSSLESS);
+    check(pfxr_sound_decode(lossless, sizeof(lossless), &decoded) == 0, "another version");
+    lossless[0] = (unsigned char)(PFXR_CODEC_VERSION << 4 | 9);
+    check(pfxr_sound_decode(lossless, sizeof(lossless), &decoded) == 0, "an unknown mode");
+    
+    unsigned char damaged[PFXR_CODEC_QUANTIZED_SIZE];
+    memcpy(damaged, quantized, sizeof(damaged));
+    damaged[1] |= 0xfc;
+    damaged[2] |= 0x0f;
+    check(pfxr_sound_decode(damaged, sizeof(damaged), &decoded) == 0, "an all-ones code");
+    memcpy(damaged, quantized, sizeof(damaged));
+    damaged[PFXR_CODEC_QUANTIZED_SIZE - 1] |= 0x80;
+    check(pfxr_sound_decode(damaged, sizeof(damaged), &decoded) == 0, "nonzero padding");
+    check(memcmp(&decoded, &untouched, sizeof(decoded)) == 0, "failures leave the config alone");
+}
+
+static void test_batches(void) {
+    printf("\nBatches\n");
+    
+    pfxr_sound_t configs[10];
+    for (int i = 0; i < 10; i++) configs[i] = pfxr_apply_template((pfxr_template_t)i, i + 1);
+    
+    unsigned char batch[10 * PFXR_CODEC_LOSSLESS_SIZE];
+    int size = pfxr_sound_encode_batch(configs, 10, PFXR_CODEC_LOSSLESS, NULL, 0);
+    int ok = size == (int)sizeof(batch) && pfxr_sound_encode_batch(configs, 10, PFXR_CODEC_LOSSLESS, batch, size) == size;
+    for (int i = 0; ok && i < 10; i++) {
+        unsigned char one[PFXR_CODEC_LOSSLESS_SIZE];
+        pfxr_sound_encode(&configs[i], PFXR_CODEC_LOSSLESS, one, sizeof(one));
+        ok = memcmp(batch + i * PFXR_CODEC_LOSSLESS_SIZE, one, sizeof(one)) == 0;
+    }
+    check(ok, "a batch is the encodings back to back");
+    
+    memset(batch, 0xaa, sizeof(batch));
+    check(pfxr_sound_encode_batch(configs, 10, PFXR_CODEC_LOSSLESS, batch, size - 1) == size && batch[0] == 0xaa,
+          "a short buffer is left untouched");
+    
+    // Alternate modes in one stream
+    unsigned char mixed[5 * (PFXR_CODEC_LOSSLESS_SIZE + PFXR_CODEC_QUANTIZED_SIZE)];
+    int used = 0;
+    for (int i = 0; i < 10; i++) {
+        pfxr_codec_mode_t mode = i % 2 ? PFXR_CODEC_QUANTIZED : PFXR_CODEC_LOSSLESS;
+        used += pfxr_sound_encode(&configs[i], mode, mixed + used, (int)sizeof(mixed) - used);
+    }
+    pfxr_sound_t decoded[12];
+    int count = pfxr_sound_decode_batch(mixed, used, decoded, 12);
+    ok = count == 10;
+    for (int i = 0; ok && i < 10; i += 2) ok = memcmp(&decoded[i], &configs[i], sizeof(pfxr_sound_t)) == 0;
+    check(ok, "mixed modes decode in order");
+    check(pfxr_sound_decode_batch(mixed, used - 1, decoded, 12) == 9, "decoding stops at a truncated encoding");
+}
+
+int main(void) {
+    printf("Binary encoding tests\n");
+    printf("=====================\n");
+    
+    test_lossless();
+    test_quantized();
+    test_bad_data();
+    test_batches();
+    
+    return test_summary("encoding");
+}
@@ -0,0 +1,174 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A sound with all three LFOs running
+static pfxr_sound_t modulated_sound(int seed) {
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_POWERUP, seed);
+    config.vibratoRate = 12.0f;
+    config.vibratoDepth = 40.0f;
+    config.tremoloRate = 7.0f;
+    config.tremoloDepth = 0.5f;
+    config.phaserDepth = 200.0f;
+    config.phaserBaseFrequency = 400.0f;
+    config.phaserLfoFrequency = 2.0f;
+    return config;
+}
+
+// Stream a sound in blocks of block_size after setting each of intervals in
+// turn. Every change must succeed before the render and fail after it.
+static int render_stream(const pfxr_sound_t* config, const int* intervals, int interval_count,
+                         int block_size, float* out, int count) {
+    pfxr_generator_t gen;
+    pfxr_generator_init(&gen, config);
+    pfxr_generator_set_history(&gen, out, count);
+    for (int i = 0; i < interval_count; i++) {
+        if (pfxr_generator_set_control_interval(&gen, intervals[i]) != 0) return 0;
+    }
+    int position = 0, n;
+    while ((n = pfxr_generator_render(&gen, out + position, block_size)) > 0) position += n;
+    return position == count && pfxr_generator_set_control_interval(&gen, 1) == -1;
+}
+
+static void test_generator(void) {
+    printf("\nThe interval can change until the first render\n");
+    
+    pfxr_sound_t config = modulated_sound(3);
+    int count = pfxr_sound_sample_count(&config);
+    float* expected = (float*)malloc((count + 1) * sizeof(float));
+    float* out = (float*)malloc((count + 1) * sizeof(float));
+    if (!expected || !out) {
+        check(0, "allocate");
+        free(expected);
+        free(out);
+        return;
+    }
+    
+    static const int back_to_exact[] = { 32, 1 };
+    static const int to_32[] = { 7, 1, 32 };
+    static const int once_32[] = { 32 };
+    
+    pfxr_render_into_interval(&config, 0, 1, expected, count);
+    check(render_stream(&config, back_to_exact, 2, 256, out, count) &&
+          memcmp(out, expected, count * sizeof(float)) == 0, "32 then 1 renders exactly");
+    
+    pfxr_render_into_interval(&config, 0, 32, expected, count);
+    check(render_stream(&config, to_32, 3, 256, out, count) &&
+          memcmp(out, expected, count * sizeof(float)) == 0, "7, 1, then 32 matches 32 alone");
+    
+    int mismatches = 0;
+    for (int block_size = 1; block_size <= 100; block_size += 9) {
+        if (!render_stream(&config, once_32, 1, block_size, out, count) ||
+            memcmp(out, expected, count * sizeof(float)) != 0) mismatches++;
+    }
+    check(mismatches == 0, "interpolation carries across any block size");
+    free(expected);
+    free(out);
+}
+
+static void test_accuracy(void) {
+    printf("\nInterpolated LFOs stay close to the exact ones\n");
+    
+    // Tremolo only, so the error is the LFO error times depth / 2
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = PFXR_WAVE_SQUARE;
+    config.pitchDelta = 0.0f;
+    config.vibratoDepth = config.phaserDepth = config.noiseAmount = 0.0f;
+    config.highPassCutoff = config.lowPassCutoff = 0.0f;
+    config.tremoloRate = 30.0f;
+    config.tremoloDepth = 1.0f;
+    
+    int count = pfxr_sound_sample_count(&config);
+    float* exact = (float*)malloc((count + 1) * sizeof(float));
+    float* coarse = (float*)malloc((count + 1) * sizeof(float));
+    if (!exact || !coarse) {
+        check(0, "allocate");
+        free(exact);
+        free(coarse);
+        return;
+    }
+    pfxr_render_into_interval(&config, 0, 1, exact, count);
+    pfxr_render_into_interval(&config, 0, 32, coarse, count);
+    
+    double step = M_PI * config.tremoloRate * 32.0 / PFXR_SAMPLE_RATE;
+    double bound = step * step / 2.0 * config.tremoloDepth / 2.0 * config.volume * 1.25;
+    double worst = 0.0;
+    for (int i = 0; i < count; i++) {
+        double error = fabs((double)exact[i] - (double)coarse[i]);
+        if (error > worst) worst = error;
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "largest error %.3g is within %.3g", worst, bound);
+    check(worst > 0.0 && worst <= bound, what);
+    free(exact);
+    free(coarse);
+}
+
+static void test_entry_points(void) {
+    printf("\nBatches, lanes and WAV renders take the interval\n");
+    
+    pfxr_sound_t configs[4];
+    for (int i = 0; i < 4; i++) configs[i] = modulated_sound(i + 1);
+    
+    int capacity = 0;
+    for (int i = 0; i < 4; i++) {
+        int count = pfxr_sound_sample_count(&configs[i]);
+        if (count > capacity) capacity = count;
+    }
+    float* expected = (float*)malloc(4 * (capacity + 1) * sizeof(float));
+    float* lanes = (float*)malloc(PFXR_LANES * (capacity + 1) * sizeof(float));
+    char* wav = (char*)malloc(capacity * 4 + 64);
+    if (!expected || !lanes || !wav) {
+        check(0, "allocate");
+        free(expected);
+        free(lanes);
+        free(wav);
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        pfxr_render_into_interval(&configs[i], 0, 16, expected + i * (capacity + 1), capacity);
+    }
+    
+    pfxr_batch_opts_t opts = { 2, PFXR_BATCH_FLOAT, 0, PFXR_FORMAT_PCM16, 0, 16 };
+    pfxr_batch_result_t* results = pfxr_render_batch(configs, 4, &opts);
+    int ok = results != NULL;
+    for (int i = 0; ok && i < 4; i++) {
+        ok = memcmp(results[i].data, expected + i * (capacity + 1), results[i].size * sizeof(float)) == 0;
+    }
+    check(ok, "pfxr_batch_opts_t.control_interval");
+    pfxr_free_batch(results, 4);
+    
+    pfxr_sound_soa_t soa;
+    float* out[PFXR_LANES];
+    int counts[PFXR_LANES];
+    for (int l = 0; l < PFXR_LANES; l++) out[l] = lanes + l * (capacity + 1);
+    pfxr_sound_soa_load(&soa, configs, 4);
+    soa.control_interval = 16;
+    ok = pfxr_render_soa(&soa, out, capacity, counts) == 0;
+    for (int i = 0; ok && i < 4; i++) {
+        ok = memcmp(out[i], expected + i * (capacity + 1), counts[i] * sizeof(float)) == 0;
+    }
+    check(ok, "pfxr_sound_soa_t.control_interval");
+    
+    int size = pfxr_render_wav_into_interval(&configs[0], 0, PFXR_FORMAT_FLOAT32, 16, wav, capacity * 4 + 64);
+    int header = pfxr_wav_header_size(PFXR_FORMAT_FLOAT32);
+    check(size == header + counts[0] * 4 && memcmp(wav + header, expected, counts[0] * sizeof(float)) == 0,
+          "pfxr_render_wav_into_interval");
+    free(expected);
+    free(lanes);
+    free(wav);
+}
+
+int main(void) {
+    printf("Control interval tests\n");
+    printf("======================\n");
+    
+    test_generator();
+    test_accuracy();
+    test_entry_points();
+    
+    return test_summary("control interval");
+}
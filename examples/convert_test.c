@@ -0,0 +1,175 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_COUNT (1 << 18)
+
+static float samples[SAMPLE_COUNT];
+static unsigned char expected[SAMPLE_COUNT * 3];
+static unsigned char actual[SAMPLE_COUNT * 3];
+
+static const pfxr_sample_format_t formats[] = { PFXR_FORMAT_PCM16, PFXR_FORMAT_PCM8, PFXR_FORMAT_PCM24 };
+static const char* format_names[] = { "PCM16", "PCM8", "PCM24" };
+
+typedef void (*convert_kernel_t)(const float*, void*, int, pfxr_sample_format_t,
+                                 const pfxr_dither_t*, uint32_t);
+
+// Clamp edges and exact halves of each format's step, then pseudo-random
+// samples, some of them out of range
+static void fill_samples(void) {
+    static const float edges[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 1.5f, -1.5f, 1e30f, -1e30f, 0.99999994f, -0.99999994f,
+        0.5f / 32767.0f, -0.5f / 32767.0f, 1.5f / 32767.0f, 0.5f / 127.0f, -0.5f / 127.0f, 0.5f / 8388607.0f
+    };
+    int count = (int)(sizeof(edges) / sizeof(edges[0]));
+    uint32_t seed = 2024;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        if (i < count) {
+            samples[i] = edges[i];
+        } else {
+            seed = seed * 1664525u + 1013904223u;
+            samples[i] = ((float)(seed >> 8) / 16777216.0f) * 2.4f - 1.2f;
+        }
+    }
+}
+
+// Run a kernel in uneven blocks so the vector tails are covered too
+static void run_blocks(convert_kernel_t kernel, pfxr_sample_format_t format, const pfxr_dither_t* dither,
+                       unsigned char* out) {
+    int size = pfxr_sample_size(format);
+    int i = 0, n = 1;
+    while (i < SAMPLE_COUNT) {
+        int count = SAMPLE_COUNT - i < n ? SAMPLE_COUNT - i : n;
+        kernel(samples + i, out + i * size, count, format, dither, (uint32_t)i);
+        i += count;
+        n = n % 71 + 1;
+    }
+}
+
+static void compare_kernel(convert_kernel_t kernel, const char* name) {
+    pfxr_dither_t dither;
+    pfxr_dither_init(&dither, 77);
+    for (int f = 0; f < 3; f++) {
+        for (int d = 0; d < 2; d++) {
+            const pfxr_dither_t* used = d ? &dither : NULL;
+            size_t size = (size_t)SAMPLE_COUNT * pfxr_sample_size(formats[f]);
+            convert_block_scalar(samples, expected, SAMPLE_COUNT, formats[f], used, 0);
+            run_blocks(kernel, formats[f], used, actual);
+            
+            char what[128];
+            snprintf(what, sizeof(what), "%s %s%s matches the scalar code", name, format_names[f],
+                     d ? " dithered" : "");
+            check(memcmp(actual, expected, size) == 0, what);
+        }
+    }
+}
+
+static void test_kernels(void) {
+    printf("\nVector kernels are bit-exact\n");
+    
+    compare_kernel(convert_block, "convert_block");
+#ifdef PFXR_SIMD_SSE2
+    compare_kernel(convert_block_sse2, "SSE2");
+#endif
+#ifdef PFXR_SIMD_AVX2
+    if (cpu_has_avx2()) compare_kernel(convert_block_avx2, "AVX2");
+#endif
+}
+
+static void test_split_calls(void) {
+    printf("\nDither continues across calls\n");
+    
+    for (int f = 0; f < 3; f++) {
+        int size = pfxr_sample_size(formats[f]);
+        pfxr_dither_t dither;
+        pfxr_dither_init(&dither, 9);
+        pfxr_convert_samples_dither(samples, expected, SAMPLE_COUNT, formats[f], &dither);
+        int ok = dither.position == SAMPLE_COUNT;
+        
+        pfxr_dither_init(&dither, 9);
+        int i = 0, n = 3;
+        while (i < SAMPLE_COUNT) {
+            int count = SAMPLE_COUNT - i < n ? SAMPLE_COUNT - i : n;
+            pfxr_convert_samples_dither(samples + i, actual + i * size, count, formats[f], &dither);
+            i += count;
+            n = n * 7 % 1013 + 1;
+        }
+        ok = ok && dither.position == SAMPLE_COUNT && memcmp(actual, expected, (size_t)SAMPLE_COUNT * size) == 0;
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%s in uneven calls matches one call", format_names[f]);
+        check(ok, what);
+    }
+}
+
+static void test_seeds(void) {
+    printf("\nSeeds\n");
+    
+    pfxr_dither_t a, b;
+    pfxr_dither_init(&a, 5);
+    pfxr_dither_init(&b, 5);
+    pfxr_convert_samples_dither(samples, expected, SAMPLE_COUNT, PFXR_FORMAT_PCM16, &a);
+    pfxr_convert_samples_dither(samples, actual, SAMPLE_COUNT, PFXR_FORMAT_PCM16, &b);
+    check(memcmp(actual, expected, SAMPLE_COUNT * sizeof(int16_t)) == 0, "the same seed gives the same output");
+    
+    pfxr_dither_init(&b, 6);
+    pfxr_convert_samples_dither(samples, actual, SAMPLE_COUNT, PFXR_FORMAT_PCM16, &b);
+    check(memcmp(actual, expected, SAMPLE_COUNT * sizeof(int16_t)) != 0, "another seed gives other noise");
+    
+    pfxr_convert_samples(samples, actual, SAMPLE_COUNT, PFXR_FORMAT_PCM16);
+    pfxr_convert_samples_dither(samples, expected, SAMPLE_COUNT, PFXR_FORMAT_PCM16, NULL);
+    check(memcmp(actual, expected, SAMPLE_COUNT * sizeof(int16_t)) == 0, "no dither is plain conversion");
+}
+
+static void test_noise(void) {
+    printf("\nTriangular noise\n");
+    
+    // Silence dithers to -1, 0 or 1 with probabilities 1/8, 3/4 and 1/8
+    static float silence[SAMPLE_COUNT];
+    int16_t* out = (int16_t*)actual;
+    pfxr_dither_t dither;
+    pfxr_dither_init(&dither, 31);
+    pfxr_convert_samples_dither(silence, out, SAMPLE_COUNT, PFXR_FORMAT_PCM16, &dither);
+    
+    int counts[3] = { 0, 0, 0 }, outside = 0;
+    long sum = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        if (out[i] < -1 || out[i] > 1) {
+            outside++;
+        } else {
+            counts[out[i] + 1]++;
+        }
+        sum += out[i];
+    }
+    double low = (double)counts[0] / SAMPLE_COUNT, high = (double)counts[2] / SAMPLE_COUNT;
+    double mean = (double)sum / SAMPLE_COUNT;
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%.4f below, %.4f above, mean %.2g", low, high, mean);
+    check(outside == 0 && fabs(low - 0.125) < 0.01 && fabs(high - 0.125) < 0.01 && fabs(mean) < 0.01, what);
+    
+    // Full scale stays in range
+    pfxr_dither_init(&dither, 31);
+    pfxr_convert_samples_dither(samples, out, SAMPLE_COUNT, PFXR_FORMAT_PCM16, &dither);
+    int far = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        float x = samples[i] < 1.0f ? (samples[i] > -1.0f ? samples[i] : -1.0f) : 1.0f;
+        if (fabs((double)out[i] - (double)x * 32767.0) > 1.5 || out[i] < -32767) far++;
+    }
+    check(far == 0, "within 1.5 steps of the input and clamped to +-32767");
+}
+
+int main(void) {
+    printf("Sample conversion tests\n");
+    printf("=======================\n");
+    
+    fill_samples();
+    test_kernels();
+    test_split_calls();
+    test_seeds();
+    test_noise();
+    
+    return test_summary("conversion");
+}
@@ -0,0 +1,168 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const pfxr_sample_format_t formats[] = {
+    PFXR_FORMAT_PCM16, PFXR_FORMAT_FLOAT32, PFXR_FORMAT_PCM8, PFXR_FORMAT_PCM24
+};
+static const char* format_names[] = { "PCM16", "FLOAT32", "PCM8", "PCM24" };
+
+// A sound with an odd number of samples, so 8- and 24-bit data needs a pad byte
+static pfxr_sound_t odd_sound(void) {
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_PICKUP, 4);
+    while (pfxr_sound_sample_count(&config) % 2 == 0) config.sustainTime += 1.0f / PFXR_SAMPLE_RATE;
+    return config;
+}
+
+static void test_sizes(void) {
+    printf("\nSample and header sizes\n");
+    
+    check(pfxr_sample_size(PFXR_FORMAT_PCM16) == 2 && pfxr_sample_size(PFXR_FORMAT_FLOAT32) == 4 &&
+          pfxr_sample_size(PFXR_FORMAT_PCM8) == 1 && pfxr_sample_size(PFXR_FORMAT_PCM24) == 3, "sample sizes");
+    check(pfxr_wav_header_size(PFXR_FORMAT_PCM16) == 44 && pfxr_wav_header_size(PFXR_FORMAT_PCM8) == 44 &&
+          pfxr_wav_header_size(PFXR_FORMAT_PCM24) == 44 && pfxr_wav_header_size(PFXR_FORMAT_FLOAT32) == 58,
+          "44-byte PCM headers, 58-byte float header");
+    
+    char header[64];
+    check(pfxr_sample_size((pfxr_sample_format_t)99) == 0 && pfxr_wav_header_size((pfxr_sample_format_t)99) == 0 &&
+          pfxr_write_wav_header(header, 10, 0, (pfxr_sample_format_t)99) == 0, "unknown formats are refused");
+}
+
+static void test_headers(void) {
+    printf("\nHeader fields\n");
+    
+    static const int bits[] = { 16, 32, 8, 24 };
+    for (int f = 0; f < 4; f++) {
+        char out[64] = { 0 };
+        int count = 1001;
+        int data_size = count * bits[f] / 8;
+        int size = pfxr_write_wav_header(out, count, 48000, formats[f]);
+        const pfxr_wav_header_t* header = (const pfxr_wav_header_t*)out;
+        
+        int ok = size == pfxr_wav_header_size(formats[f]) &&
+                 memcmp(header->riff, "RIFF", 4) == 0 && memcmp(header->wave, "WAVE", 4) == 0 &&
+                 memcmp(header->fmt, "fmt ", 4) == 0 && header->num_channels == 1 &&
+                 header->sample_rate == 48000 && header->bits_per_sample == bits[f] &&
+                 header->block_align == bits[f] / 8 && header->byte_rate == 48000u * (uint32_t)bits[f] / 8 &&
+                 header->chunk_size == (uint32_t)(size + data_size + (data_size & 1) - 8);
+        if (formats[f] == PFXR_FORMAT_FLOAT32) {
+            const pfxr_wav_float_header_t* extended = (const pfxr_wav_float_header_t*)out;
+            ok = ok && extended->fmt_size == 18 && extended->audio_format == 3 && extended->extension_size == 0 &&
+                 memcmp(extended->fact, "fact", 4) == 0 && extended->fact_size == 4 &&
+                 extended->sample_length == (uint32_t)count && memcmp(extended->data, "data", 4) == 0 &&
+                 extended->data_size == (uint32_t)data_size;
+        } else {
+            ok = ok && header->fmt_size == 16 && header->audio_format == 1 &&
+                 memcmp(header->data, "data", 4) == 0 && header->data_size == (uint32_t)data_size;
+        }
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%s, %d samples", format_names[f], count);
+        check(ok, what);
+    }
+}
+
+static void test_conversion(void) {
+    printf("\nConverted values\n");
+    
+    static const float samples[] = { 0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 2.0f, -2.0f };
+    static const int16_t pcm16[] = { 0, 32767, -32767, 16383, -16383, 32767, -32767 };
+    static const uint8_t pcm8[] = { 128, 255, 1, 191, 65, 255, 1 };
+    static const int32_t pcm24[] = { 0, 8388607, -8388607, 4194303, -4194303, 8388607, -8388607 };
+    
+    int16_t out16[7];
+    uint8_t out8[7];
+    unsigned char out24[21];
+    float out32[7];
+    pfxr_convert_samples(samples, out16, 7, PFXR_FORMAT_PCM16);
+    pfxr_convert_samples(samples, out8, 7, PFXR_FORMAT_PCM8);
+    pfxr_convert_samples(samples, out24, 7, PFXR_FORMAT_PCM24);
+    pfxr_convert_samples(samples, out32, 7, PFXR_FORMAT_FLOAT32);
+    
+    int ok24 = 1;
+    for (int i = 0; i < 7; i++) {
+        int32_t value = (int32_t)((uint32_t)out24[i * 3] | (uint32_t)out24[i * 3 + 1] << 8 |
+                                  (uint32_t)out24[i * 3 + 2] << 16);
+        if (value & 0x800000) value -= 0x1000000;
+        if (value != pcm24[i]) ok24 = 0;
+    }
+    check(memcmp(out16, pcm16, sizeof(pcm16)) == 0, "PCM16 is scaled, truncated and clamped");
+    check(memcmp(out8, pcm8, sizeof(pcm8)) == 0, "PCM8 is unsigned with silence at 128");
+    check(ok24, "PCM24 is packed little-endian");
+    check(memcmp(out32, samples, sizeof(samples)) == 0, "FLOAT32 is copied unchanged");
+}
+
+static void test_renders(void) {
+    printf("\nRenders in every format\n");
+    
+    pfxr_sound_t config = odd_sound();
+    int count = pfxr_sound_sample_count(&config);
+    float* samples = (float*)malloc((count + 1) * sizeof(float));
+    char* expected = (char*)malloc(count * 4 + 64);
+    if (!samples || !expected) {
+        check(0, "allocate");
+        free(samples);
+        free(expected);
+        return;
+    }
+    pfxr_render_into(&config, samples, count);
+    
+    for (int f = 0; f < 4; f++) {
+        int header_size = pfxr_wav_header_size(formats[f]);
+        int data_size = count * pfxr_sample_size(formats[f]);
+        int file_size = header_size + data_size + (data_size & 1);
+        pfxr_write_wav_header(expected, count, 0, formats[f]);
+        pfxr_convert_samples(samples, expected + header_size, count, formats[f]);
+        if (data_size & 1) expected[file_size - 1] = 0;
+        
+        // Fill with a marker so a missing pad byte shows
+        char* wav = (char*)malloc(file_size + 1);
+        char* raw = (char*)malloc(data_size + 16);
+        int ok = wav && raw;
+        if (ok) {
+            memset(wav, 0x55, file_size + 1);
+            char small[16];
+            ok = pfxr_render_wav_into_format(&config, 0, formats[f], NULL, 0) == file_size &&
+                 pfxr_render_wav_into_format(&config, 0, formats[f], small, sizeof(small)) == file_size &&
+                 pfxr_render_wav_into_format(&config, 0, formats[f], wav, file_size) == file_size &&
+                 memcmp(wav, expected, file_size) == 0 && (unsigned char)wav[file_size] == 0x55;
+        }
+        char what[128];
+        snprintf(what, sizeof(what), "%s WAV of %d bytes", format_names[f], file_size);
+        check(ok, what);
+        
+        ok = raw && pfxr_render_samples_into(&config, 0, formats[f], raw, data_size) == data_size &&
+             memcmp(raw, expected + header_size, data_size) == 0;
+        snprintf(what, sizeof(what), "%s samples", format_names[f]);
+        check(ok, what);
+        
+        int size = 0;
+        char* created = pfxr_create_wav_data_format(samples, count, 0, formats[f], &size);
+        snprintf(what, sizeof(what), "%s pfxr_create_wav_data_format", format_names[f]);
+        check(created && size == file_size && memcmp(created, expected, file_size) == 0, what);
+        pfxr_free_wav_data(created);
+        free(wav);
+        free(raw);
+    }
+    
+    int size = 0;
+    check(pfxr_render_wav_into_format(&config, 0, (pfxr_sample_format_t)99, NULL, 0) == 0 &&
+          pfxr_create_wav_data_format(samples, count, 0, (pfxr_sample_format_t)99, &size) == NULL,
+          "unknown formats render nothing");
+    free(samples);
+    free(expected);
+}
+
+int main(void) {
+    printf("Sample format tests\n");
+    printf("===================\n");
+    
+    test_sizes();
+    test_headers();
+    test_conversion();
+    test_renders();
+    
+    return test_summary("sample format");
+}
@@ -0,0 +1,203 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FRAMES (PFXR_SAMPLE_RATE * 4)
+
+static float mono[3][MAX_FRAMES + 1];
+static float stereo[MAX_FRAMES * 2];
+static float other[MAX_FRAMES * 2];
+
+// A sound without a phaser, so a voice renders exactly like pfxr_render_into
+static pfxr_sound_t voice_sound(pfxr_template_t template, int seed) {
+    pfxr_sound_t config = pfxr_apply_template(template, seed);
+    config.phaserDepth = 0.0f;
+    return config;
+}
+
+// Render frames in blocks of the given sizes, cycling through them
+static void render_blocks(pfxr_mixer_t* mixer, float* out, int frames, const int* sizes, int size_count) {
+    for (int done = 0, b = 0; done < frames; b++) {
+        int n = sizes[b % size_count];
+        if (n > frames - done) n = frames - done;
+        pfxr_mixer_render(mixer, out + done * 2, n);
+        done += n;
+    }
+}
+
+static void channel_gains(float gain, float pan, float* left, float* right) {
+    float angle = (pan + 1.0f) * (float)(M_PI / 4.0);
+    *left = gain * cosf(angle);
+    *right = gain * sinf(angle);
+}
+
+static void test_mixing(void) {
+    printf("\nVoices mix with gain and pan\n");
+    
+    pfxr_sound_t a = voice_sound(PFXR_TEMPLATE_PICKUP, 1);
+    pfxr_sound_t b = voice_sound(PFXR_TEMPLATE_LASER, 2);
+    int count_a = pfxr_render_into(&a, mono[0], MAX_FRAMES);
+    int count_b = pfxr_render_into(&b, mono[1], MAX_FRAMES);
+    int frames = (count_a > count_b ? count_a : count_b) + 100;
+    
+    pfxr_mixer_t* mixer = pfxr_mixer_create(4, 0);
+    pfxr_mixer_trigger(mixer, &a, 0.5f, -0.3f, 0);
+    pfxr_mixer_trigger(mixer, &b, 0.8f, 0.6f, 0);
+    static const int sizes[] = { 1, 64, 333, 1024, 7 };
+    render_blocks(mixer, stereo, frames, sizes, 5);
+    
+    float la, ra, lb, rb;
+    channel_gains(0.5f, -0.3f, &la, &ra);
+    channel_gains(0.8f, 0.6f, &lb, &rb);
+    int mismatches = 0;
+    for (int i = 0; i < frames; i++) {
+        float left = 0.0f, right = 0.0f;
+        if (i < count_a) {
+            left += mono[0][i] * la;
+            right += mono[0][i] * ra;
+        }
+        if (i < count_b) {
+            left += mono[1][i] * lb;
+            right += mono[1][i] * rb;
+        }
+        if (stereo[i * 2] != left || stereo[i * 2 + 1] != right) mismatches++;
+    }
+    check(mismatches == 0, "two voices in uneven blocks match pfxr_render_into");
+    
+    pfxr_mixer_stats_t stats;
+    pfxr_mixer_stats(mixer, &stats);
+    check(stats.triggered == 2 && stats.active == 0 && stats.stolen == 0 && stats.dropped == 0,
+          "both voices finished");
+    
+    pfxr_mixer_trigger(mixer, &a, 1.0f, -1.0f, 0);
+    pfxr_mixer_render(mixer, stereo, count_a);
+    int right_silent = 1;
+    for (int i = 0; i < count_a; i++) right_silent = right_silent && fabsf(stereo[i * 2 + 1]) < 1e-7f;
+    check(right_silent, "hard left leaves the right channel silent");
+    pfxr_mixer_destroy(mixer);
+}
+
+static void test_determinism(void) {
+    printf("\nOutput does not depend on block sizes\n");
+    
+    pfxr_mixer_t* first = pfxr_mixer_create(8, 22050);
+    pfxr_mixer_t* second = pfxr_mixer_create(8, 22050);
+    for (int i = 0; i < 12; i++) {
+        pfxr_sound_t config = voice_sound((pfxr_template_t)(i % 10 + 1), i + 1);
+        pfxr_mixer_trigger(first, &config, 0.3f, (float)(i % 5) * 0.5f - 1.0f, i % 3);
+        pfxr_mixer_trigger(second, &config, 0.3f, (float)(i % 5) * 0.5f - 1.0f, i % 3);
+    }
+    static const int small[] = { 128 };
+    static const int mixed[] = { 1, 4096, 17, 500 };
+    render_blocks(first, stereo, 22050 * 2, small, 1);
+    render_blocks(second, other, 22050 * 2, mixed, 4);
+    check(memcmp(stereo, other, 22050 * 2 * 2 * sizeof(float)) == 0, "128-frame and mixed blocks agree");
+    pfxr_mixer_destroy(first);
+    pfxr_mixer_destroy(second);
+}
+
+static void test_stealing(void) {
+    printf("\nVoice stealing\n");
+    
+    pfxr_sound_t long_sound = voice_sound(PFXR_TEMPLATE_POWERUP, 1);
+    long_sound.sustainTime = 2.0f;
+    pfxr_mixer_t* mixer = pfxr_mixer_create(2, 0);
+    pfxr_mixer_stats_t stats;
+    
+    pfxr_mixer_trigger(mixer, &long_sound, 1.0f, 0.0f, 1);
+    pfxr_mixer_trigger(mixer, &long_sound, 1.0f, 0.0f, 2);
+    pfxr_mixer_render(mixer, stereo, 100);
+    pfxr_mixer_trigger(mixer, &long_sound, 1.0f, 0.0f, 1);
+    pfxr_mixer_render(mixer, stereo, 100);
+    pfxr_mixer_stats(mixer, &stats);
+    check(stats.stolen == 1 && stats.active == 2 && mixer->voices[0].priority == 1 && mixer->voices[0].serial == 2,
+          "the lowest priority voice is stolen");
+    
+    pfxr_mixer_trigger(mixer, &long_sound, 1.0f, 0.0f, 0);
+    pfxr_mixer_render(mixer, stereo, 100);
+    pfxr_mixer_stats(mixer, &stats);
+    check(stats.dropped == 1 && stats.stolen == 1 && stats.triggered == 3, "a trigger outranked by every voice drops");
+    
+    pfxr_mixer_stop_all(mixer);
+    int active = pfxr_mixer_render(mixer, stereo, 100);
+    int silent = 1;
+    for (int i = 0; i < 200; i++) silent = silent && stereo[i] == 0.0f;
+    check(active == 0 && silent, "stop_all silences every voice");
+    
+    for (int i = 0; i < 3; i++) {
+        pfxr_mixer_trigger(mixer, &long_sound, 1.0f, 0.0f, 5);
+        pfxr_mixer_render(mixer, stereo, 100);
+    }
+    check(mixer->voices[0].serial == 5 && mixer->voices[1].serial == 4, "among equals the oldest is stolen");
+    pfxr_mixer_destroy(mixer);
+}
+
+static void test_queue(void) {
+    printf("\nTrigger queue\n");
+    
+    pfxr_sound_t config = voice_sound(PFXR_TEMPLATE_BLIP, 1);
+    pfxr_mixer_t* mixer = pfxr_mixer_create(4, 0);
+    int refused = 0;
+    for (int i = 0; i < PFXR_MIXER_QUEUE + 5; i++) {
+        if (pfxr_mixer_trigger(mixer, &config, 1.0f, 0.0f, 0) != 0) refused++;
+    }
+    pfxr_mixer_stats_t stats;
+    pfxr_mixer_stats(mixer, &stats);
+    check(refused == 5 && stats.dropped == 5, "a full queue refuses triggers");
+    
+    pfxr_mixer_render(mixer, stereo, 16);
+    pfxr_mixer_stats(mixer, &stats);
+    check(stats.triggered == PFXR_MIXER_QUEUE && stats.stolen == PFXR_MIXER_QUEUE - 4 && stats.active == 4,
+          "a render drains the whole queue");
+    check(pfxr_mixer_trigger(mixer, &config, 1.0f, 0.0f, 0) == 0, "the queue takes triggers again");
+    pfxr_mixer_destroy(mixer);
+}
+
+#ifdef PFXR_THREADS
+#define PRODUCERS 4
+#define TRIGGERS 2000
+
+static void* trigger_main(void* arg) {
+    pfxr_mixer_t* mixer = (pfxr_mixer_t*)arg;
+    pfxr_sound_t config = voice_sound(PFXR_TEMPLATE_BLIP, 3);
+    for (int i = 0; i < TRIGGERS; i++) pfxr_mixer_trigger(mixer, &config, 0.1f, 0.0f, i % 4);
+    return NULL;
+}
+
+static void test_threads(void) {
+    printf("\nTriggers from several threads\n");
+    
+    pfxr_mixer_t* mixer = pfxr_mixer_create(16, 0);
+    pthread_t threads[PRODUCERS];
+    int started = 0;
+    for (int t = 0; t < PRODUCERS; t++) {
+        if (pthread_create(&threads[t], NULL, trigger_main, mixer) == 0) started++;
+    }
+    for (int r = 0; r < 200; r++) pfxr_mixer_render(mixer, stereo, 64);
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    pfxr_mixer_render(mixer, stereo, 64);
+    
+    pfxr_mixer_stats_t stats;
+    pfxr_mixer_stats(mixer, &stats);
+    check(started == PRODUCERS && stats.triggered + stats.dropped == (uint64_t)(PRODUCERS * TRIGGERS),
+          "every trigger starts a voice or is counted as dropped");
+    pfxr_mixer_destroy(mixer);
+}
+#endif
+
+int main(void) {
+    printf("Mixer tests\n");
+    printf("===========\n");
+    
+    test_mixing();
+    test_determinism();
+    test_stealing();
+    test_queue();
+#ifdef PFXR_THREADS
+    test_threads();
+#endif
+    
+    return test_summary("mixer");
+}
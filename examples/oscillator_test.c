@@ -0,0 +1,108 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PHASE_COUNT (1 << 20)
+
+static uint32_t phases[PHASE_COUNT];
+static float expected[PHASE_COUNT];
+static float actual[PHASE_COUNT];
+
+// Quadrant and octant edges, then an even sweep, then pseudo-random phases
+static void fill_phases(void) {
+    static const uint32_t edges[] = {
+        0x00000000u, 0x00000001u, 0x1fffffffu, 0x20000000u, 0x20000001u, 0x3fffffffu, 0x40000000u,
+        0x40000001u, 0x7fffffffu, 0x80000000u, 0x80000001u, 0xbfffffffu, 0xc0000000u, 0xffffffffu
+    };
+    int count = (int)(sizeof(edges) / sizeof(edges[0]));
+    uint32_t seed = 12345;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (i < count) {
+            phases[i] = edges[i];
+        } else if (i < PHASE_COUNT / 2) {
+            phases[i] = (uint32_t)i * 8191u;
+        } else {
+            seed = seed * 1664525u + 1013904223u;
+            phases[i] = seed;
+        }
+    }
+}
+
+// Run a kernel in uneven blocks so the vector tails are covered too
+static void run_blocks(void (*kernel)(pfxr_wave_type_t, const uint32_t*, float*, int),
+                       pfxr_wave_type_t wave, float* out) {
+    int i = 0, n = 1;
+    while (i < PHASE_COUNT) {
+        int count = PHASE_COUNT - i < n ? PHASE_COUNT - i : n;
+        kernel(wave, phases + i, out + i, count);
+        i += count;
+        n = n % 67 + 1;
+    }
+}
+
+static void compare_kernel(void (*kernel)(pfxr_wave_type_t, const uint32_t*, float*, int), const char* name) {
+    static const pfxr_wave_type_t waves[] = {
+        PFXR_WAVE_SINE, PFXR_WAVE_SAWTOOTH, PFXR_WAVE_SQUARE, PFXR_WAVE_TRIANGLE
+    };
+    static const char* wave_names[] = { "sine", "sawtooth", "square", "triangle" };
+    for (int w = 0; w < 4; w++) {
+        osc_block_scalar(waves[w], phases, expected, PHASE_COUNT);
+        run_blocks(kernel, waves[w], actual);
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%s %s matches the scalar code", name, wave_names[w]);
+        check(memcmp(actual, expected, sizeof(expected)) == 0, what);
+    }
+}
+
+static void test_kernels(void) {
+    printf("\nVector kernels are bit-exact\n");
+    
+    compare_kernel(osc_block, "osc_block");
+#ifdef PFXR_SIMD_SSE2
+    compare_kernel(osc_block_sse2, "SSE2");
+#endif
+#ifdef PFXR_SIMD_AVX2
+    if (cpu_has_avx2()) compare_kernel(osc_block_avx2, "AVX2");
+#endif
+#ifdef PFXR_SIMD_NEON
+    compare_kernel(osc_block_neon, "NEON");
+#endif
+}
+
+static void test_sine_accuracy(void) {
+    printf("\nSine accuracy\n");
+    
+#ifdef PFXR_SINE_FAST
+    const double tolerance = 2.2e-7;
+#else
+    const double tolerance = 1.0e-7;
+#endif
+    double worst = 0.0;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        double radians = (double)(int32_t)phases[i] * (2.0 * M_PI / 4294967296.0);
+        double error = fabs((double)generate_sine(phases[i]) - sin(radians));
+        if (error > worst) worst = error;
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "largest error %.3g is within %.3g", worst, tolerance);
+    check(worst <= tolerance, what);
+#ifndef PFXR_SINE_FAST
+    check(generate_sine(0) == 0.0f && generate_sine(0x80000000u) == 0.0f, "zero at the zero crossings");
+    check(generate_sine(0x40000000u) == 1.0f && generate_sine(0xc0000000u) == -1.0f, "exactly 1 at the peaks");
+#endif
+}
+
+int main(void) {
+    printf("Oscillator kernel tests\n");
+    printf("=======================\n");
+    
+    fill_phases();
+    test_kernels();
+    test_sine_accuracy();
+    
+    return test_summary("oscillator");
+}
@@ -0,0 +1,102 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A constant tone at full gain for nearly PFXR_MAX_DURATION seconds
+static pfxr_sound_t long_tone(pfxr_wave_type_t wave, float frequency) {
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = wave;
+    config.frequency = frequency;
+    config.volume = 1.0f;
+    config.attackTime = 0.0f;
+    config.sustainTime = PFXR_MAX_DURATION - 0.1f;
+    config.sustainPunch = 0.0f;
+    config.decayTime = 0.0f;
+    config.pitchDelta = 0.0f;
+    config.vibratoDepth = config.tremoloDepth = config.phaserDepth = config.noiseAmount = 0.0f;
+    config.highPassCutoff = config.lowPassCutoff = 0.0f;
+    return config;
+}
+
+static void test_oscillator_phase(void) {
+    printf("\nOscillator phase stays accurate to the end of long sounds\n");
+    
+    static const float frequencies[] = { 55.0f, 123.4f, 441.0f, 1000.0f, 3520.0f };
+    static float out[PFXR_SAMPLE_RATE * 4];
+    for (int f = 0; f < 5; f++) {
+        pfxr_sound_t config = long_tone(PFXR_WAVE_SINE, frequencies[f]);
+        int count = pfxr_render_into(&config, out, PFXR_SAMPLE_RATE * 4);
+        
+        double worst = 0.0;
+        for (int i = 0; i < count; i++) {
+            double expected = sin(2.0 * M_PI * (double)config.frequency * i / PFXR_SAMPLE_RATE);
+            double error = fabs((double)out[i] - expected);
+            if (error > worst) worst = error;
+        }
+        
+        // The increment is rounded once per sound, so the drift grows slowly
+        // and linearly; 1/1000 of a cycle after four seconds
+        char what[128];
+        snprintf(what, sizeof(what), "%.1f Hz for %d samples, largest error %.3g", frequencies[f], count, worst);
+        check(count > PFXR_SAMPLE_RATE * 3 && worst <= 2.0 * M_PI * 1e-3, what);
+    }
+}
+
+static void test_lfo_phase(void) {
+    printf("\nLFO phase\n");
+    
+    static float out[PFXR_SAMPLE_RATE * 4];
+    pfxr_sound_t config = long_tone(PFXR_WAVE_SQUARE, 440.0f);
+    config.tremoloRate = 13.7f;
+    config.tremoloDepth = 0.5f;
+    int count = pfxr_render_into(&config, out, PFXR_SAMPLE_RATE * 4);
+    
+    // A square wave is exactly +-1, leaving the tremolo gain
+    double worst = 0.0;
+    for (int i = 0; i < count; i++) {
+        double lfo = sin(2.0 * M_PI * (double)config.tremoloRate * i / PFXR_SAMPLE_RATE);
+        double expected = 1.0 - config.tremoloDepth * (1.0 + lfo) * 0.5;
+        double error = fabs(fabs((double)out[i]) - expected);
+        if (error > worst) worst = error;
+    }
+    
+    // The LFO step is rounded to half a phase unit at most
+    double drift = 2.0 * M_PI * 0.5 * count / 4294967296.0;
+    double bound = config.tremoloDepth * 0.5 * drift + 1e-6;
+    char what[128];
+    snprintf(what, sizeof(what), "tremolo largest error %.3g is within %.3g", worst, bound);
+    check(worst <= bound, what);
+}
+
+static void test_periodicity(void) {
+    printf("\nPhase wraps without a seam\n");
+    
+    static float out[PFXR_SAMPLE_RATE * 4];
+    pfxr_sound_t config = long_tone(PFXR_WAVE_SAWTOOTH, 441.0f);
+    int count = pfxr_render_into(&config, out, PFXR_SAMPLE_RATE * 4);
+    
+    // 441 Hz repeats every 100 samples; the rounded increment drifts by
+    // under one phase unit per sample
+    double worst = 0.0;
+    for (int i = 100; i < count; i++) {
+        double change = fabs((double)out[i] - (double)out[i - 100]);
+        if (change > worst) worst = change;
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "sawtooth period to period change %.3g", worst);
+    check(worst <= 1e-4, what);
+}
+
+int main(void) {
+    printf("Phase accumulator tests\n");
+    printf("=======================\n");
+    
+    test_oscillator_phase();
+    test_lfo_phase();
+    test_periodicity();
+    
+    return test_summary("phase");
+}
@@ -0,0 +1,206 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A plain sine with every effect off
+static pfxr_sound_t plain_sine(float frequency) {
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = PFXR_WAVE_SINE;
+    config.frequency = frequency;
+    config.pitchDelta = 0.0f;
+    config.vibratoDepth = config.tremoloDepth = config.phaserDepth = config.noiseAmount = 0.0f;
+    config.highPassCutoff = config.lowPassCutoff = 0.0f;
+    return config;
+}
+
+static float* render_at(const pfxr_sound_t* config, int sample_rate, int* count) {
+    *count = pfxr_sound_sample_count_rate(config, sample_rate);
+    float* out = (float*)malloc((*count + 1) * sizeof(float));
+    if (out && pfxr_render_into_rate(config, sample_rate, out, *count) != *count) {
+        free(out);
+        out = NULL;
+    }
+    return out;
+}
+
+static void test_durations(void) {
+    printf("\nDurations scale with the rate\n");
+    
+    static const int rates[] = { 8000, 22050, 44100, 48000, 96000 };
+    int sounds = 0, bad = 0;
+    for (int t = PFXR_TEMPLATE_DEFAULT; t <= PFXR_TEMPLATE_RANDOM; t++) {
+        for (int seed = 1; seed <= 5; seed++) {
+            pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)t, seed);
+            float duration = config.attackTime + config.sustainTime + config.decayTime;
+            for (int r = 0; r < 5; r++) {
+                int expected = (int)(duration * (float)rates[r]);
+                if (expected > (int)(rates[r] * PFXR_MAX_DURATION)) expected = (int)(rates[r] * PFXR_MAX_DURATION);
+                
+                pfxr_generator_t gen;
+                pfxr_generator_init_rate(&gen, &config, rates[r]);
+                if (pfxr_sound_sample_count_rate(&config, rates[r]) != expected ||
+                    pfxr_generator_remaining(&gen) != expected) bad++;
+            }
+            sounds++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%d sounds at 5 rates, %d wrong lengths", sounds, bad);
+    check(bad == 0, what);
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_LASER, 3);
+    int standard = pfxr_sound_sample_count(&config);
+    check(pfxr_sound_sample_count_rate(&config, 0) == standard &&
+          pfxr_sound_sample_count_rate(&config, -5) == standard, "0 and below mean PFXR_SAMPLE_RATE");
+    check(pfxr_sound_sample_count_rate(&config, PFXR_MAX_SAMPLE_RATE * 2) ==
+          pfxr_sound_sample_count_rate(&config, PFXR_MAX_SAMPLE_RATE), "rates above PFXR_MAX_SAMPLE_RATE are clamped");
+    
+    config.sustainTime = PFXR_MAX_DURATION * 2.0f;
+    check(pfxr_sound_sample_count_rate(&config, 22050) == (int)(22050 * PFXR_MAX_DURATION),
+          "the duration limit is in seconds");
+}
+
+static void test_entry_points(void) {
+    printf("\nEvery render path takes the rate\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_POWERUP, 7);
+    int count = 0;
+    float* expected = render_at(&config, 22050, &count);
+    float* out = (float*)malloc((count + 1) * sizeof(float));
+    if (!expected || !out) {
+        check(0, "render");
+        free(expected);
+        free(out);
+        return;
+    }
+    check(count < pfxr_sound_sample_count(&config), "22050 Hz renders fewer samples");
+    
+    pfxr_generator_t gen;
+    pfxr_generator_init_rate(&gen, &config, 22050);
+    pfxr_generator_set_history(&gen, out, count);
+    int position = 0, n;
+    while ((n = pfxr_generator_render(&gen, out + position, 100)) > 0) position += n;
+    check(position == count && memcmp(out, expected, count * sizeof(float)) == 0, "streaming generator");
+    
+    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(count);
+    int ok = buffer != NULL;
+    if (ok) {
+        buffer->sample_rate = 22050;
+        pfxr_generate_sound(&config, buffer);
+        ok = buffer->sample_count == count && memcmp(buffer->samples, expected, count * sizeof(float)) == 0;
+    }
+    check(ok, "pfxr_generate_sound with buffer->sample_rate");
+    pfxr_free_audio_buffer(buffer);
+    
+    int wav_size = pfxr_render_wav_into_rate(&config, 22050, NULL, 0);
+    char* wav = (char*)malloc(wav_size);
+    int16_t* pcm = (int16_t*)malloc(count * sizeof(int16_t));
+    ok = wav && pcm && pfxr_render_wav_into_rate(&config, 22050, wav, wav_size) == wav_size;
+    if (ok) {
+        pfxr_convert_samples(expected, pcm, count, PFXR_FORMAT_PCM16);
+        ok = memcmp(wav + sizeof(pfxr_wav_header_t), pcm, count * sizeof(int16_t)) == 0;
+    }
+    check(ok, "pfxr_render_wav_into_rate holds the same samples");
+    free(wav);
+    free(pcm);
+    free(expected);
+    free(out);
+}
+
+static void test_headers(void) {
+    printf("\nWAV headers carry the rate\n");
+    
+    static const int rates[] = { 22050, 44100, 48000 };
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_HIT, 2);
+    for (int r = 0; r < 3; r++) {
+        int size = pfxr_render_wav_into_rate(&config, rates[r], NULL, 0);
+        char* wav = (char*)malloc(size);
+        int count = pfxr_sound_sample_count_rate(&config, rates[r]);
+        int ok = wav && pfxr_render_wav_into_rate(&config, rates[r], wav, size) == size;
+        if (ok) {
+            const pfxr_wav_header_t* header = (const pfxr_wav_header_t*)wav;
+            ok = header->sample_rate == (uint32_t)rates[r] && header->byte_rate == (uint32_t)rates[r] * 2 &&
+                 header->data_size == (uint32_t)count * 2;
+        }
+        
+        char what[128];
+        snprintf(what, sizeof(what), "rendered at %d Hz", rates[r]);
+        check(ok, what);
+        free(wav);
+    }
+    
+    float samples[100] = { 0 };
+    int size = 0;
+    char* wav = pfxr_create_wav_data_rate(samples, 100, 48000, &size);
+    const pfxr_wav_header_t* header = (const pfxr_wav_header_t*)wav;
+    check(wav && header->sample_rate == 48000 && header->byte_rate == 96000, "pfxr_create_wav_data_rate");
+    pfxr_free_wav_data(wav);
+    
+    wav = pfxr_create_wav_data_rate(samples, 100, 0, &size);
+    header = (const pfxr_wav_header_t*)wav;
+    check(wav && header->sample_rate == PFXR_SAMPLE_RATE, "0 writes PFXR_SAMPLE_RATE");
+    pfxr_free_wav_data(wav);
+}
+
+// Largest difference between a render at rate and one at twice the rate,
+// sampled at the same instants
+static double time_error(const pfxr_sound_t* config, int rate, int skip) {
+    int count = 0, double_count = 0;
+    float* low = render_at(config, rate, &count);
+    float* high = render_at(config, rate * 2, &double_count);
+    double worst = low && high ? 0.0 : 1e9;
+    for (int i = skip; low && high && i < count && i * 2 < double_count; i++) {
+        double error = fabs((double)low[i] - (double)high[i * 2]);
+        if (error > worst) worst = error;
+    }
+    free(low);
+    free(high);
+    return worst;
+}
+
+static void test_same_sound(void) {
+    printf("\nA sound is the same in time at every rate\n");
+    
+    pfxr_sound_t config = plain_sine(440.0f);
+    double error = time_error(&config, 22050, 0);
+    char what[128];
+    snprintf(what, sizeof(what), "sine frequency and envelope, largest error %.3g", error);
+    check(error <= 1e-5, what);
+    
+    config.tremoloRate = 9.0f;
+    config.tremoloDepth = 0.5f;
+    error = time_error(&config, 22050, 0);
+    snprintf(what, sizeof(what), "tremolo rate, largest error %.3g", error);
+    check(error <= 1e-5, what);
+    
+    config = plain_sine(440.0f);
+    config.pitchDelta = 300.0f;
+    config.vibratoRate = 6.0f;
+    config.vibratoDepth = 30.0f;
+    error = time_error(&config, 22050, 0);
+    snprintf(what, sizeof(what), "pitch sweep and vibrato, largest error %.3g", error);
+    check(error <= 2e-2, what);
+    
+    // The filters warp a little near the Nyquist frequency, so only check
+    // well below it and after the first millisecond
+    config = plain_sine(300.0f);
+    config.lowPassCutoff = 1500.0f;
+    error = time_error(&config, 22050, 22);
+    snprintf(what, sizeof(what), "low-pass response, largest error %.3g", error);
+    check(error <= 2e-2, what);
+}
+
+int main(void) {
+    printf("Sample rate tests\n");
+    printf("=================\n");
+    
+    test_durations();
+    test_entry_points();
+    test_headers();
+    test_same_sound();
+    
+    return test_summary("sample rate");
+}
@@ -0,0 +1,128 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The segments must tile [0, total) in order, with kinds rising from first_kind
+static int segments_tile(const pfxr_segment_t* segments, int count, int total, int first_kind) {
+    int position = 0, kind = first_kind - 1;
+    for (int s = 0; s < count; s++) {
+        if (segments[s].start != position || segments[s].length <= 0) return 0;
+        if ((int)segments[s].kind <= kind || (int)segments[s].kind > first_kind + 2) return 0;
+        kind = (int)segments[s].kind;
+        position += segments[s].length;
+    }
+    return position == total;
+}
+
+static void test_tiling(void) {
+    printf("\nSegments cover every sample once, in order\n");
+    
+    int sounds = 0, bad = 0;
+    for (int t = PFXR_TEMPLATE_DEFAULT; t <= PFXR_TEMPLATE_RANDOM; t++) {
+        for (int seed = 1; seed <= 20; seed++) {
+            pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)t, seed);
+            pfxr_segment_t segments[PFXR_MAX_SEGMENTS];
+            int count = pfxr_sound_segments(&config, segments, PFXR_MAX_SEGMENTS);
+            int total = pfxr_sound_sample_count(&config);
+            
+            int envelope = 0;
+            while (envelope < count && segments[envelope].kind <= PFXR_SEGMENT_DECAY) envelope++;
+            if (count > PFXR_MAX_SEGMENTS || pfxr_sound_segments(&config, NULL, 0) != count ||
+                !segments_tile(segments, envelope, total, PFXR_SEGMENT_ATTACK) ||
+                !segments_tile(segments + envelope, count - envelope, total, PFXR_SEGMENT_PITCH_DELAY)) {
+                bad++;
+            }
+            sounds++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%d sounds, %d bad segment lists", sounds, bad);
+    check(bad == 0, what);
+}
+
+static void test_envelope_output(void) {
+    printf("\nA plain square wave follows the envelope segments\n");
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = PFXR_WAVE_SQUARE;
+    config.volume = 0.5f;
+    config.attackTime = 0.05f;
+    config.sustainTime = 0.1f;
+    config.sustainPunch = 0.4f;
+    config.decayTime = 0.2f;
+    config.pitchDelta = 0.0f;
+    config.vibratoDepth = config.tremoloDepth = 0.0f;
+    config.highPassCutoff = config.lowPassCutoff = 0.0f;
+    config.phaserDepth = config.noiseAmount = 0.0f;
+    
+    pfxr_segment_t segments[PFXR_MAX_SEGMENTS];
+    int segment_count = pfxr_sound_segments(&config, segments, PFXR_MAX_SEGMENTS);
+    int count = pfxr_sound_sample_count(&config);
+    float* out = (float*)malloc((count + 1) * sizeof(float));
+    if (!out) {
+        check(0, "allocate");
+        return;
+    }
+    pfxr_render_into(&config, out, count);
+    
+    int mismatches = 0;
+    for (int s = 0; s < segment_count && segments[s].kind <= PFXR_SEGMENT_DECAY; s++) {
+        for (int k = 0; k < segments[s].length; k++) {
+            float gain = segments[s].value + (float)k * segments[s].step;
+            if (gain < 0.0f) gain = 0.0f;
+            if (fabsf(out[segments[s].start + k]) != gain * config.volume) mismatches++;
+        }
+    }
+    check(segment_count >= 3 && segments[0].kind == PFXR_SEGMENT_ATTACK, "attack, sustain and decay present");
+    check(mismatches == 0, "every sample is the segment value times the volume");
+    free(out);
+}
+
+static void test_pitch_segments(void) {
+    printf("\nPitch segments\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_JUMP, 5);
+    config.pitchDelay = 0.05f;
+    config.pitchDuration = 0.5f;
+    pfxr_segment_t segments[PFXR_MAX_SEGMENTS];
+    int count = pfxr_sound_segments(&config, segments, PFXR_MAX_SEGMENTS);
+    
+    const pfxr_segment_t* delay = NULL;
+    const pfxr_segment_t* sweep = NULL;
+    const pfxr_segment_t* hold = NULL;
+    for (int s = 0; s < count; s++) {
+        if (segments[s].kind == PFXR_SEGMENT_PITCH_DELAY) delay = &segments[s];
+        if (segments[s].kind == PFXR_SEGMENT_SWEEP) sweep = &segments[s];
+        if (segments[s].kind == PFXR_SEGMENT_HOLD) hold = &segments[s];
+    }
+    check(delay && sweep && hold, "delay, sweep and hold present");
+    if (!delay || !sweep || !hold) return;
+    
+    float target = config.frequency + config.pitchDelta * config.pitchDuration;
+    float swept = sweep->value + (float)sweep->length * sweep->step;
+    check(delay->value == config.frequency && delay->step == 0.0f, "the delay holds the base frequency");
+    check(hold->value == target && hold->step == 0.0f, "the hold keeps the final frequency");
+    check(fabsf(swept - target) <= fabsf(sweep->step) + 1e-3f * fabsf(target),
+          "the sweep ends at the final frequency");
+    
+    config.pitchDelta = 0.0f;
+    count = pfxr_sound_segments(&config, segments, PFXR_MAX_SEGMENTS);
+    int envelope = 0;
+    while (envelope < count && segments[envelope].kind <= PFXR_SEGMENT_DECAY) envelope++;
+    check(count - envelope == 1 && segments[envelope].kind == PFXR_SEGMENT_PITCH_DELAY,
+          "no sweep gives one constant segment");
+}
+
+int main(void) {
+    printf("Segment tests\n");
+    printf("=============\n");
+    
+    test_tiling();
+    test_envelope_output();
+    test_pitch_segments();
+    
+    return test_summary("segment");
+}
@@ -0,0 +1,124 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACITY (PFXR_SAMPLE_RATE * 8)
+#define SENTINEL 12345.0f
+
+static float lane_buffers[PFXR_LANES][CAPACITY + 1];
+static float expected[CAPACITY + 1];
+
+static void test_load_get(void) {
+    printf("\nLoading and reading lanes back\n");
+    
+    pfxr_sound_t configs[PFXR_LANES];
+    for (int l = 0; l < PFXR_LANES; l++) configs[l] = pfxr_apply_template(PFXR_TEMPLATE_RANDOM, l + 1);
+    pfxr_sound_soa_t soa;
+    pfxr_sound_soa_load(&soa, configs, PFXR_LANES);
+    
+    int mismatches = 0;
+    for (int l = 0; l < PFXR_LANES; l++) {
+        pfxr_sound_t config;
+        pfxr_sound_soa_get(&soa, l, &config);
+        if (memcmp(&config, &configs[l], sizeof(config)) != 0) mismatches++;
+    }
+    check(soa.count == PFXR_LANES && mismatches == 0, "every lane reads back unchanged");
+}
+
+// Render configs as lanes at sample_rate and compare each lane, and the
+// sample after it, with a single render
+static int lanes_match(const pfxr_sound_t* configs, int count, int sample_rate) {
+    pfxr_sound_soa_t soa;
+    pfxr_sound_soa_load(&soa, configs, count);
+    soa.sample_rate = sample_rate;
+    
+    float* out[PFXR_LANES];
+    int counts[PFXR_LANES];
+    for (int l = 0; l < PFXR_LANES; l++) {
+        out[l] = lane_buffers[l];
+        for (int i = 0; i <= CAPACITY; i++) lane_buffers[l][i] = SENTINEL;
+    }
+    if (pfxr_render_soa(&soa, out, CAPACITY, counts) != 0) return 0;
+    
+    for (int l = 0; l < count; l++) {
+        int n = pfxr_render_into_rate(&configs[l], sample_rate, expected, CAPACITY);
+        if (counts[l] != n || memcmp(out[l], expected, n * sizeof(float)) != 0) return 0;
+        if (n < CAPACITY && out[l][n] != SENTINEL) return 0;
+    }
+    for (int l = count; l < PFXR_LANES; l++) {
+        if (counts[l] != 0 || out[l][0] != SENTINEL) return 0;
+    }
+    return 1;
+}
+
+static void test_bit_exact(void) {
+    printf("\nLanes match pfxr_render_into bit for bit\n");
+    
+    static const int rates[] = { PFXR_SAMPLE_RATE, 22050, 48000 };
+    for (int r = 0; r < 3; r++) {
+        int groups = 0, bad = 0;
+        for (int t = PFXR_TEMPLATE_DEFAULT; t <= PFXR_TEMPLATE_RANDOM; t++) {
+            for (int count = 1; count <= PFXR_LANES; count += 3) {
+                pfxr_sound_t configs[PFXR_LANES];
+                for (int l = 0; l < count; l++) configs[l] = pfxr_apply_template((pfxr_template_t)t, l * 7 + count);
+                if (!lanes_match(configs, count, rates[r])) bad++;
+                groups++;
+            }
+        }
+        
+        char what[128];
+        snprintf(what, sizeof(what), "%d Hz, %d groups, %d mismatched", rates[r], groups, bad);
+        check(bad == 0, what);
+    }
+    
+    // Lanes with every effect, including a phaser deeper than the inline history
+    pfxr_sound_t configs[PFXR_LANES];
+    for (int l = 0; l < PFXR_LANES; l++) {
+        configs[l] = pfxr_apply_template(PFXR_TEMPLATE_POWERUP, l + 1);
+        configs[l].waveForm = (pfxr_wave_type_t)(l % 4);
+        configs[l].vibratoRate = 9.0f + l;
+        configs[l].vibratoDepth = 30.0f;
+        configs[l].tremoloRate = 5.0f + l;
+        configs[l].tremoloDepth = 0.4f;
+        configs[l].phaserDepth = 300.0f;
+        configs[l].phaserBaseFrequency = l % 2 ? 2.0f : 500.0f;
+        configs[l].phaserLfoFrequency = 1.5f;
+        configs[l].lowPassCutoff = 2000.0f;
+        configs[l].highPassCutoff = 200.0f;
+        configs[l].noiseAmount = l % 3 ? 0.0f : 20.0f;
+    }
+    check(lanes_match(configs, PFXR_LANES, PFXR_SAMPLE_RATE), "every effect, mixed waveforms and deep phasers");
+}
+
+static void test_capacity(void) {
+    printf("\nCapacity\n");
+    
+    pfxr_sound_t configs[2] = { pfxr_apply_template(PFXR_TEMPLATE_BLIP, 1), pfxr_apply_template(PFXR_TEMPLATE_FART, 1) };
+    pfxr_sound_soa_t soa;
+    pfxr_sound_soa_load(&soa, configs, 2);
+    
+    float* out[PFXR_LANES] = { lane_buffers[0], lane_buffers[1] };
+    int longest = pfxr_sound_sample_count(&configs[0]);
+    if (pfxr_sound_sample_count(&configs[1]) > longest) longest = pfxr_sound_sample_count(&configs[1]);
+    lane_buffers[0][0] = lane_buffers[1][0] = SENTINEL;
+    check(pfxr_render_soa(&soa, out, longest - 1, NULL) == -1 &&
+          lane_buffers[0][0] == SENTINEL && lane_buffers[1][0] == SENTINEL,
+          "too little capacity fails without rendering");
+    check(pfxr_render_soa(&soa, out, longest, NULL) == 0, "exactly enough capacity renders");
+    
+    out[1] = NULL;
+    check(pfxr_render_soa(&soa, out, CAPACITY, NULL) == -1, "a used lane without output fails");
+}
+
+int main(void) {
+    printf("Lane-parallel render tests\n");
+    printf("==========================\n");
+    
+    test_load_get();
+    test_bit_exact();
+    test_capacity();
+    
+    return test_summary("lane-parallel");
+}
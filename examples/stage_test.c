@@ -0,0 +1,107 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A plain square wave with every effect off
+static pfxr_sound_t plain_sound(void) {
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = PFXR_WAVE_SQUARE;
+    config.pitchDelta = 0.0f;
+    config.vibratoRate = config.vibratoDepth = 0.0f;
+    config.tremoloRate = config.tremoloDepth = 0.0f;
+    config.highPassCutoff = config.lowPassCutoff = 0.0f;
+    config.phaserDepth = 0.0f;
+    config.noiseAmount = 0.0f;
+    return config;
+}
+
+static unsigned int planned_stages(const pfxr_sound_t* config) {
+    pfxr_generator_t gen;
+    pfxr_generator_init(&gen, config);
+    return gen.stages;
+}
+
+static int renders_equal(const pfxr_sound_t* a, const pfxr_sound_t* b) {
+    int count = pfxr_sound_sample_count(a);
+    if (pfxr_sound_sample_count(b) != count) return 0;
+    
+    float* out_a = (float*)malloc((count + 1) * sizeof(float));
+    float* out_b = (float*)malloc((count + 1) * sizeof(float));
+    int equal = out_a && out_b;
+    if (equal) {
+        pfxr_render_into(a, out_a, count);
+        pfxr_render_into(b, out_b, count);
+        equal = memcmp(out_a, out_b, count * sizeof(float)) == 0;
+    }
+    free(out_a);
+    free(out_b);
+    return equal;
+}
+
+static void test_stage_bits(void) {
+    printf("\nEach effect enables its own stage\n");
+    
+    pfxr_sound_t plain = plain_sound();
+    check(planned_stages(&plain) == 0, "no stages without effects");
+    
+    pfxr_sound_t config = plain;
+    config.pitchDelta = 200.0f;
+    check(planned_stages(&config) == PFXR_STAGE_PITCH_SWEEP, "pitch sweep");
+    
+    config = plain;
+    config.vibratoRate = 10.0f;
+    config.vibratoDepth = 20.0f;
+    check(planned_stages(&config) == PFXR_STAGE_VIBRATO, "vibrato");
+    
+    config = plain;
+    config.noiseAmount = 30.0f;
+    check(planned_stages(&config) == PFXR_STAGE_NOISE, "noise");
+    
+    config = plain;
+    config.phaserDepth = 100.0f;
+    check(planned_stages(&config) == PFXR_STAGE_PHASER, "phaser");
+    
+    config = plain;
+    config.lowPassCutoff = 1000.0f;
+    check(planned_stages(&config) == PFXR_STAGE_LOWPASS, "low-pass");
+    
+    config = plain;
+    config.highPassCutoff = 300.0f;
+    check(planned_stages(&config) == PFXR_STAGE_HIGHPASS, "high-pass");
+    
+    config = plain;
+    config.tremoloRate = 8.0f;
+    config.tremoloDepth = 0.5f;
+    check(planned_stages(&config) == PFXR_STAGE_TREMOLO, "tremolo");
+}
+
+static void test_inactive_settings(void) {
+    printf("\nSettings of inactive effects change nothing\n");
+    
+    pfxr_sound_t plain = plain_sound();
+    pfxr_sound_t config = plain;
+    config.vibratoDepth = 50.0f;
+    config.tremoloRate = 12.0f;
+    config.phaserBaseFrequency = 80.0f;
+    config.phaserLfoFrequency = 3.0f;
+    config.lowPassResonance = 5.0f;
+    config.highPassResonance = 5.0f;
+    check(planned_stages(&config) == 0, "still no stages");
+    check(renders_equal(&plain, &config), "output is unchanged");
+    
+    config = plain;
+    config.lowPassCutoff = 4000.0f;
+    check(planned_stages(&config) == 0 && renders_equal(&plain, &config), "a low-pass at 4 kHz or above is skipped");
+}
+
+int main(void) {
+    printf("Render plan tests\n");
+    printf("=================\n");
+    
+    test_stage_bits();
+    test_inactive_settings();
+    
+    return test_summary("render plan");
+}
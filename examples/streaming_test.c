@@ -0,0 +1,105 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Stream a sound in blocks of block_size and compare with the one-shot render.
+// The delay line is as long as the sound, like the output buffer of
+// pfxr_generate_sound, so deep phasers are exact too.
+static int stream_matches(const pfxr_sound_t* config, const float* expected, int count, int block_size,
+                          float* out, float* history) {
+    pfxr_generator_t gen;
+    pfxr_generator_init(&gen, config);
+    pfxr_generator_set_history(&gen, history, count);
+    if (pfxr_generator_remaining(&gen) != count) return 0;
+    
+    int position = 0;
+    int n;
+    while ((n = pfxr_generator_render(&gen, out + position, block_size)) > 0) {
+        if (n > block_size || position + n > count) return 0;
+        position += n;
+        if (pfxr_generator_remaining(&gen) != count - position) return 0;
+    }
+    return position == count && memcmp(out, expected, count * sizeof(float)) == 0;
+}
+
+static void test_block_sizes(void) {
+    printf("\nStreaming matches pfxr_generate_sound for any block size\n");
+    
+    static const int block_sizes[] = { 1, 7, 64, 100, 256, 1000, 4096 };
+    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
+    float* out = (float*)malloc((PFXR_MAX_SAMPLES + 1) * sizeof(float));
+    float* history = (float*)malloc((PFXR_MAX_SAMPLES + 1) * sizeof(float));
+    if (!buffer || !out || !history) {
+        check(0, "allocate");
+        pfxr_free_audio_buffer(buffer);
+        free(out);
+        free(history);
+        return;
+    }
+    
+    int sounds = 0, mismatches = 0;
+    for (int t = PFXR_TEMPLATE_DEFAULT; t <= PFXR_TEMPLATE_RANDOM; t++) {
+        for (int seed = 1; seed <= 10; seed++) {
+            pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)t, seed);
+            pfxr_generate_sound(&config, buffer);
+            for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+                if (!stream_matches(&config, buffer->samples, buffer->sample_count, block_sizes[b], out, history)) {
+                    mismatches++;
+                }
+            }
+            sounds++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%d sounds in 7 block sizes, %d mismatches", sounds, mismatches);
+    check(mismatches == 0, what);
+    pfxr_free_audio_buffer(buffer);
+    free(out);
+    free(history);
+}
+
+static void test_short_buffer(void) {
+    printf("\npfxr_generate_sound stops at the buffer capacity\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_LASER, 7);
+    pfxr_audio_buffer_t* full = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
+    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(1000);
+    int ok = full && buffer;
+    if (ok) {
+        pfxr_generate_sound(&config, full);
+        pfxr_generate_sound(&config, buffer);
+        ok = full->sample_count > 1000 && buffer->sample_count == 1000 &&
+             memcmp(buffer->samples, full->samples, 1000 * sizeof(float)) == 0;
+    }
+    check(ok, "LASER seed 7 in 1000 samples");
+    pfxr_free_audio_buffer(full);
+    pfxr_free_audio_buffer(buffer);
+}
+
+static void test_finished(void) {
+    printf("\nA finished generator renders nothing\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_BLIP, 3);
+    pfxr_generator_t gen;
+    float block[512];
+    pfxr_generator_init(&gen, &config);
+    while (pfxr_generator_render(&gen, block, 512) > 0) {
+    }
+    check(pfxr_generator_remaining(&gen) == 0, "no samples remaining");
+    check(pfxr_generator_render(&gen, block, 512) == 0, "render returns 0");
+    check(pfxr_generator_render(&gen, block, 0) == 0, "empty block returns 0");
+}
+
+int main(void) {
+    printf("Streaming generator tests\n");
+    printf("=========================\n");
+    
+    test_block_sizes();
+    test_short_buffer();
+    test_finished();
+    
+    return test_summary("streaming");
+}
@@ -0,0 +1,27 @@
+// Checks shared by the test programs. Include after pfxr.h; each program
+// prints its checks and returns test_summary() from main.
+
+#ifndef PFXR_TEST_H
+#define PFXR_TEST_H
+
+#include <stdio.h>
+
+static int failures = 0;
+
+// Print one check and count it when it fails
+static void check(int ok, const char* what) {
+    printf("  %s %s\n", ok ? "✓" : "✗", what);
+    if (!ok) failures++;
+}
+
+// Print the outcome, returns the exit status
+static int test_summary(const char* name) {
+    if (failures) {
+        printf("\nFAILED\n");
+    } else {
+        printf("\nAll %s tests passed\n", name);
+    }
+    return failures ? 1 : 0;
+}
+
+#endif
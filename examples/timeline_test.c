@@ -0,0 +1,150 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENT_COUNT 60
+
+static pfxr_timeline_event_t events[EVENT_COUNT];
+
+static void make_events(int spread) {
+    uint32_t seed = 31;
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        events[i].offset = (int)(seed >> 8) % spread - 5000;
+        events[i].gain = (float)((seed >> 4) % 1000) / 1000.0f + 0.1f;
+        events[i].config = pfxr_apply_template((pfxr_template_t)(i % 11), i + 1);
+    }
+    
+    // Two events at one offset, and a silent one
+    events[1].offset = events[0].offset;
+    events[2].config.attackTime = events[2].config.sustainTime = events[2].config.decayTime = 0.0f;
+}
+
+typedef struct {
+    int index;
+    int start;
+    int order;              // Mixing order: even segments, then odd, then by start
+} reference_key_t;
+
+static int compare_reference_keys(const void* a, const void* b) {
+    const reference_key_t* ka = (const reference_key_t*)a;
+    const reference_key_t* kb = (const reference_key_t*)b;
+    if (ka->order != kb->order) return ka->order - kb->order;
+    if (ka->start != kb->start) return ka->start < kb->start ? -1 : 1;
+    return ka->index - kb->index;
+}
+
+// Each event rendered with pfxr_render_into_rate, scaled by its gain and
+// added at its offset, in the order the timeline mixes them
+static float* reference_track(int sample_rate, int length) {
+    float* track = (float*)calloc(length, sizeof(float));
+    float* sound = (float*)malloc((PFXR_MAX_DURATION * 96000 + 1) * sizeof(float));
+    reference_key_t keys[EVENT_COUNT];
+    if (!track || !sound) {
+        free(track);
+        free(sound);
+        return NULL;
+    }
+    
+    int segment_length = 1;
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        int count = pfxr_sound_sample_count_rate(&events[i].config, sample_rate);
+        if (count > segment_length) segment_length = count;
+    }
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        keys[i].index = i;
+        keys[i].start = events[i].offset;
+        keys[i].order = ((events[i].offset > 0 ? events[i].offset : 0) / segment_length) % 2;
+    }
+    qsort(keys, EVENT_COUNT, sizeof(reference_key_t), compare_reference_keys);
+    
+    for (int k = 0; k < EVENT_COUNT; k++) {
+        const pfxr_timeline_event_t* event = &events[keys[k].index];
+        int count = pfxr_render_into_rate(&event->config, sample_rate, sound, PFXR_MAX_DURATION * 96000);
+        for (int i = 0; i < count; i++) {
+            if (event->offset + i >= 0) track[event->offset + i] += sound[i] * event->gain;
+        }
+    }
+    free(sound);
+    return track;
+}
+
+static void test_length(void) {
+    printf("\nTrack length\n");
+    
+    pfxr_timeline_event_t two[2];
+    two[0].config = pfxr_apply_template(PFXR_TEMPLATE_BLIP, 1);
+    two[0].offset = 1000;
+    two[1].config = pfxr_apply_template(PFXR_TEMPLATE_EXPLOSION, 1);
+    two[1].offset = -300;
+    int expected = 1000 + pfxr_sound_sample_count(&two[0].config);
+    int other = -300 + pfxr_sound_sample_count(&two[1].config);
+    if (other > expected) expected = other;
+    check(pfxr_timeline_length(two, 2, 0) == expected, "the latest end of any sound");
+    check(pfxr_timeline_length(two, 0, 0) == 0 && pfxr_timeline_length(NULL, 2, 0) == 0, "no events");
+    
+    two[0].offset = INT32_MAX - 10;
+    check(pfxr_timeline_length(two, 2, 0) == -1, "a track longer than an int");
+}
+
+static void test_mix(int sample_rate, int spread) {
+    char what[128];
+    make_events(spread);
+    int length = pfxr_timeline_length(events, EVENT_COUNT, sample_rate);
+    float* expected = reference_track(sample_rate, length);
+    float* track = (float*)malloc(length * sizeof(float));
+    if (!expected || !track) {
+        check(0, "allocate");
+        free(expected);
+        free(track);
+        return;
+    }
+    
+    static const int thread_counts[] = { 1, 2, 3, 8, 0 };
+    for (int t = 0; t < 5; t++) {
+        memset(track, 0xff, length * sizeof(float));
+        int rendered = pfxr_render_timeline(events, EVENT_COUNT, sample_rate, track, length, thread_counts[t]);
+        snprintf(what, sizeof(what), "%d Hz over %d samples, %d threads", sample_rate, length, thread_counts[t]);
+        check(rendered == length && memcmp(track, expected, length * sizeof(float)) == 0, what);
+    }
+    free(expected);
+    free(track);
+}
+
+static void test_output(void) {
+    printf("\nThe track is each sound scaled and placed, on any number of threads\n");
+    
+    test_mix(PFXR_SAMPLE_RATE, PFXR_SAMPLE_RATE * 3);
+    test_mix(22050, 22050 * 3);
+    test_mix(PFXR_SAMPLE_RATE, PFXR_SAMPLE_RATE * 60);
+}
+
+static void test_capacity(void) {
+    printf("\nCapacity\n");
+    
+    make_events(PFXR_SAMPLE_RATE);
+    int length = pfxr_timeline_length(events, EVENT_COUNT, 0);
+    float* track = (float*)malloc(length * sizeof(float));
+    if (!track) {
+        check(0, "allocate");
+        return;
+    }
+    track[0] = 12345.0f;
+    check(pfxr_render_timeline(events, EVENT_COUNT, 0, track, length - 1, 2) == length && track[0] == 12345.0f,
+          "a short track is left untouched and the length returned");
+    check(pfxr_render_timeline(events, EVENT_COUNT, 0, NULL, 0, 2) == length, "NULL output returns the length");
+    free(track);
+}
+
+int main(void) {
+    printf("Timeline tests\n");
+    printf("==============\n");
+    
+    test_length();
+    test_output();
+    test_capacity();
+    
+    return test_summary("timeline");
+}
@@ -0,0 +1,271 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int same_float(float a, float b) {
+    return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static void test_fields(void) {
+    printf("\nParsing fields\n");
+    
+    pfxr_sound_t defaults = pfxr_get_default_sound();
+    pfxr_sound_t config;
+    pfxr_url_error_t error = pfxr_url_parse("https://example.com/play?a=1&fx=2%2C0.5%2C%2C+0.25+%2c440#x", &config);
+    check(error == PFXR_URL_OK && config.waveForm == 2 && config.volume == 0.5f &&
+          config.attackTime == defaults.attackTime && config.sustainTime == 0.25f && config.sustainPunch == 440.0f,
+          "values, blank fields, spaces and lower-case escapes");
+    check(config.decayTime == defaults.decayTime && config.noiseAmount == defaults.noiseAmount,
+          "missing fields keep their defaults");
+    
+    error = pfxr_url_parse("?fx=1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23", &config);
+    int ok = error == PFXR_URL_OK;
+    for (int i = 0; i < PFXR_FIELD_COUNT; i++) ok = ok && get_sound_field(&config, i) == (float)(i + 1);
+    check(ok, "plain commas and every field, extra fields ignored");
+    
+    error = pfxr_url_parse("?fx=3%2C1e-3%2C-2.5E2%2C0x10%2Cinf", &config);
+    check(error == PFXR_URL_OK && config.volume == 1e-3f && config.attackTime == -250.0f &&
+          config.sustainTime == 16.0f && isinf(config.sustainPunch), "exponents, hex and inf via strtof");
+}
+
+static void test_errors(void) {
+    printf("\nErrors\n");
+    
+    pfxr_sound_t defaults = pfxr_get_default_sound();
+    pfxr_sound_t config;
+    check(pfxr_url_parse("https://example.com/", &config) == PFXR_URL_NO_FX &&
+          memcmp(&config, &defaults, sizeof(config)) == 0, "no query gives defaults");
+    check(pfxr_url_parse("?xfx=1&fxx=2#fx=3", &config) == PFXR_URL_NO_FX, "only a parameter named fx counts");
+    check(pfxr_url_parse(NULL, &config) == PFXR_URL_NO_FX, "NULL URL");
+    
+    check(pfxr_url_parse("?fx=1%2C%zz%2C0.5", &config) == PFXR_URL_BAD_ESCAPE && config.attackTime == 0.5f,
+          "a bad escape is reported and parsing continues");
+    check(pfxr_url_parse("?fx=1%2Cabc%2C0.5%2C1.5x", &config) == PFXR_URL_BAD_NUMBER &&
+          config.volume == defaults.volume && config.attackTime == 0.5f && config.sustainTime == defaults.sustainTime,
+          "bad numbers keep their defaults");
+    check(pfxr_url_parse("?fx=1e10", &config) == PFXR_URL_BAD_NUMBER && config.waveForm == defaults.waveForm,
+          "an out of range waveform is refused");
+    
+    char field[PFXR_URL_FIELD_LENGTH + 16] = "?fx=1%2C";
+    memset(field + 8, '1', PFXR_URL_FIELD_LENGTH + 1);
+    field[8 + PFXR_URL_FIELD_LENGTH + 1] = '\0';
+    check(pfxr_url_parse(field, &config) == PFXR_URL_BAD_NUMBER, "an overlong field is refused");
+    
+    char* url = (char*)malloc(PFXR_URL_MAX_LENGTH + 16);
+    if (url) {
+        memcpy(url, "?fx=", 4);
+        memset(url + 4, '0', PFXR_URL_MAX_LENGTH);
+        url[PFXR_URL_MAX_LENGTH + 4] = '\0';
+        check(pfxr_url_parse(url, &config) == PFXR_URL_TOO_LONG, "an overlong URL is refused");
+        free(url);
+    }
+}
+
+static void test_decimals(void) {
+    printf("\nDecimals parse like strtof\n");
+    
+    uint32_t seed = 2024;
+    int mismatches = 0;
+    for (int n = 0; n < 200000; n++) {
+        char number[32];
+        int length = 0;
+        seed = seed * 1664525u + 1013904223u;
+        if (seed & 1) number[length++] = '-';
+        int whole = (int)(seed >> 8) % 9;
+        int fraction = (int)(seed >> 16) % 10;
+        for (int i = 0; i < whole || (whole == 0 && fraction == 0 && i == 0); i++) {
+            seed = seed * 1664525u + 1013904223u;
+            number[length++] = (char)('0' + (seed >> 24) % 10);
+        }
+        if (fraction > 0) {
+            number[length++] = '.';
+            for (int i = 1; i < fraction || (whole == 0 && i == 1); i++) {
+                seed = seed * 1664525u + 1013904223u;
+                number[length++] = (char)('0' + (seed >> 24) % 10);
+            }
+        }
+        number[length] = '\0';
+        
+        char url[64];
+        snprintf(url, sizeof(url), "?fx=0%%2C%s", number);
+        pfxr_sound_t config;
+        if (pfxr_url_parse(url, &config) != PFXR_URL_OK || !same_float(config.volume, strtof(number, NULL))) {
+            mismatches++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "200000 decimals, %d mismatches", mismatches);
+    check(mismatches == 0, what);
+}
+
+static uint32_t next_random(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed ^ (*seed >> 15);
+}
+
+// A config with random bits in every float field, NaN aside
+static pfxr_sound_t random_config(uint32_t* seed) {
+    pfxr_sound_t config;
+    config.waveForm = (int)(next_random(seed) % 2001) - 1000;
+    for (int i = 1; i < PFXR_FIELD_COUNT; i++) {
+        float value;
+        do {
+            uint32_t bits = next_random(seed);
+            memcpy(&value, &bits, sizeof(value));
+        } while (value != value);
+        set_sound_field(&config, i, value);
+    }
+    return config;
+}
+
+static void test_round_trip(void) {
+    printf("\nWritten URLs parse back exactly\n");
+    
+    uint32_t seed = 99;
+    int mismatches = 0, longest = 0;
+    for (int n = 0; n < 20000; n++) {
+        pfxr_sound_t config = random_config(&seed);
+        if (n == 0) {
+            config.volume = -0.0f;
+            config.attackTime = INFINITY;
+            config.sustainTime = -INFINITY;
+            config.decayTime = 1e-45f;
+            config.frequency = 3.4028235e38f;
+        }
+        
+        char url[PFXR_URL_WRITE_MAX];
+        int size = pfxr_url_write(&config, url, sizeof(url));
+        if (size > longest) longest = size;
+        pfxr_sound_t parsed;
+        if (size != (int)strlen(url) + 1 || pfxr_url_parse(url, &parsed) != PFXR_URL_OK ||
+            memcmp(&parsed, &config, sizeof(config)) != 0) {
+            mismatches++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "20000 random configs, %d mismatches", mismatches);
+    check(mismatches == 0, what);
+    snprintf(what, sizeof(what), "longest URL %d bytes, within PFXR_URL_WRITE_MAX", longest);
+    check(longest <= PFXR_URL_WRITE_MAX, what);
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    char* url = pfxr_get_url_from_params(&config);
+    char written[PFXR_URL_WRITE_MAX];
+    pfxr_url_write(&config, written, sizeof(written));
+    check(url && strcmp(url, written) == 0, "pfxr_get_url_from_params writes the same");
+    free(url);
+}
+
+// Significant digits of a written number
+static int significant_digits(const char* number, int length) {
+    char digits[32];
+    int count = 0;
+    for (int i = 0; i < length && number[i] != 'e'; i++) {
+        if (number[i] >= '0' && number[i] <= '9' && count < 31) digits[count++] = number[i];
+    }
+    int first = 0;
+    while (first < count && digits[first] == '0') first++;
+    while (count > first && digits[count - 1] == '0') count--;
+    return count - first;
+}
+
+// Fewest significant digits that read back as value
+static int shortest_digits(float value) {
+    if (value == 0.0f) return 0;
+    for (int precision = 1; precision < 9; precision++) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*e", precision - 1, (double)value);
+        if (strtof(text, NULL) == value) return precision;
+    }
+    return 9;
+}
+
+static void test_shortest(void) {
+    printf("\nNumbers are written in their shortest form\n");
+    
+    uint32_t seed = 7;
+    int longer = 0, numbers = 0;
+    for (int n = 0; n < 5000; n++) {
+        pfxr_sound_t config = random_config(&seed);
+        if (n % 2) config = pfxr_apply_template(PFXR_TEMPLATE_RANDOM, n);
+        char url[PFXR_URL_WRITE_MAX];
+        pfxr_url_write(&config, url, sizeof(url));
+        
+        // Fields follow "?fx=" and each "%2C"
+        const char* field = url + 4;
+        for (int i = 0; i < PFXR_FIELD_COUNT; i++) {
+            const char* end = strstr(field, "%2C");
+            int length = end ? (int)(end - field) : (int)strlen(field);
+            float value = get_sound_field(&config, i);
+            if (!isinf(value) && significant_digits(field, length) != shortest_digits(value)) longer++;
+            numbers++;
+            field = end ? end + 3 : field + length;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%d numbers, %d not shortest", numbers, longer);
+    check(longer == 0, what);
+    
+    pfxr_sound_t config = pfxr_get_default_sound();
+    config.waveForm = 1;
+    config.volume = 0.1f;
+    config.attackTime = 1e21f;
+    config.sustainTime = 1e22f;
+    config.sustainPunch = 1e-6f;
+    config.decayTime = 1e-7f;
+    config.frequency = 440.0f;
+    char url[PFXR_URL_WRITE_MAX];
+    pfxr_url_write(&config, url, sizeof(url));
+    check(strncmp(url, "?fx=1%2C0.1%2C1e21%2C1e22%2C0.000001%2C1e-7%2C440%2C", 52) == 0,
+          "plain notation from 1e-6 up to 1e21");
+}
+
+static void test_write_batch(void) {
+    printf("\nBatches and buffer sizes\n");
+    
+    pfxr_sound_t configs[50];
+    for (int i = 0; i < 50; i++) configs[i] = pfxr_apply_template((pfxr_template_t)(i % 11), i + 1);
+    
+    int size = pfxr_url_write_batch(configs, 50, NULL, 0);
+    char* batch = (char*)malloc(size);
+    int ok = batch && pfxr_url_write_batch(configs, 50, batch, size) == size && (int)strlen(batch) + 1 == size;
+    const char* line = batch;
+    for (int i = 0; ok && i < 50; i++) {
+        char url[PFXR_URL_WRITE_MAX];
+        int length = pfxr_url_write(&configs[i], url, sizeof(url)) - 1;
+        ok = strncmp(line, url, length) == 0 && line[length] == '\n';
+        line += length + 1;
+    }
+    check(ok && *line == '\0', "each line matches pfxr_url_write");
+    
+    if (batch) {
+        memset(batch, 'x', size);
+        check(pfxr_url_write_batch(configs, 50, batch, size - 1) == size && batch[0] == 'x',
+              "a short buffer is left untouched");
+    }
+    free(batch);
+    
+    char small[16] = "untouched";
+    int needed = pfxr_url_write(&configs[0], NULL, 0);
+    check(needed > 16 && pfxr_url_write(&configs[0], small, sizeof(small)) == needed &&
+          strcmp(small, "untouched") == 0, "pfxr_url_write reports the size it needs");
+}
+
+int main(void) {
+    printf("URL tests\n");
+    printf("=========\n");
+    
+    test_fields();
+    test_errors();
+    test_decimals();
+    test_round_trip();
+    test_shortest();
+    test_write_batch();
+    
+    return test_summary("URL");
+}
@@ -0,0 +1,94 @@
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// WAV data built from the full float render, the way it was made before
+// sounds were rendered straight to 16-bit
+static char* reference_wav(const pfxr_sound_t* config, int* wav_size) {
+    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
+    if (!buffer) return NULL;
+    pfxr_generate_sound(config, buffer);
+    char* wav = pfxr_create_wav_data(buffer->samples, buffer->sample_count, wav_size);
+    pfxr_free_audio_buffer(buffer);
+    return wav;
+}
+
+static void test_direct_render(void) {
+    printf("\nDirect WAV render matches the float render\n");
+    
+    int sounds = 0, mismatches = 0;
+    for (int t = PFXR_TEMPLATE_DEFAULT; t <= PFXR_TEMPLATE_RANDOM; t++) {
+        for (int seed = 1; seed <= 10; seed++) {
+            pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)t, seed);
+            int expected_size = 0;
+            char* expected = reference_wav(&config, &expected_size);
+            char* wav = pfxr_create_sound_from_config(&config);
+            int size = wav ? (int)sizeof(pfxr_wav_header_t) + (int)((pfxr_wav_header_t*)wav)->data_size : 0;
+            if (!expected || !wav || size != expected_size || memcmp(wav, expected, size) != 0) {
+                mismatches++;
+            }
+            pfxr_free_wav_data(expected);
+            pfxr_free_wav_data(wav);
+            sounds++;
+        }
+    }
+    
+    char what[128];
+    snprintf(what, sizeof(what), "%d sounds, %d mismatches", sounds, mismatches);
+    check(mismatches == 0, what);
+}
+
+static void test_to_file(void) {
+    printf("\nFiles hold the same bytes\n");
+    
+    const char* path = "pfxr_wav_test.wav";
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_EXPLOSION, 4);
+    int expected_size = 0;
+    char* expected = reference_wav(&config, &expected_size);
+    int ok = expected && pfxr_create_sound_from_config_to_file(&config, path) == 0;
+    
+    if (ok) {
+        FILE* file = fopen(path, "rb");
+        char* data = (char*)malloc(expected_size + 1);
+        int size = file && data ? (int)fread(data, 1, expected_size + 1, file) : -1;
+        ok = size == expected_size && memcmp(data, expected, size) == 0;
+        if (file) fclose(file);
+        free(data);
+    }
+    check(ok, "EXPLOSION seed 4");
+    remove(path);
+    pfxr_free_wav_data(expected);
+}
+
+static void test_header(void) {
+    printf("\nHeader fields\n");
+    
+    pfxr_sound_t config = pfxr_apply_template(PFXR_TEMPLATE_PICKUP, 2);
+    char* wav = pfxr_create_sound_from_config(&config);
+    if (!wav) {
+        check(0, "render");
+        return;
+    }
+    const pfxr_wav_header_t* header = (const pfxr_wav_header_t*)wav;
+    pfxr_generator_t gen;
+    pfxr_generator_init(&gen, &config);
+    int count = pfxr_generator_remaining(&gen);
+    check(memcmp(header->riff, "RIFF", 4) == 0 && memcmp(header->wave, "WAVE", 4) == 0, "RIFF/WAVE tags");
+    check(header->data_size == (uint32_t)count * 2, "data size is two bytes per sample");
+    check(header->chunk_size == header->data_size + 36, "RIFF size");
+    check(header->sample_rate == PFXR_SAMPLE_RATE && header->num_channels == 1, "44.1 kHz mono");
+    pfxr_free_wav_data(wav);
+}
+
+int main(void) {
+    printf("WAV rendering tests\n");
+    printf("===================\n");
+    
+    test_direct_render();
+    test_to_file();
+    test_header();
+    
+    return test_summary("WAV");
+}
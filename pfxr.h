@@ -8,8 +8,11 @@
 extern "C" {
 #endif
 
-// Audio constants
+// Audio constants. Sounds render at PFXR_SAMPLE_RATE unless a rate is
+// given; 0 or less also means PFXR_SAMPLE_RATE, and rates above
+// PFXR_MAX_SAMPLE_RATE are clamped.
 #define PFXR_SAMPLE_RATE 44100
+#define PFXR_MAX_SAMPLE_RATE 384000
 #define PFXR_MAX_DURATION 4.0f
 #define PFXR_MAX_SAMPLES (int)(PFXR_SAMPLE_RATE * PFXR_MAX_DURATION)
 
@@ -86,7 +89,7 @@ typedef struct {
     uint32_t fmt_size;      // 16 for PCM
     uint16_t audio_format;  // 1 for PCM
     uint16_t num_channels;  // 1 for mono
-    uint32_t sample_rate;   // 44100
+    uint32_t sample_rate;   // PFXR_SAMPLE_RATE unless rendered at another rate
     uint32_t byte_rate;     // sample_rate * num_channels * bits_per_sample / 8
     uint16_t block_align;   // num_channels * bits_per_sample / 8
     uint16_t bits_per_sample; // 16
@@ -94,11 +97,49 @@ typedef struct {
     uint32_t data_size;     // Number of bytes in data
 } __attribute__((packed)) pfxr_wav_header_t;
 
+// WAV file header for float samples, which take the 18-byte format chunk
+// and a fact chunk
+typedef struct {
+    char riff[4];           // "RIFF"
+    uint32_t chunk_size;    // File size - 8
+    char wave[4];           // "WAVE"
+    char fmt[4];            // "fmt "
+    uint32_t fmt_size;      // 18
+    uint16_t audio_format;  // 3 for IEEE float
+    uint16_t num_channels;  // 1 for mono
+    uint32_t sample_rate;
+    uint32_t byte_rate;     // sample_rate * num_channels * 4
+    uint16_t block_align;   // num_channels * 4
+    uint16_t bits_per_sample; // 32
+    uint16_t extension_size;  // 0
+    char fact[4];           // "fact"
+    uint32_t fact_size;     // 4
+    uint32_t sample_length; // Samples per channel
+    char data[4];           // "data"
+    uint32_t data_size;     // Number of bytes in data
+} __attribute__((packed)) pfxr_wav_float_header_t;
+
+// Sample format of rendered output. PCM8 is unsigned with silence at 128;
+// PCM24 is packed little-endian, three bytes per sample.
+typedef enum {
+    PFXR_FORMAT_PCM16 = 0,  // int16_t samples
+    PFXR_FORMAT_FLOAT32,    // float samples
+    PFXR_FORMAT_PCM8,       // uint8_t samples
+    PFXR_FORMAT_PCM24       // 24-bit samples
+} pfxr_sample_format_t;
+
+// TPDF dither stream for PCM conversion, started by pfxr_dither_init
+typedef struct {
+    uint32_t key;           // Hash of the seed
+    uint32_t position;      // Index of the next sample
+} pfxr_dither_t;
+
 // Audio buffer structure
 typedef struct {
     float* samples;
     int sample_count;
     int capacity;
+    int sample_rate;        // Rate pfxr_generate_sound renders at, 0 for PFXR_SAMPLE_RATE
 } pfxr_audio_buffer_t;
 
 // Random number generator state
@@ -107,22 +148,351 @@ typedef struct {
     uint32_t x, y, z, w;
 } pfxr_random_t;
 
+// Allocator callbacks (user is passed back to every call)
+typedef struct {
+    void* (*alloc)(void* user, size_t size);
+    void* (*realloc)(void* user, void* ptr, size_t size);
+    void (*free)(void* user, void* ptr);
+    void* user;
+} pfxr_allocator_t;
+
+// Allocation context: an allocator plus an optional bump arena. A context
+// is not locked, so give each thread its own.
+typedef struct {
+    pfxr_allocator_t allocator;
+    char* arena;            // NULL when allocating through the allocator
+    size_t arena_size;
+    size_t arena_used;
+} pfxr_context_t;
+
+// Number of past samples a streaming generator keeps for the phaser delay
+#ifndef PFXR_PHASER_HISTORY
+#define PFXR_PHASER_HISTORY 4096
+#endif
+
+// Samples between LFO evaluations; 1 evaluates vibrato, tremolo and the
+// phaser sweep every sample, larger values interpolate linearly in between
+#ifndef PFXR_CONTROL_INTERVAL
+#define PFXR_CONTROL_INTERVAL 1
+#endif
+
+// Sine LFO state
+typedef struct {
+    uint32_t phase;         // Fraction of a cycle (of the next control point when interpolating)
+    uint32_t step;          // Phase increment per sample
+    float from;             // Values at the surrounding control points
+    float to;
+} pfxr_lfo_t;
+
+// Biquad filter state
+typedef struct {
+    float a0, a1, a2, b1, b2;
+    float x1, x2, y1, y2;
+} pfxr_biquad_t;
+
+// Kinds of envelope and pitch segments, in the order they occur
+typedef enum {
+    PFXR_SEGMENT_ATTACK = 0,
+    PFXR_SEGMENT_SUSTAIN,
+    PFXR_SEGMENT_DECAY,
+    PFXR_SEGMENT_PITCH_DELAY,
+    PFXR_SEGMENT_SWEEP,
+    PFXR_SEGMENT_HOLD
+} pfxr_segment_kind_t;
+
+// Linear piece of a sound's envelope or pitch curve
+typedef struct {
+    pfxr_segment_kind_t kind;
+    int start;              // First sample of the segment
+    int length;             // Number of samples
+    float value;            // Envelope gain or frequency (Hz) at the first sample
+    float step;             // Change per sample
+} pfxr_segment_t;
+
+// At most three envelope and three pitch segments
+#define PFXR_MAX_SEGMENTS 6
+
+// Render stages a generator runs only when their effect is active
+#define PFXR_STAGE_PITCH_SWEEP  0x01
+#define PFXR_STAGE_VIBRATO      0x02
+#define PFXR_STAGE_NOISE        0x04
+#define PFXR_STAGE_PHASER       0x08
+#define PFXR_STAGE_LOWPASS      0x10
+#define PFXR_STAGE_HIGHPASS     0x20
+#define PFXR_STAGE_TREMOLO      0x40
+
+// Streaming generator state (one voice, rendered block by block)
+typedef struct {
+    pfxr_sound_t config;
+    float sample_rate;
+    float duration;
+    int total_samples;
+    int position;           // Index of the next sample to render
+
+    // Render plan, worked out once from the configuration
+    unsigned int stages;    // PFXR_STAGE_* bits of the active effects
+    float phase_scale;      // Oscillator phase increment per Hz
+    float noise_amount;
+    int control_interval;   // Samples between LFO evaluations
+    pfxr_segment_t envelope[3];
+    int envelope_count;
+    pfxr_segment_t pitch[3];
+    int pitch_count;
+
+    // Oscillator phase and modulators
+    uint32_t phase;
+    pfxr_lfo_t vibrato;
+    pfxr_lfo_t tremolo;
+    pfxr_lfo_t phaser;
+    int control_offset;     // Samples since the last LFO control point
+
+    // Effect state
+    uint32_t noise_seed;
+    pfxr_biquad_t lowpass;
+    pfxr_biquad_t highpass;
+
+    // Phaser delay line (NULL uses history_storage)
+    float* history;
+    int history_size;
+    int history_pos;
+    float history_storage[PFXR_PHASER_HISTORY];
+} pfxr_generator_t;
+
+// Sounds per pfxr_sound_soa_t; pfxr_render_soa runs them in lockstep, as
+// many per vector as the target has float lanes
+#ifndef PFXR_LANES
+#define PFXR_LANES 8
+#endif
+
+// Structure-of-arrays layout for up to PFXR_LANES sounds, one field array
+// per pfxr_sound_t field
+typedef struct {
+    int count;              // Lanes in use
+    int sample_rate;        // Rate every lane renders at, 0 for PFXR_SAMPLE_RATE
+    int control_interval;   // Samples between LFO evaluations, 0 for PFXR_CONTROL_INTERVAL
+    int waveForm[PFXR_LANES];
+    float volume[PFXR_LANES];
+    float attackTime[PFXR_LANES];
+    float sustainTime[PFXR_LANES];
+    float sustainPunch[PFXR_LANES];
+    float decayTime[PFXR_LANES];
+    float frequency[PFXR_LANES];
+    float pitchDelta[PFXR_LANES];
+    float pitchDuration[PFXR_LANES];
+    float pitchDelay[PFXR_LANES];
+    float vibratoRate[PFXR_LANES];
+    float vibratoDepth[PFXR_LANES];
+    float tremoloRate[PFXR_LANES];
+    float tremoloDepth[PFXR_LANES];
+    float highPassCutoff[PFXR_LANES];
+    float highPassResonance[PFXR_LANES];
+    float lowPassCutoff[PFXR_LANES];
+    float lowPassResonance[PFXR_LANES];
+    float phaserBaseFrequency[PFXR_LANES];
+    float phaserLfoFrequency[PFXR_LANES];
+    float phaserDepth[PFXR_LANES];
+    float noiseAmount[PFXR_LANES];
+} pfxr_sound_soa_t;
+
+// Output of a batch render
+typedef enum {
+    PFXR_BATCH_WAV = 0,     // WAV file data, 16-bit unless sample_format says otherwise
+    PFXR_BATCH_FLOAT        // Float samples
+} pfxr_batch_format_t;
+
+// Batch render options (NULL for the defaults)
+typedef struct {
+    int threads;            // Worker threads including the caller, 0 for one per CPU
+    pfxr_batch_format_t format;
+    int sample_rate;        // 0 for PFXR_SAMPLE_RATE
+    pfxr_sample_format_t sample_format; // Samples of PFXR_BATCH_WAV data
+    uint32_t dither_seed;   // Nonzero dithers PCM data, sound i with dither_seed + i
+    int control_interval;   // Samples between LFO evaluations, 0 for PFXR_CONTROL_INTERVAL
+} pfxr_batch_opts_t;
+
+// One sound rendered by a batch
+typedef struct {
+    void* data;             // WAV data or samples, NULL if the sound is empty
+    int size;               // Size in bytes (WAV) or samples (float)
+    int sample_count;       // Samples in the sound
+} pfxr_batch_result_t;
+
+// Longest URL pfxr_url_parse reads, and longest field it accepts
+#ifndef PFXR_URL_MAX_LENGTH
+#define PFXR_URL_MAX_LENGTH 4096
+#endif
+#define PFXR_URL_FIELD_LENGTH 63
+
+// Most bytes pfxr_url_write needs for one config, terminator included;
+// also bounds each line of pfxr_url_write_batch
+#define PFXR_URL_WRITE_MAX 576
+
+// Result of pfxr_url_parse
+typedef enum {
+    PFXR_URL_OK = 0,
+    PFXR_URL_NO_FX,         // No fx= parameter
+    PFXR_URL_TOO_LONG,      // Longer than PFXR_URL_MAX_LENGTH
+    PFXR_URL_BAD_ESCAPE,    // A % not followed by two hex digits
+    PFXR_URL_BAD_NUMBER     // A field that is not a number
+} pfxr_url_error_t;
+
+// Binary encodings of a config, each starting with a byte holding
+// PFXR_CODEC_VERSION and the mode. Lossless keeps every bit; quantized
+// packs each field into 10 or 12 bits over the PFXR_TEMPLATE_RANDOM range.
+#define PFXR_CODEC_VERSION 1
+#define PFXR_CODEC_LOSSLESS_SIZE 88
+#define PFXR_CODEC_QUANTIZED_SIZE 29
+
+typedef enum {
+    PFXR_CODEC_LOSSLESS = 0,
+    PFXR_CODEC_QUANTIZED
+} pfxr_codec_mode_t;
+
+// One sound placed on a timeline
+typedef struct {
+    int offset;             // Track sample the sound starts at (may be negative)
+    float gain;
+    pfxr_sound_t config;
+} pfxr_timeline_event_t;
+
+// Cache of rendered sounds keyed by pfxr_sound_hash, evicting the least
+// recently used sounds to stay within a byte budget. Safe to share between
+// threads.
+typedef struct pfxr_cache pfxr_cache_t;
+
+// A cached sound, shared read-only by every holder until released
+typedef struct {
+    uint64_t key;           // pfxr_sound_hash of the config
+    const char* wav_data;   // 16-bit WAV file data at PFXR_SAMPLE_RATE
+    int wav_size;           // Size in bytes
+    const int16_t* samples; // PCM samples inside wav_data
+    int sample_count;
+} pfxr_cached_sound_t;
+
+// Cache counters
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t disk_hits;     // Misses served from the cache directory
+    uint64_t disk_writes;   // Sounds stored to the cache directory
+    size_t bytes;           // Bytes held by cached sounds
+    size_t budget;
+    int entries;
+} pfxr_cache_stats_t;
+
+// Sound bank: many rendered sounds packed into one file with a sorted
+// index, opened with a single mmap
+typedef struct pfxr_bank pfxr_bank_t;
+typedef struct pfxr_bank_builder pfxr_bank_builder_t;
+
+// Sample format of a bank payload, numbered like pfxr_sample_format_t
+typedef enum {
+    PFXR_BANK_PCM16 = 0,    // int16_t samples
+    PFXR_BANK_FLOAT32,      // float samples
+    PFXR_BANK_PCM8,         // uint8_t samples, silence at 128
+    PFXR_BANK_PCM24         // Packed little-endian 24-bit samples
+} pfxr_bank_format_t;
+
+// One sound of an open bank (pointers stay valid until the bank is closed)
+typedef struct {
+    const char* name;
+    const void* data;       // Samples, 16-byte aligned
+    int size;               // Size in bytes
+    int sample_count;
+    int sample_rate;
+    pfxr_bank_format_t format;
+    pfxr_sound_t config;    // Source config, for re-rendering
+} pfxr_bank_sound_t;
+
+// Voice mixer: a fixed pool of streaming voices mixed into interleaved
+// stereo. Triggers may come from any thread; one audio thread renders.
+typedef struct pfxr_mixer pfxr_mixer_t;
+
+// Triggers a mixer can hold between renders (a power of two)
+#ifndef PFXR_MIXER_QUEUE
+#define PFXR_MIXER_QUEUE 256
+#endif
+
+// Mixer counters
+typedef struct {
+    uint64_t triggered;     // Triggers that started a voice
+    uint64_t stolen;        // Voices cut off to start a trigger
+    uint64_t dropped;       // Triggers lost to a full queue or outranked by every voice
+    int active;             // Voices playing after the last render
+    int voices;
+} pfxr_mixer_stats_t;
+
 // Main API functions
 char* pfxr_create_sound_from_template(pfxr_template_t template, int seed);
 int pfxr_create_sound_from_template_to_file(pfxr_template_t template, int seed, const char* filename);
 char* pfxr_create_sound_from_config(const pfxr_sound_t* config);
 int pfxr_create_sound_from_config_to_file(const pfxr_sound_t* config, const char* filename);
 
+// Caller-owned buffer functions (no allocation). Each returns the size of
+// its output, or writes nothing and returns the capacity it needs when out
+// is NULL or too small. For WAV and sample output that capacity includes
+// pfxr_render_scratch_size bytes of scratch after the output.
+int pfxr_sound_sample_count(const pfxr_sound_t* config);
+int pfxr_render_scratch_size(const pfxr_sound_t* config, int sample_rate);
+int pfxr_render_into(const pfxr_sound_t* config, float* out, int capacity);
+int pfxr_render_wav_into(const pfxr_sound_t* config, void* out, int capacity);
+int pfxr_url_write(const pfxr_sound_t* config, char* out, int capacity);
+int pfxr_url_write_batch(const pfxr_sound_t* configs, int count, char* out, int capacity);
+
+// The same at a given sample rate
+int pfxr_sound_sample_count_rate(const pfxr_sound_t* config, int sample_rate);
+int pfxr_render_into_rate(const pfxr_sound_t* config, int sample_rate, float* out, int capacity);
+int pfxr_render_wav_into_rate(const pfxr_sound_t* config, int sample_rate, void* out, int capacity);
+
+// The same in a given sample format, sizes in bytes
+int pfxr_render_samples_into(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                             void* out, int capacity);
+int pfxr_render_wav_into_format(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                void* out, int capacity);
+
+// The same with the LFOs evaluated every control_interval samples, 0 for
+// PFXR_CONTROL_INTERVAL (see pfxr_generator_set_control_interval)
+int pfxr_render_into_interval(const pfxr_sound_t* config, int sample_rate, int control_interval,
+                              float* out, int capacity);
+int pfxr_render_samples_into_interval(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                      int control_interval, void* out, int capacity);
+int pfxr_render_wav_into_interval(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                  int control_interval, void* out, int capacity);
+
 // Utility functions
 pfxr_sound_t pfxr_get_default_sound(void);
 pfxr_sound_t pfxr_apply_template(pfxr_template_t template, int seed);
 void pfxr_free_wav_data(char* wav_data);
 
 // URL functions
+pfxr_url_error_t pfxr_url_parse(const char* url, pfxr_sound_t* config);
 pfxr_sound_t* pfxr_create_params_from_url(const char* url);
 char* pfxr_get_url_from_params(const pfxr_sound_t* config);
 void pfxr_free_sound_config(pfxr_sound_t* config);
 
+// Binary encoding functions
+int pfxr_sound_encode(const pfxr_sound_t* config, pfxr_codec_mode_t mode, void* out, int capacity);
+int pfxr_sound_decode(const void* data, int size, pfxr_sound_t* config);
+int pfxr_sound_encode_batch(const pfxr_sound_t* configs, int count, pfxr_codec_mode_t mode,
+                            void* out, int capacity);
+int pfxr_sound_decode_batch(const void* data, int size, pfxr_sound_t* configs, int count);
+
+// Allocation context functions
+void pfxr_context_init(pfxr_context_t* ctx, const pfxr_allocator_t* allocator);
+void pfxr_context_init_arena(pfxr_context_t* ctx, void* memory, size_t size);
+void pfxr_context_reset(pfxr_context_t* ctx);
+void* pfxr_context_alloc(pfxr_context_t* ctx, size_t size);
+void* pfxr_context_realloc(pfxr_context_t* ctx, void* ptr, size_t size);
+void pfxr_context_free(pfxr_context_t* ctx, void* ptr);
+
+// Context variants of the allocating functions (free results with pfxr_context_free)
+char* pfxr_create_sound_from_template_ctx(pfxr_context_t* ctx, pfxr_template_t template, int seed, int* wav_size);
+char* pfxr_create_sound_from_config_ctx(pfxr_context_t* ctx, const pfxr_sound_t* config, int* wav_size);
+char* pfxr_create_wav_data_ctx(pfxr_context_t* ctx, const float* samples, int sample_count, int* wav_size);
+pfxr_sound_t* pfxr_create_params_from_url_ctx(pfxr_context_t* ctx, const char* url);
+char* pfxr_get_url_from_params_ctx(pfxr_context_t* ctx, const pfxr_sound_t* config);
+
 // Random number generator functions
 void pfxr_random_init(pfxr_random_t* rng, uint32_t seed);
 float pfxr_random_float(pfxr_random_t* rng, float min, float max);
@@ -134,8 +504,78 @@ pfxr_audio_buffer_t* pfxr_create_audio_buffer(int capacity);
 void pfxr_free_audio_buffer(pfxr_audio_buffer_t* buffer);
 void pfxr_generate_sound(const pfxr_sound_t* config, pfxr_audio_buffer_t* buffer);
 
+// Streaming generator functions
+void pfxr_generator_init(pfxr_generator_t* gen, const pfxr_sound_t* config);
+void pfxr_generator_init_rate(pfxr_generator_t* gen, const pfxr_sound_t* config, int sample_rate);
+void pfxr_generator_set_history(pfxr_generator_t* gen, float* history, int size);
+int pfxr_generator_render(pfxr_generator_t* gen, float* out, int n);
+int pfxr_generator_remaining(const pfxr_generator_t* gen);
+int pfxr_generator_set_control_interval(pfxr_generator_t* gen, int interval);
+int pfxr_sound_segments(const pfxr_sound_t* config, pfxr_segment_t* out, int max);
+
+// Lane-parallel functions: render up to PFXR_LANES sounds at once
+void pfxr_sound_soa_load(pfxr_sound_soa_t* soa, const pfxr_sound_t* configs, int count);
+void pfxr_sound_soa_get(const pfxr_sound_soa_t* soa, int lane, pfxr_sound_t* config);
+int pfxr_render_soa(const pfxr_sound_soa_t* soa, float* const* out, int capacity, int* sample_counts);
+
+// Batch functions: render n sounds on a thread pool, results in input order
+pfxr_batch_result_t* pfxr_render_batch(const pfxr_sound_t* configs, int n, const pfxr_batch_opts_t* opts);
+void pfxr_free_batch(pfxr_batch_result_t* results, int n);
+
+// Timeline functions: mix sounds at sample offsets into one track
+int pfxr_timeline_length(const pfxr_timeline_event_t* events, int n, int sample_rate);
+int pfxr_render_timeline(const pfxr_timeline_event_t* events, int n, int sample_rate,
+                         float* out, int capacity, int threads);
+
+// Cache functions: handles from pfxr_cache_get* must be released
+uint64_t pfxr_sound_hash(const pfxr_sound_t* config);
+pfxr_cache_t* pfxr_cache_create(size_t budget);
+void pfxr_cache_destroy(pfxr_cache_t* cache);
+const pfxr_cached_sound_t* pfxr_cache_get(pfxr_cache_t* cache, const pfxr_sound_t* config);
+const pfxr_cached_sound_t* pfxr_cache_get_template(pfxr_cache_t* cache, pfxr_template_t template, int seed);
+void pfxr_cache_release(pfxr_cache_t* cache, const pfxr_cached_sound_t* sound);
+int pfxr_cache_set_directory(pfxr_cache_t* cache, const char* path);
+void pfxr_cache_clear(pfxr_cache_t* cache);
+void pfxr_cache_stats(pfxr_cache_t* cache, pfxr_cache_stats_t* stats);
+
+// Bank functions: open a bank file (or a caller-owned image) and look
+// sounds up by name
+pfxr_bank_t* pfxr_bank_open(const char* path);
+pfxr_bank_t* pfxr_bank_open_memory(const void* data, size_t size);
+void pfxr_bank_close(pfxr_bank_t* bank);
+int pfxr_bank_count(const pfxr_bank_t* bank);
+int pfxr_bank_find(const pfxr_bank_t* bank, const char* name);
+int pfxr_bank_get(const pfxr_bank_t* bank, int index, pfxr_bank_sound_t* sound);
+int pfxr_bank_verify(const pfxr_bank_t* bank, int index);
+
+// Bank builder functions: sounds stream to path, the index is written by finish
+pfxr_bank_builder_t* pfxr_bank_builder_create(const char* path);
+int pfxr_bank_builder_add(pfxr_bank_builder_t* builder, const char* name, const pfxr_sound_t* config);
+int pfxr_bank_builder_add_data(pfxr_bank_builder_t* builder, const char* name, const pfxr_sound_t* config,
+                               pfxr_bank_format_t format, int sample_rate, const void* data, int sample_count);
+int pfxr_bank_builder_finish(pfxr_bank_builder_t* builder);
+void pfxr_bank_builder_discard(pfxr_bank_builder_t* builder);
+
+// Mixer functions: trigger and stop from any thread, render from one
+pfxr_mixer_t* pfxr_mixer_create(int voices, int sample_rate);
+void pfxr_mixer_destroy(pfxr_mixer_t* mixer);
+int pfxr_mixer_trigger(pfxr_mixer_t* mixer, const pfxr_sound_t* config, float gain, float pan, int priority);
+int pfxr_mixer_stop_all(pfxr_mixer_t* mixer);
+int pfxr_mixer_render(pfxr_mixer_t* mixer, float* out, int frames);
+void pfxr_mixer_stats(pfxr_mixer_t* mixer, pfxr_mixer_stats_t* stats);
+
 // WAV file functions
 char* pfxr_create_wav_data(const float* samples, int sample_count, int* wav_size);
+char* pfxr_create_wav_data_rate(const float* samples, int sample_count, int sample_rate, int* wav_size);
+char* pfxr_create_wav_data_format(const float* samples, int sample_count, int sample_rate,
+                                  pfxr_sample_format_t format, int* wav_size);
+int pfxr_sample_size(pfxr_sample_format_t format);
+int pfxr_wav_header_size(pfxr_sample_format_t format);
+int pfxr_write_wav_header(void* out, int sample_count, int sample_rate, pfxr_sample_format_t format);
+void pfxr_convert_samples(const float* samples, void* out, int count, pfxr_sample_format_t format);
+void pfxr_dither_init(pfxr_dither_t* dither, uint32_t seed);
+void pfxr_convert_samples_dither(const float* samples, void* out, int count, pfxr_sample_format_t format,
+                                 pfxr_dither_t* dither);
 int pfxr_write_wav_file(const char* filename, const float* samples, int sample_count);
 
 #ifdef __cplusplus
@@ -153,11 +593,72 @@ int pfxr_write_wav_file(const char* filename, const float* samples, int sample_c
 #include <math.h>
 #include <time.h>
 #include <ctype.h>
+#include <stddef.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// SIMD oscillator kernels (define PFXR_NO_SIMD to use the scalar code only)
+#ifndef PFXR_NO_SIMD
+#if defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PFXR_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PFXR_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PFXR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+// Batch rendering threads (define PFXR_NO_THREADS to render batches serially)
+#if !defined(PFXR_NO_THREADS) && (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define PFXR_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Atomics for the mixer's trigger queue and timeline workers. Compilers
+// without GCC-style builtins get plain accesses: mixer triggers must then
+// come from the audio thread, and timelines render on one thread.
+#if defined(__GNUC__) || defined(__clang__)
+#define PFXR_ATOMICS 1
+#define PFXR_ATOMIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define PFXR_ATOMIC_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#define PFXR_ATOMIC_CAS(ptr, expected, value) \
+    __atomic_compare_exchange_n(ptr, expected, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define PFXR_ATOMIC_ADD(ptr, value) __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED)
+#else
+#define PFXR_ATOMIC_LOAD(ptr) (*(ptr))
+#define PFXR_ATOMIC_STORE(ptr, value) (*(ptr) = (value))
+#define PFXR_ATOMIC_CAS(ptr, expected, value) (*(ptr) == *(expected) ? (*(ptr) = (value), 1) : (*(expected) = *(ptr), 0))
+#define PFXR_ATOMIC_ADD(ptr, value) ((*(ptr) += (value)) - (value))
+#endif
+
+// Memory-mapped cache directory (define PFXR_NO_MMAP to leave it out)
+#if !defined(PFXR_NO_MMAP) && (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define PFXR_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Sine precision: PFXR_SINE_EXACT (the default) or PFXR_SINE_FAST
+#if defined(PFXR_SINE_FAST) && defined(PFXR_SINE_EXACT)
+#error "define at most one of PFXR_SINE_FAST and PFXR_SINE_EXACT"
+#endif
+
+// Override all three to route the library's heap use elsewhere
+#ifndef PFXR_MALLOC
+#define PFXR_MALLOC(size) malloc(size)
+#define PFXR_REALLOC(ptr, size) realloc(ptr, size)
+#define PFXR_FREE(ptr) free(ptr)
+#endif
+
 // ============================================================================
 // TEMPLATES IMPLEMENTATION
 // ============================================================================
@@ -446,23 +947,138 @@ int pfxr_random_choice(pfxr_random_t* rng, const int* choices, int count) {
     return choices[index];
 }
 
+// ============================================================================
+// ALLOCATION IMPLEMENTATION
+// ============================================================================
+
+// Arena blocks start on this boundary and carry their size just before it
+#define PFXR_ARENA_ALIGN 16
+
+static void* default_alloc(void* user, size_t size) {
+    (void)user;
+    return PFXR_MALLOC(size);
+}
+
+static void* default_realloc(void* user, void* ptr, size_t size) {
+    (void)user;
+    return PFXR_REALLOC(ptr, size);
+}
+
+static void default_free(void* user, void* ptr) {
+    (void)user;
+    PFXR_FREE(ptr);
+}
+
+// Initialize a context that allocates through the given callbacks (NULL uses PFXR_MALLOC)
+void pfxr_context_init(pfxr_context_t* ctx, const pfxr_allocator_t* allocator) {
+    if (!ctx) return;
+    memset(ctx, 0, sizeof(*ctx));
+    
+    if (allocator) {
+        ctx->allocator = *allocator;
+    } else {
+        ctx->allocator.alloc = default_alloc;
+        ctx->allocator.realloc = default_realloc;
+        ctx->allocator.free = default_free;
+    }
+}
+
+// Initialize a context that bump-allocates from caller memory. Allocations
+// fail once the arena is full; pfxr_context_reset releases everything.
+void pfxr_context_init_arena(pfxr_context_t* ctx, void* memory, size_t size) {
+    pfxr_context_init(ctx, NULL);
+    if (!ctx || !memory) return;
+    
+    // Align the arena start so every block is aligned
+    size_t skew = (size_t)((uintptr_t)memory % PFXR_ARENA_ALIGN);
+    size_t pad = skew ? PFXR_ARENA_ALIGN - skew : 0;
+    if (size <= pad) return;
+    
+    ctx->arena = (char*)memory + pad;
+    ctx->arena_size = size - pad;
+}
+
+// Release every arena allocation at once
+void pfxr_context_reset(pfxr_context_t* ctx) {
+    if (ctx) {
+        ctx->arena_used = 0;
+    }
+}
+
+// Carve a block from the arena, storing its size in the header slot
+static void* arena_alloc(pfxr_context_t* ctx, size_t size) {
+    size_t block = (size + PFXR_ARENA_ALIGN - 1) & ~(size_t)(PFXR_ARENA_ALIGN - 1);
+    if (block < size || ctx->arena_size - ctx->arena_used < block + PFXR_ARENA_ALIGN) {
+        return NULL;
+    }
+    
+    char* ptr = ctx->arena + ctx->arena_used + PFXR_ARENA_ALIGN;
+    *(size_t*)(ptr - sizeof(size_t)) = size;
+    ctx->arena_used += block + PFXR_ARENA_ALIGN;
+    return ptr;
+}
+
+void* pfxr_context_alloc(pfxr_context_t* ctx, size_t size) {
+    if (!ctx) return PFXR_MALLOC(size);
+    if (ctx->arena) return arena_alloc(ctx, size);
+    return ctx->allocator.alloc(ctx->allocator.user, size);
+}
+
+void* pfxr_context_realloc(pfxr_context_t* ctx, void* ptr, size_t size) {
+    if (!ctx) return PFXR_REALLOC(ptr, size);
+    if (!ctx->arena) return ctx->allocator.realloc(ctx->allocator.user, ptr, size);
+    if (!ptr) return arena_alloc(ctx, size);
+    
+    size_t old_size = *(size_t*)((char*)ptr - sizeof(size_t));
+    char* end = (char*)ptr + ((old_size + PFXR_ARENA_ALIGN - 1) & ~(size_t)(PFXR_ARENA_ALIGN - 1));
+    
+    // Grow the most recent block in place
+    if (end == ctx->arena + ctx->arena_used) {
+        size_t start = (size_t)((char*)ptr - ctx->arena);
+        size_t block = (size + PFXR_ARENA_ALIGN - 1) & ~(size_t)(PFXR_ARENA_ALIGN - 1);
+        if (block >= size && ctx->arena_size - start >= block) {
+            *(size_t*)((char*)ptr - sizeof(size_t)) = size;
+            ctx->arena_used = start + block;
+            return ptr;
+        }
+        return NULL;
+    }
+    
+    void* moved = arena_alloc(ctx, size);
+    if (moved) {
+        memcpy(moved, ptr, old_size < size ? old_size : size);
+    }
+    return moved;
+}
+
+// Free a block (a no-op for arena blocks, which go on reset)
+void pfxr_context_free(pfxr_context_t* ctx, void* ptr) {
+    if (!ptr) return;
+    if (!ctx) {
+        PFXR_FREE(ptr);
+    } else if (!ctx->arena) {
+        ctx->allocator.free(ctx->allocator.user, ptr);
+    }
+}
+
 // ============================================================================
 // AUDIO BUFFER IMPLEMENTATION
 // ============================================================================
 
 // Create audio buffer with specified capacity
 pfxr_audio_buffer_t* pfxr_create_audio_buffer(int capacity) {
-    pfxr_audio_buffer_t* buffer = malloc(sizeof(pfxr_audio_buffer_t));
+    pfxr_audio_buffer_t* buffer = PFXR_MALLOC(sizeof(pfxr_audio_buffer_t));
     if (!buffer) return NULL;
     
-    buffer->samples = malloc(capacity * sizeof(float));
+    buffer->samples = PFXR_MALLOC(capacity * sizeof(float));
     if (!buffer->samples) {
-        free(buffer);
+        PFXR_FREE(buffer);
         return NULL;
     }
     
     buffer->capacity = capacity;
     buffer->sample_count = 0;
+    buffer->sample_rate = 0;
     memset(buffer->samples, 0, capacity * sizeof(float));
     
     return buffer;
@@ -472,9 +1088,9 @@ pfxr_audio_buffer_t* pfxr_create_audio_buffer(int capacity) {
 void pfxr_free_audio_buffer(pfxr_audio_buffer_t* buffer) {
     if (buffer) {
         if (buffer->samples) {
-            free(buffer->samples);
+            PFXR_FREE(buffer->samples);
         }
-        free(buffer);
+        PFXR_FREE(buffer);
     }
 }
 
@@ -489,29 +1105,104 @@ static float clamp(float value, float min, float max) {
     return value;
 }
 
-// Generate sine wave
-static float generate_sine(float phase) {
-    return sinf(phase * 2.0f * M_PI);
+// Oscillator phases are 32-bit fractions of a cycle: they wrap for free and
+// keep the same precision however long a sound runs
+#define PFXR_PHASE_SCALE 4294967296.0f
+#define PFXR_PHASE_TO_RADIANS 1.46291808e-9f    // 2*pi / 2^32
+#define PFXR_PHASE_TO_CYCLES 2.32830644e-10f    // 1 / 2^32
+#define PFXR_PHASE_TO_QUARTERS 9.31322575e-10f  // 1 / 2^30
+#define PFXR_SAW_SCALE 4.65661287e-10f          // 1 / 2^31
+#define PFXR_TRIANGLE_SCALE 9.31322575e-10f     // 1 / 2^30
+
+// Phase increment per sample for a frequency in Hz
+static uint32_t phase_step(double freq, double sample_rate) {
+    double cycles = freq / sample_rate;
+    if (!isfinite(cycles)) return 0;
+    cycles -= floor(cycles);
+    return (uint32_t)(uint64_t)(cycles * 4294967296.0 + 0.5);
+}
+
+#ifdef PFXR_SINE_FAST
+// Sine polynomial for PFXR_SINE_FAST: least-squares fit of sin(2*pi*x) on
+// [-0.25, 0.25] (within 4e-9 before float rounding), after folding the
+// phase into that range
+#define PFXR_SIN_C1 6.28318516f
+#define PFXR_SIN_C3 -41.3416549f
+#define PFXR_SIN_C5 81.6009981f
+#define PFXR_SIN_C7 -76.5496558f
+#define PFXR_SIN_C9 39.5358068f
+
+// Generate sine wave (polynomial, within 2.2e-7 of sin)
+static float generate_sine(uint32_t phase) {
+    float x = (float)(int32_t)phase * PFXR_PHASE_TO_CYCLES;
+    float ax = fabsf(x);
+    if (ax > 0.25f) ax = 0.5f - ax;
+    x = x < 0.0f ? -ax : ax;
+    
+    float x2 = x * x;
+    float p = PFXR_SIN_C7 + x2 * PFXR_SIN_C9;
+    p = PFXR_SIN_C5 + x2 * p;
+    p = PFXR_SIN_C3 + x2 * p;
+    p = PFXR_SIN_C1 + x2 * p;
+    return x * p;
+}
+#else
+// Sine polynomials for PFXR_SINE_EXACT: minimax fits on the first eighth
+// of a cycle (within 2e-9 before float rounding) of sin in radians, and of
+// cos in quarter cycles for the eighth before the peak
+#define PFXR_SIN_S3 -1.666665067e-01f
+#define PFXR_SIN_S5 8.331978663e-03f
+#define PFXR_SIN_S7 -1.949563625e-04f
+#define PFXR_SIN_K2 -1.233700543e+00f
+#define PFXR_SIN_K4 2.536692441e-01f
+#define PFXR_SIN_K6 -2.086028923e-02f
+#define PFXR_SIN_K8 9.040231021e-04f
+
+// Generate sine wave (polynomial, within 9.7e-8 of sin)
+static float generate_sine(uint32_t phase) {
+    // Fold onto a quarter cycle while the phase is still exact
+    int32_t x = (int32_t)phase;
+    uint32_t ax = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+    if (ax > 0x40000000u) ax = 0x80000000u - ax;
+    
+    float s;
+    if (ax > 0x20000000u) {
+        float t = (float)(int32_t)(0x40000000u - ax) * PFXR_PHASE_TO_QUARTERS;
+        float t2 = t * t;
+        float p = PFXR_SIN_K6 + t2 * PFXR_SIN_K8;
+        p = PFXR_SIN_K4 + t2 * p;
+        p = PFXR_SIN_K2 + t2 * p;
+        s = 1.0f + t2 * p;
+    } else {
+        float r = (float)(int32_t)ax * PFXR_PHASE_TO_RADIANS;
+        float r2 = r * r;
+        float p = PFXR_SIN_S5 + r2 * PFXR_SIN_S7;
+        p = PFXR_SIN_S3 + r2 * p;
+        s = r + (r * r2) * p;
+    }
+    return x < 0 ? -s : s;
 }
+#endif
 
 // Generate sawtooth wave
-static float generate_sawtooth(float phase) {
-    return 2.0f * (phase - floorf(phase + 0.5f));
+static float generate_sawtooth(uint32_t phase) {
+    return (float)(int32_t)phase * PFXR_SAW_SCALE;
 }
 
 // Generate square wave
-static float generate_square(float phase) {
-    return (phase - floorf(phase)) < 0.5f ? -1.0f : 1.0f;
+static float generate_square(uint32_t phase) {
+    return (int32_t)phase < 0 ? 1.0f : -1.0f;
 }
 
 // Generate triangle wave
-static float generate_triangle(float phase) {
-    float t = phase - floorf(phase);
-    return t < 0.5f ? (4.0f * t - 1.0f) : (3.0f - 4.0f * t);
+static float generate_triangle(uint32_t phase) {
+    // Mirror the second half of the cycle onto the first
+    uint32_t folded = (phase & 0x80000000u) ? ~phase : phase;
+    return (float)(int32_t)folded * PFXR_TRIANGLE_SCALE - 1.0f;
 }
 
 // Generate waveform sample based on type
-static float generate_waveform(pfxr_wave_type_t wave_type, float phase) {
+static float generate_waveform(pfxr_wave_type_t wave_type, uint32_t phase) {
     switch (wave_type) {
         case PFXR_WAVE_SINE:
             return generate_sine(phase);
@@ -526,620 +1217,4428 @@ static float generate_waveform(pfxr_wave_type_t wave_type, float phase) {
     }
 }
 
-// Simple biquad filter implementation
-typedef struct {
-    float a0, a1, a2, b1, b2;
-    float x1, x2, y1, y2;
-} biquad_filter_t;
+// ============================================================================
+// OSCILLATOR KERNELS
+// ============================================================================
 
-static void biquad_lowpass_coeffs(biquad_filter_t* filter, float freq, float q, float sample_rate) {
-    float w = 2.0f * M_PI * freq / sample_rate;
-    float cos_w = cosf(w);
-    float sin_w = sinf(w);
-    float alpha = sin_w / (2.0f * q);
-    
-    float b0 = (1.0f - cos_w) / 2.0f;
-    float b1 = 1.0f - cos_w;
-    float b2 = (1.0f - cos_w) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_w;
-    float a2 = 1.0f - alpha;
-    
-    filter->a0 = b0 / a0;
-    filter->a1 = b1 / a0;
-    filter->a2 = b2 / a0;
-    filter->b1 = a1 / a0;
-    filter->b2 = a2 / a0;
-}
+// Samples per oscillator block in the generator
+#define PFXR_OSC_BLOCK 64
 
-static void biquad_highpass_coeffs(biquad_filter_t* filter, float freq, float q, float sample_rate) {
-    float w = 2.0f * M_PI * freq / sample_rate;
-    float cos_w = cosf(w);
-    float sin_w = sinf(w);
-    float alpha = sin_w / (2.0f * q);
-    
-    float b0 = (1.0f + cos_w) / 2.0f;
-    float b1 = -(1.0f + cos_w);
-    float b2 = (1.0f + cos_w) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_w;
-    float a2 = 1.0f - alpha;
-    
-    filter->a0 = b0 / a0;
-    filter->a1 = b1 / a0;
-    filter->a2 = b2 / a0;
-    filter->b1 = a1 / a0;
-    filter->b2 = a2 / a0;
+// Reference kernel: evaluate the waveform for each phase
+static void osc_block_scalar(pfxr_wave_type_t wave_type, const uint32_t* phases, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = generate_waveform(wave_type, phases[i]);
+    }
 }
 
-static float biquad_process(biquad_filter_t* filter, float input) {
-    float output = filter->a0 * input + filter->a1 * filter->x1 + filter->a2 * filter->x2
-                  - filter->b1 * filter->y1 - filter->b2 * filter->y2;
-    
-    filter->x2 = filter->x1;
-    filter->x1 = input;
-    filter->y2 = filter->y1;
-    filter->y1 = output;
-    
-    return output;
+// The vector kernels repeat the scalar operations in the same order, so
+// their output matches the reference bit for bit. The exact sine evaluates
+// both of its polynomials and picks one per lane.
+
+#ifdef PFXR_SIMD_SSE2
+static __m128 select_sse2(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
 }
 
-// Generate noise curve for distortion effect
-static float generate_noise_distortion(float input, float noise_amount, uint32_t* noise_seed) {
-    if (noise_amount <= 0.0f) return input;
+#ifdef PFXR_SINE_FAST
+static __m128 fast_sine_sse2(__m128i phase) {
+    __m128 sign_bit = _mm_set1_ps(-0.0f);
+    __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(phase), _mm_set1_ps(PFXR_PHASE_TO_CYCLES));
+    __m128 ax = _mm_andnot_ps(sign_bit, x);
+    ax = select_sse2(_mm_cmpgt_ps(ax, _mm_set1_ps(0.25f)), _mm_sub_ps(_mm_set1_ps(0.5f), ax), ax);
+    x = _mm_or_ps(ax, _mm_and_ps(sign_bit, x));
     
-    // Simple linear congruential generator for deterministic noise
-    *noise_seed = (*noise_seed * 1103515245 + 12345) & 0x7fffffff;
-    float rand1 = (float)(*noise_seed) / (float)0x7fffffff;
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_set1_ps(PFXR_SIN_C7), _mm_mul_ps(x2, _mm_set1_ps(PFXR_SIN_C9)));
+    p = _mm_add_ps(_mm_set1_ps(PFXR_SIN_C5), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(PFXR_SIN_C3), _mm_mul_ps(x2, p));
+    p = _mm_add_ps(_mm_set1_ps(PFXR_SIN_C1), _mm_mul_ps(x2, p));
+    return _mm_mul_ps(x, p);
+}
+#else
+static __m128 exact_sine_sse2(__m128i phase) {
+    // Fold onto a quarter cycle: odd quadrants count back from the peak
+    __m128i quarter = _mm_set1_epi32(0x40000000);
+    __m128i within = _mm_and_si128(phase, _mm_set1_epi32(0x3fffffff));
+    __m128i odd = _mm_srai_epi32(_mm_slli_epi32(phase, 1), 31);
+    __m128i ax = _mm_or_si128(_mm_and_si128(odd, _mm_sub_epi32(quarter, within)), _mm_andnot_si128(odd, within));
     
-    *noise_seed = (*noise_seed * 1103515245 + 12345) & 0x7fffffff;
-    float rand2 = (float)(*noise_seed) / (float)0x7fffffff;
+    __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(quarter, ax)), _mm_set1_ps(PFXR_PHASE_TO_QUARTERS));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 c = _mm_add_ps(_mm_set1_ps(PFXR_SIN_K6), _mm_mul_ps(t2, _mm_set1_ps(PFXR_SIN_K8)));
+    c = _mm_add_ps(_mm_set1_ps(PFXR_SIN_K4), _mm_mul_ps(t2, c));
+    c = _mm_add_ps(_mm_set1_ps(PFXR_SIN_K2), _mm_mul_ps(t2, c));
+    c = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t2, c));
     
-    float deg = M_PI / 180.0f;
-    float noise_factor = (3.0f + rand1 * noise_amount);
-    float distortion = (noise_factor * input * 20.0f * deg) / 
-                      (M_PI + rand2 * noise_amount * fabsf(input));
+    __m128 r = _mm_mul_ps(_mm_cvtepi32_ps(ax), _mm_set1_ps(PFXR_PHASE_TO_RADIANS));
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 s = _mm_add_ps(_mm_set1_ps(PFXR_SIN_S5), _mm_mul_ps(r2, _mm_set1_ps(PFXR_SIN_S7)));
+    s = _mm_add_ps(_mm_set1_ps(PFXR_SIN_S3), _mm_mul_ps(r2, s));
+    s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
     
-    return clamp(distortion, -1.0f, 1.0f);
+    // Both are non-negative, so the phase's top bit is the sign
+    __m128 near_peak = _mm_castsi128_ps(_mm_cmpgt_epi32(ax, _mm_set1_epi32(0x20000000)));
+    __m128 sign = _mm_castsi128_ps(_mm_and_si128(phase, _mm_set1_epi32((int)0x80000000u)));
+    return _mm_or_ps(select_sse2(near_peak, c, s), sign);
 }
+#endif
 
-// Main sound generation function  
-void pfxr_generate_sound(const pfxr_sound_t* config, pfxr_audio_buffer_t* buffer) {
-    if (!config || !buffer) return;
-    
-    float sample_rate = (float)PFXR_SAMPLE_RATE;
-    float duration = config->attackTime + config->sustainTime + config->decayTime;
-    int total_samples = (int)(duration * sample_rate);
+static void osc_block_sse2(pfxr_wave_type_t wave_type, const uint32_t* phases, float* out, int n) {
+    __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
     
-    if (total_samples > buffer->capacity) {
-        total_samples = buffer->capacity;
+    switch (wave_type) {
+        case PFXR_WAVE_SAWTOOTH:
+            for (; i + 4 <= n; i += 4) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(phases + i));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(p), _mm_set1_ps(PFXR_SAW_SCALE)));
+            }
+            break;
+        case PFXR_WAVE_SQUARE:
+            for (; i + 4 <= n; i += 4) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(phases + i));
+                __m128 high = _mm_castsi128_ps(_mm_srai_epi32(p, 31));
+                _mm_storeu_ps(out + i, select_sse2(high, one, _mm_set1_ps(-1.0f)));
+            }
+            break;
+        case PFXR_WAVE_TRIANGLE:
+            for (; i + 4 <= n; i += 4) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(phases + i));
+                __m128i folded = _mm_xor_si128(p, _mm_srai_epi32(p, 31));
+                __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(folded), _mm_set1_ps(PFXR_TRIANGLE_SCALE));
+                _mm_storeu_ps(out + i, _mm_sub_ps(t, one));
+            }
+            break;
+        default:
+            for (; i + 4 <= n; i += 4) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(phases + i));
+#ifdef PFXR_SINE_FAST
+                _mm_storeu_ps(out + i, fast_sine_sse2(p));
+#else
+                _mm_storeu_ps(out + i, exact_sine_sse2(p));
+#endif
+            }
+            break;
     }
     
-    // Initialize noise seed based on config parameters for deterministic noise
-    uint32_t noise_seed = (uint32_t)(config->frequency * 1000 + config->noiseAmount * 100 + config->volume * 1000);
+    osc_block_scalar(wave_type, phases + i, out + i, n - i);
+}
+#endif
+
+#ifdef PFXR_SIMD_AVX2
+#define PFXR_AVX2_FN __attribute__((target("avx2")))
+
+#ifdef PFXR_SINE_FAST
+PFXR_AVX2_FN static __m256 fast_sine_avx2(__m256i phase) {
+    __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(phase), _mm256_set1_ps(PFXR_PHASE_TO_CYCLES));
+    __m256 ax = _mm256_andnot_ps(sign_bit, x);
+    ax = _mm256_blendv_ps(ax, _mm256_sub_ps(_mm256_set1_ps(0.5f), ax),
+                          _mm256_cmp_ps(ax, _mm256_set1_ps(0.25f), _CMP_GT_OQ));
+    x = _mm256_or_ps(ax, _mm256_and_ps(sign_bit, x));
     
-    // Initialize filters
-    biquad_filter_t lowpass_filter = {0};
-    biquad_filter_t highpass_filter = {0};
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_C7), _mm256_mul_ps(x2, _mm256_set1_ps(PFXR_SIN_C9)));
+    p = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_C5), _mm256_mul_ps(x2, p));
+    p = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_C3), _mm256_mul_ps(x2, p));
+    p = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_C1), _mm256_mul_ps(x2, p));
+    return _mm256_mul_ps(x, p);
+}
+#else
+PFXR_AVX2_FN static __m256 exact_sine_avx2(__m256i phase) {
+    __m256i quarter = _mm256_set1_epi32(0x40000000);
+    __m256i within = _mm256_and_si256(phase, _mm256_set1_epi32(0x3fffffff));
+    __m256i odd = _mm256_srai_epi32(_mm256_slli_epi32(phase, 1), 31);
+    __m256i ax = _mm256_blendv_epi8(within, _mm256_sub_epi32(quarter, within), odd);
     
-    if (config->lowPassCutoff > 0.0f) {
-        float q = config->lowPassResonance > 0.0f ? config->lowPassResonance : 0.707f;
-        biquad_lowpass_coeffs(&lowpass_filter, config->lowPassCutoff, q, sample_rate);
-    }
+    __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(quarter, ax)),
+                             _mm256_set1_ps(PFXR_PHASE_TO_QUARTERS));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 c = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_K6), _mm256_mul_ps(t2, _mm256_set1_ps(PFXR_SIN_K8)));
+    c = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_K4), _mm256_mul_ps(t2, c));
+    c = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_K2), _mm256_mul_ps(t2, c));
+    c = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(t2, c));
     
-    if (config->highPassCutoff > 0.0f) {
-        float q = config->highPassResonance > 0.0f ? config->highPassResonance : 0.707f;
-        biquad_highpass_coeffs(&highpass_filter, config->highPassCutoff, q, sample_rate);
-    }
+    __m256 r = _mm256_mul_ps(_mm256_cvtepi32_ps(ax), _mm256_set1_ps(PFXR_PHASE_TO_RADIANS));
+    __m256 r2 = _mm256_mul_ps(r, r);
+    __m256 s = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_S5), _mm256_mul_ps(r2, _mm256_set1_ps(PFXR_SIN_S7)));
+    s = _mm256_add_ps(_mm256_set1_ps(PFXR_SIN_S3), _mm256_mul_ps(r2, s));
+    s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), s));
     
-    // Generate samples
-    float phase = 0.0f;
-    float vibrato_phase = 0.0f;
-    float tremolo_phase = 0.0f;
-    float phaser_phase = 0.0f;
+    __m256 near_peak = _mm256_castsi256_ps(_mm256_cmpgt_epi32(ax, _mm256_set1_epi32(0x20000000)));
+    __m256 sign = _mm256_castsi256_ps(_mm256_and_si256(phase, _mm256_set1_epi32((int)0x80000000u)));
+    return _mm256_or_ps(_mm256_blendv_ps(s, c, near_peak), sign);
+}
+#endif
+
+PFXR_AVX2_FN static void osc_block_avx2(pfxr_wave_type_t wave_type, const uint32_t* phases, float* out, int n) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    
+    switch (wave_type) {
+        case PFXR_WAVE_SAWTOOTH:
+            for (; i + 8 <= n; i += 8) {
+                __m256i p = _mm256_loadu_si256((const __m256i*)(phases + i));
+                _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(p), _mm256_set1_ps(PFXR_SAW_SCALE)));
+            }
+            break;
+        case PFXR_WAVE_SQUARE:
+            for (; i + 8 <= n; i += 8) {
+                // blendv picks by the sign bit, which is the top phase bit
+                __m256i p = _mm256_loadu_si256((const __m256i*)(phases + i));
+                _mm256_storeu_ps(out + i, _mm256_blendv_ps(_mm256_set1_ps(-1.0f), one, _mm256_castsi256_ps(p)));
+            }
+            break;
+        case PFXR_WAVE_TRIANGLE:
+            for (; i + 8 <= n; i += 8) {
+                __m256i p = _mm256_loadu_si256((const __m256i*)(phases + i));
+                __m256i folded = _mm256_xor_si256(p, _mm256_srai_epi32(p, 31));
+                __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(folded), _mm256_set1_ps(PFXR_TRIANGLE_SCALE));
+                _mm256_storeu_ps(out + i, _mm256_sub_ps(t, one));
+            }
+            break;
+        default:
+            for (; i + 8 <= n; i += 8) {
+                __m256i p = _mm256_loadu_si256((const __m256i*)(phases + i));
+#ifdef PFXR_SINE_FAST
+                _mm256_storeu_ps(out + i, fast_sine_avx2(p));
+#else
+                _mm256_storeu_ps(out + i, exact_sine_avx2(p));
+#endif
+            }
+            break;
+    }
+    
+    // Clear the upper halves before running SSE code, which stalls otherwise
+    _mm256_zeroupper();
+    osc_block_sse2(wave_type, phases + i, out + i, n - i);
+}
+
+// Runtime AVX2 check (the result is cached by the compiler runtime)
+static int cpu_has_avx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#ifdef PFXR_SIMD_NEON
+#ifdef PFXR_SINE_FAST
+static float32x4_t fast_sine_neon(int32x4_t phase) {
+    float32x4_t x = vmulq_f32(vcvtq_f32_s32(phase), vdupq_n_f32(PFXR_PHASE_TO_CYCLES));
+    float32x4_t ax = vabsq_f32(x);
+    ax = vbslq_f32(vcgtq_f32(ax, vdupq_n_f32(0.25f)), vsubq_f32(vdupq_n_f32(0.5f), ax), ax);
+    x = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vnegq_f32(ax), ax);
+    
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t p = vaddq_f32(vdupq_n_f32(PFXR_SIN_C7), vmulq_f32(x2, vdupq_n_f32(PFXR_SIN_C9)));
+    p = vaddq_f32(vdupq_n_f32(PFXR_SIN_C5), vmulq_f32(x2, p));
+    p = vaddq_f32(vdupq_n_f32(PFXR_SIN_C3), vmulq_f32(x2, p));
+    p = vaddq_f32(vdupq_n_f32(PFXR_SIN_C1), vmulq_f32(x2, p));
+    return vmulq_f32(x, p);
+}
+#else
+static float32x4_t exact_sine_neon(uint32x4_t phase) {
+    uint32x4_t quarter = vdupq_n_u32(0x40000000u);
+    uint32x4_t within = vandq_u32(phase, vdupq_n_u32(0x3fffffffu));
+    uint32x4_t odd = vtstq_u32(phase, quarter);
+    uint32x4_t ax = vbslq_u32(odd, vsubq_u32(quarter, within), within);
+    
+    float32x4_t t = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vsubq_u32(quarter, ax))),
+                              vdupq_n_f32(PFXR_PHASE_TO_QUARTERS));
+    float32x4_t t2 = vmulq_f32(t, t);
+    float32x4_t c = vaddq_f32(vdupq_n_f32(PFXR_SIN_K6), vmulq_f32(t2, vdupq_n_f32(PFXR_SIN_K8)));
+    c = vaddq_f32(vdupq_n_f32(PFXR_SIN_K4), vmulq_f32(t2, c));
+    c = vaddq_f32(vdupq_n_f32(PFXR_SIN_K2), vmulq_f32(t2, c));
+    c = vaddq_f32(vdupq_n_f32(1.0f), vmulq_f32(t2, c));
+    
+    float32x4_t r = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(ax)), vdupq_n_f32(PFXR_PHASE_TO_RADIANS));
+    float32x4_t r2 = vmulq_f32(r, r);
+    float32x4_t s = vaddq_f32(vdupq_n_f32(PFXR_SIN_S5), vmulq_f32(r2, vdupq_n_f32(PFXR_SIN_S7)));
+    s = vaddq_f32(vdupq_n_f32(PFXR_SIN_S3), vmulq_f32(r2, s));
+    s = vaddq_f32(r, vmulq_f32(vmulq_f32(r, r2), s));
+    
+    uint32x4_t near_peak = vcgtq_u32(ax, vdupq_n_u32(0x20000000u));
+    uint32x4_t value = vreinterpretq_u32_f32(vbslq_f32(near_peak, c, s));
+    return vreinterpretq_f32_u32(vorrq_u32(value, vandq_u32(phase, vdupq_n_u32(0x80000000u))));
+}
+#endif
+
+static void osc_block_neon(pfxr_wave_type_t wave_type, const uint32_t* phases, float* out, int n) {
+    float32x4_t one = vdupq_n_f32(1.0f);
+    int i = 0;
+    
+    switch (wave_type) {
+        case PFXR_WAVE_SAWTOOTH:
+            for (; i + 4 <= n; i += 4) {
+                int32x4_t p = vreinterpretq_s32_u32(vld1q_u32(phases + i));
+                vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(p), vdupq_n_f32(PFXR_SAW_SCALE)));
+            }
+            break;
+        case PFXR_WAVE_SQUARE:
+            for (; i + 4 <= n; i += 4) {
+                int32x4_t p = vreinterpretq_s32_u32(vld1q_u32(phases + i));
+                vst1q_f32(out + i, vbslq_f32(vcltq_s32(p, vdupq_n_s32(0)), one, vdupq_n_f32(-1.0f)));
+            }
+            break;
+        case PFXR_WAVE_TRIANGLE:
+            for (; i + 4 <= n; i += 4) {
+                int32x4_t p = vreinterpretq_s32_u32(vld1q_u32(phases + i));
+                int32x4_t folded = veorq_s32(p, vshrq_n_s32(p, 31));
+                float32x4_t t = vmulq_f32(vcvtq_f32_s32(folded), vdupq_n_f32(PFXR_TRIANGLE_SCALE));
+                vst1q_f32(out + i, vsubq_f32(t, one));
+            }
+            break;
+        default:
+            for (; i + 4 <= n; i += 4) {
+#ifdef PFXR_SINE_FAST
+                vst1q_f32(out + i, fast_sine_neon(vreinterpretq_s32_u32(vld1q_u32(phases + i))));
+#else
+                vst1q_f32(out + i, exact_sine_neon(vld1q_u32(phases + i)));
+#endif
+            }
+            break;
+    }
+    
+    osc_block_scalar(wave_type, phases + i, out + i, n - i);
+}
+#endif
+
+// Evaluate a block of oscillator samples with the best kernel for this CPU
+static void osc_block(pfxr_wave_type_t wave_type, const uint32_t* phases, float* out, int n) {
+#if defined(PFXR_SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        osc_block_avx2(wave_type, phases, out, n);
+        return;
+    }
+#endif
+#if defined(PFXR_SIMD_SSE2)
+    osc_block_sse2(wave_type, phases, out, n);
+#elif defined(PFXR_SIMD_NEON)
+    osc_block_neon(wave_type, phases, out, n);
+#else
+    osc_block_scalar(wave_type, phases, out, n);
+#endif
+}
+
+// Simple biquad filter implementation
+static void biquad_lowpass_coeffs(pfxr_biquad_t* filter, float freq, float q, float sample_rate) {
+    float w = 2.0f * M_PI * freq / sample_rate;
+    float cos_w = cosf(w);
+    float sin_w = sinf(w);
+    float alpha = sin_w / (2.0f * q);
+    
+    float b0 = (1.0f - cos_w) / 2.0f;
+    float b1 = 1.0f - cos_w;
+    float b2 = (1.0f - cos_w) / 2.0f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cos_w;
+    float a2 = 1.0f - alpha;
+    
+    filter->a0 = b0 / a0;
+    filter->a1 = b1 / a0;
+    filter->a2 = b2 / a0;
+    filter->b1 = a1 / a0;
+    filter->b2 = a2 / a0;
+}
+
+static void biquad_highpass_coeffs(pfxr_biquad_t* filter, float freq, float q, float sample_rate) {
+    float w = 2.0f * M_PI * freq / sample_rate;
+    float cos_w = cosf(w);
+    float sin_w = sinf(w);
+    float alpha = sin_w / (2.0f * q);
+    
+    float b0 = (1.0f + cos_w) / 2.0f;
+    float b1 = -(1.0f + cos_w);
+    float b2 = (1.0f + cos_w) / 2.0f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cos_w;
+    float a2 = 1.0f - alpha;
+    
+    filter->a0 = b0 / a0;
+    filter->a1 = b1 / a0;
+    filter->a2 = b2 / a0;
+    filter->b1 = a1 / a0;
+    filter->b2 = a2 / a0;
+}
+
+static float biquad_process(pfxr_biquad_t* filter, float input) {
+    float output = filter->a0 * input + filter->a1 * filter->x1 + filter->a2 * filter->x2
+                  - filter->b1 * filter->y1 - filter->b2 * filter->y2;
+    
+    filter->x2 = filter->x1;
+    filter->x1 = input;
+    filter->y2 = filter->y1;
+    filter->y1 = output;
+    
+    return output;
+}
+
+// Generate noise curve for distortion effect
+static float generate_noise_distortion(float input, float noise_amount, uint32_t* noise_seed) {
+    if (noise_amount <= 0.0f) return input;
+    
+    // Simple linear congruential generator for deterministic noise
+    *noise_seed = (*noise_seed * 1103515245 + 12345) & 0x7fffffff;
+    float rand1 = (float)(*noise_seed) / (float)0x7fffffff;
+    
+    *noise_seed = (*noise_seed * 1103515245 + 12345) & 0x7fffffff;
+    float rand2 = (float)(*noise_seed) / (float)0x7fffffff;
+    
+    float deg = M_PI / 180.0f;
+    float noise_factor = (3.0f + rand1 * noise_amount);
+    float distortion = (noise_factor * input * 20.0f * deg) / 
+                      (M_PI + rand2 * noise_amount * fabsf(input));
+    
+    return clamp(distortion, -1.0f, 1.0f);
+}
+
+// Rate a render runs at for a requested rate
+static float render_rate(int sample_rate) {
+    if (sample_rate <= 0) return (float)PFXR_SAMPLE_RATE;
+    return (float)(sample_rate < PFXR_MAX_SAMPLE_RATE ? sample_rate : PFXR_MAX_SAMPLE_RATE);
+}
+
+// Longest sound at a rate, PFXR_MAX_SAMPLES at PFXR_SAMPLE_RATE
+static int max_samples_at(float sample_rate) {
+    return (int)(sample_rate * PFXR_MAX_DURATION);
+}
+
+// Number of samples a configuration renders to, limited to max_samples
+static int sound_sample_count(const pfxr_sound_t* config, float sample_rate, int max_samples) {
+    float duration = config->attackTime + config->sustainTime + config->decayTime;
+    int total_samples = (int)(duration * sample_rate);
+    
+    if (total_samples > max_samples) {
+        total_samples = max_samples;
+    }
+    if (total_samples < 0) {
+        total_samples = 0;
+    }
+    return total_samples;
+}
+
+// First sample whose time is at or after seconds
+static int sample_at_time(float seconds, float sample_rate, int total_samples) {
+    if (!(seconds > 0.0f)) return 0;
+    
+    float inv_sample_rate = 1.0f / sample_rate;
+    float guess = seconds * sample_rate;
+    if (!(guess < (float)total_samples)) return total_samples;
+    
+    int i = (int)guess;
+    while (i > 0 && (float)(i - 1) * inv_sample_rate >= seconds) i--;
+    while (i < total_samples && (float)i * inv_sample_rate < seconds) i++;
+    return i;
+}
+
+static int add_segment(pfxr_segment_t* segments, int count, pfxr_segment_kind_t kind,
+                       int start, int end, float value, float step) {
+    if (end <= start) return count;
+    segments[count].kind = kind;
+    segments[count].start = start;
+    segments[count].length = end - start;
+    segments[count].value = value;
+    segments[count].step = step;
+    return count + 1;
+}
+
+// Split the envelope into attack, sustain and decay lines
+static int build_envelope_segments(const pfxr_sound_t* config, float sample_rate, int total_samples,
+                                   pfxr_segment_t* segments) {
+    float inv_sample_rate = 1.0f / sample_rate;
+    float sustain_end = config->attackTime + config->sustainTime;
+    float decay_gain = 1.0f - config->sustainPunch;
+    int attack_end = sample_at_time(config->attackTime, sample_rate, total_samples);
+    int decay_start = sample_at_time(sustain_end, sample_rate, total_samples);
+    if (decay_start < attack_end) decay_start = attack_end;
+    int count = 0;
+    
+    // The attack rises to the punch level, the sustain jumps to full gain and
+    // the decay falls from the punch level to zero at the end of the sound
+    count = add_segment(segments, count, PFXR_SEGMENT_ATTACK, 0, attack_end,
+                        0.0f, decay_gain / config->attackTime * inv_sample_rate);
+    count = add_segment(segments, count, PFXR_SEGMENT_SUSTAIN, attack_end, decay_start, 1.0f, 0.0f);
+    
+    float value = 0.0f, step = 0.0f;
+    if (config->decayTime > 0.0f) {
+        float decay_slope = 1.0f / config->decayTime;
+        float t = (float)decay_start * inv_sample_rate;
+        value = decay_gain * (1.0f - (t - sustain_end) * decay_slope);
+        step = -decay_gain * decay_slope * inv_sample_rate;
+    }
+    return add_segment(segments, count, PFXR_SEGMENT_DECAY, decay_start, total_samples, value, step);
+}
+
+// Split the pitch curve into the delay before the sweep, the sweep and the
+// hold at the final frequency
+static int build_pitch_segments(const pfxr_sound_t* config, float sample_rate, int total_samples,
+                                pfxr_segment_t* segments) {
+    float inv_sample_rate = 1.0f / sample_rate;
+    float duration = config->attackTime + config->sustainTime + config->decayTime;
+    int count = 0;
+    
+    if (config->pitchDelta == 0.0f || !(config->pitchDelay < duration)) {
+        return add_segment(segments, count, PFXR_SEGMENT_PITCH_DELAY, 0, total_samples, config->frequency, 0.0f);
+    }
+    
+    float sweep_scale = 1.0f / (duration - config->pitchDelay);
+    float sweep_length = config->pitchDuration > 0.0f ? config->pitchDuration : 0.0f;
+    int sweep_start = sample_at_time(config->pitchDelay, sample_rate, total_samples);
+    int sweep_end = sample_at_time(config->pitchDelay + sweep_length / sweep_scale, sample_rate, total_samples);
+    if (sweep_end < sweep_start) sweep_end = sweep_start;
+    
+    float t = (float)sweep_start * inv_sample_rate;
+    float sweep_value = config->frequency + config->pitchDelta * ((t - config->pitchDelay) * sweep_scale);
+    float sweep_step = config->pitchDelta * sweep_scale * inv_sample_rate;
+    
+    count = add_segment(segments, count, PFXR_SEGMENT_PITCH_DELAY, 0, sweep_start, config->frequency, 0.0f);
+    count = add_segment(segments, count, PFXR_SEGMENT_SWEEP, sweep_start, sweep_end, sweep_value, sweep_step);
+    return add_segment(segments, count, PFXR_SEGMENT_HOLD, sweep_end, total_samples,
+                       config->frequency + config->pitchDelta * config->pitchDuration, 0.0f);
+}
+
+// Prepare generator state for a sound of at most max_samples samples
+static void generator_setup(pfxr_generator_t* gen, const pfxr_sound_t* config, float sample_rate, int max_samples) {
+    memset(gen, 0, offsetof(pfxr_generator_t, history_storage));
+    gen->history_size = PFXR_PHASER_HISTORY;
+    if (!config) return;
+    
+    gen->config = *config;
+    gen->sample_rate = sample_rate;
+    gen->duration = config->attackTime + config->sustainTime + config->decayTime;
+    gen->total_samples = sound_sample_count(config, gen->sample_rate, max_samples);
+    
+    // Initialize noise seed based on config parameters for deterministic noise
+    gen->noise_seed = (uint32_t)(config->frequency * 1000 + config->noiseAmount * 100 + config->volume * 1000);
+    
+    // Initialize filters
+    if (config->lowPassCutoff > 0.0f) {
+        float q = config->lowPassResonance > 0.0f ? config->lowPassResonance : 0.707f;
+        biquad_lowpass_coeffs(&gen->lowpass, config->lowPassCutoff, q, gen->sample_rate);
+    }
+    
+    if (config->highPassCutoff > 0.0f) {
+        float q = config->highPassResonance > 0.0f ? config->highPassResonance : 0.707f;
+        biquad_highpass_coeffs(&gen->highpass, config->highPassCutoff, q, gen->sample_rate);
+    }
+    
+    // Pick the stages that affect the output
+    if (config->pitchDelta != 0.0f) gen->stages |= PFXR_STAGE_PITCH_SWEEP;
+    if (config->vibratoRate > 0.0f && config->vibratoDepth > 0.0f) gen->stages |= PFXR_STAGE_VIBRATO;
+    if (config->noiseAmount > 0.0f) gen->stages |= PFXR_STAGE_NOISE;
+    if (config->phaserDepth > 0.0f) gen->stages |= PFXR_STAGE_PHASER;
+    if (config->lowPassCutoff > 0.0f && config->lowPassCutoff < 4000.0f) gen->stages |= PFXR_STAGE_LOWPASS;
+    if (config->highPassCutoff > 0.0f) gen->stages |= PFXR_STAGE_HIGHPASS;
+    if (config->tremoloRate > 0.0f && config->tremoloDepth > 0.0f) gen->stages |= PFXR_STAGE_TREMOLO;
+    
+    // Precompute per-sample constants so the loops multiply instead of divide
+    gen->phase_scale = PFXR_PHASE_SCALE / gen->sample_rate;
+    gen->envelope_count = build_envelope_segments(config, gen->sample_rate, gen->total_samples, gen->envelope);
+    gen->pitch_count = build_pitch_segments(config, gen->sample_rate, gen->total_samples, gen->pitch);
+    gen->noise_amount = config->noiseAmount / 100.0f;
+    gen->vibrato.step = phase_step(config->vibratoRate, gen->sample_rate);
+    gen->tremolo.step = phase_step(config->tremoloRate, gen->sample_rate);
+    gen->phaser.step = phase_step(config->phaserLfoFrequency, gen->sample_rate);
+    
+    pfxr_generator_set_control_interval(gen, PFXR_CONTROL_INTERVAL);
+}
+
+// Load the first two control points of an interpolated LFO
+static void lfo_prime(pfxr_lfo_t* lfo, int interval) {
+    lfo->from = generate_sine(lfo->phase);
+    lfo->phase += lfo->step * (uint32_t)interval;
+    lfo->to = generate_sine(lfo->phase);
+}
+
+// Every LFO starts its cycle at the first sample
+static void lfo_reset(pfxr_lfo_t* lfo) {
+    lfo->phase = 0;
+    lfo->from = 0.0f;
+    lfo->to = 0.0f;
+}
+
+// Evaluate the LFOs once every interval samples and interpolate linearly in
+// between. The error is about (pi * rate * interval / sample_rate)^2 / 2 of
+// the modulation depth, e.g. 0.5% for a 35 Hz LFO every 32 samples at 44.1 kHz.
+// Only possible before the first sample is rendered; 0 or 1 is exact.
+int pfxr_generator_set_control_interval(pfxr_generator_t* gen, int interval) {
+    if (!gen || gen->position != 0) return -1;
+    if (interval < 1) interval = 1;
+    
+    // Undo the priming for any earlier interval
+    lfo_reset(&gen->vibrato);
+    lfo_reset(&gen->tremolo);
+    lfo_reset(&gen->phaser);
+    gen->control_interval = interval;
+    gen->control_offset = 0;
+    if (interval > 1) {
+        lfo_prime(&gen->vibrato, interval);
+        lfo_prime(&gen->tremolo, interval);
+        lfo_prime(&gen->phaser, interval);
+    }
+    return 0;
+}
+
+// Initialize a streaming generator for the given configuration
+void pfxr_generator_init(pfxr_generator_t* gen, const pfxr_sound_t* config) {
+    pfxr_generator_init_rate(gen, config, PFXR_SAMPLE_RATE);
+}
+
+// Initialize a streaming generator at a sample rate. Envelope timing, pitch
+// sweeps, LFO rates and filter coefficients all follow the rate.
+void pfxr_generator_init_rate(pfxr_generator_t* gen, const pfxr_sound_t* config, int sample_rate) {
+    if (!gen) return;
+    float rate = render_rate(sample_rate);
+    generator_setup(gen, config, rate, max_samples_at(rate));
+}
+
+// Initialize a generator for a one-shot render, control_interval 0 keeping
+// PFXR_CONTROL_INTERVAL
+static void render_generator_init(pfxr_generator_t* gen, const pfxr_sound_t* config, int sample_rate,
+                                  int control_interval) {
+    pfxr_generator_init_rate(gen, config, sample_rate);
+    if (control_interval > 0) {
+        pfxr_generator_set_control_interval(gen, control_interval);
+    }
+}
+
+// Replace the phaser delay line with a caller-owned one. Phaser taps further
+// back than the delay line reach read silence, so a history as long as the
+// sound reproduces pfxr_generate_sound exactly.
+void pfxr_generator_set_history(pfxr_generator_t* gen, float* history, int size) {
+    if (!gen) return;
+    if (!history || size <= 0) {
+        gen->history = NULL;
+        gen->history_size = PFXR_PHASER_HISTORY;
+    } else {
+        gen->history = history;
+        gen->history_size = size;
+    }
+    gen->history_pos = gen->position % gen->history_size;
+}
+
+// Number of samples left to render
+int pfxr_generator_remaining(const pfxr_generator_t* gen) {
+    if (!gen) return 0;
+    return gen->total_samples - gen->position;
+}
+
+// Envelope and pitch segments of a sound, returns the total count (at most
+// PFXR_MAX_SEGMENTS) even when max is smaller
+int pfxr_sound_segments(const pfxr_sound_t* config, pfxr_segment_t* out, int max) {
+    if (!config) return 0;
+    
+    pfxr_segment_t segments[PFXR_MAX_SEGMENTS];
+    float sample_rate = (float)PFXR_SAMPLE_RATE;
+    int total_samples = sound_sample_count(config, sample_rate, PFXR_MAX_SAMPLES);
+    int count = build_envelope_segments(config, sample_rate, total_samples, segments);
+    count += build_pitch_segments(config, sample_rate, total_samples, segments + count);
+    
+    if (out) {
+        memcpy(out, segments, (count < max ? count : max > 0 ? max : 0) * sizeof(pfxr_segment_t));
+    }
+    return count;
+}
+
+// Phaser delay line length needed to match a full-buffer render exactly
+static int generator_history_needed(const pfxr_generator_t* gen) {
+    const pfxr_sound_t* config = &gen->config;
+    if (config->phaserDepth <= 0.0f || gen->total_samples <= 0) return 0;
+    
+    // The longest tap comes from the lowest frequency the phaser sweeps to
+    float lowest = config->phaserBaseFrequency - config->phaserDepth + 1.0f;
+    if (lowest <= 0.0f) return gen->total_samples;
+    
+    float longest = gen->sample_rate / lowest + 2.0f;
+    if (longest >= (float)gen->total_samples) return gen->total_samples;
+    return (int)longest;
+}
+
+// Render the part of a piecewise-linear curve in [start, start + count)
+static void render_segments(const pfxr_segment_t* segments, int segment_count, float* out, int start, int count) {
+    int end = start + count;
+    
+    for (int s = 0; s < segment_count; s++) {
+        const pfxr_segment_t* seg = &segments[s];
+        int from = seg->start > start ? seg->start : start;
+        int to = seg->start + seg->length < end ? seg->start + seg->length : end;
+        if (from >= to) continue;
+        
+        float* dst = out + (from - start);
+        int n = to - from;
+        if (seg->step == 0.0f) {
+            for (int k = 0; k < n; k++) dst[k] = seg->value;
+        } else {
+            // Offsets from the segment start keep long, shallow ramps exact
+            int offset = from - seg->start;
+            for (int k = 0; k < n; k++) {
+                dst[k] = seg->value + (float)(offset + k) * seg->step;
+            }
+        }
+    }
+}
+
+// Envelope gain for count samples starting at sample index start
+static void stage_envelope(const pfxr_generator_t* gen, float* envelopes, int start, int count) {
+    render_segments(gen->envelope, gen->envelope_count, envelopes, start, count);
+    for (int k = 0; k < count; k++) {
+        if (envelopes[k] < 0.0f) envelopes[k] = 0.0f;
+    }
+}
+
+// Sine LFO values for the next count samples
+static void stage_lfo(const pfxr_generator_t* gen, pfxr_lfo_t* lfo, float* values, int count) {
+    int interval = gen->control_interval;
+    
+    if (interval <= 1) {
+        uint32_t phase = lfo->phase;
+        for (int k = 0; k < count; k++) {
+            values[k] = generate_sine(phase);
+            phase += lfo->step;
+        }
+        lfo->phase = phase;
+        return;
+    }
+    
+    float inv_interval = 1.0f / (float)interval;
+    int offset = gen->control_offset;
+    for (int k = 0; k < count; k++) {
+        if (offset == interval) {
+            // Move on to the next control point
+            lfo->from = lfo->to;
+            lfo->phase += lfo->step * (uint32_t)interval;
+            lfo->to = generate_sine(lfo->phase);
+            offset = 0;
+        }
+        values[k] = lfo->from + (lfo->to - lfo->from) * ((float)offset * inv_interval);
+        offset++;
+    }
+}
+
+// Oscillator frequency for count samples, including pitch sweep and vibrato
+static void stage_frequency(pfxr_generator_t* gen, float* freqs, int start, int count) {
+    const pfxr_sound_t* config = &gen->config;
+    
+    render_segments(gen->pitch, gen->pitch_count, freqs, start, count);
+    
+    if (gen->stages & PFXR_STAGE_VIBRATO) {
+        float vibrato[PFXR_OSC_BLOCK];
+        stage_lfo(gen, &gen->vibrato, vibrato, count);
+        for (int k = 0; k < count; k++) {
+            freqs[k] += vibrato[k] * config->vibratoDepth;
+        }
+    }
+}
+
+// Oscillator output for count samples at the given frequencies
+static void stage_oscillator(pfxr_generator_t* gen, const float* freqs, float* samples, int count) {
+    uint32_t phases[PFXR_OSC_BLOCK];
+    uint32_t phase = gen->phase;
+    int silent = 0;
+    
+    // The oscillator only advances, and only sounds, while the frequency is
+    // positive. Frequencies above the sample rate alias as if they were at it.
+    for (int k = 0; k < count; k++) {
+        phases[k] = phase;
+        if (freqs[k] > 0.0f) {
+            float freq = freqs[k] < gen->sample_rate ? freqs[k] : gen->sample_rate;
+            phase += (uint32_t)(int64_t)(freq * gen->phase_scale);
+        } else {
+            silent++;
+        }
+    }
+    gen->phase = phase;
+    
+    osc_block((pfxr_wave_type_t)gen->config.waveForm, phases, samples, count);
+    
+    if (silent) {
+        for (int k = 0; k < count; k++) {
+            if (!(freqs[k] > 0.0f)) samples[k] = 0.0f;
+        }
+    }
+}
+
+static void stage_noise(pfxr_generator_t* gen, float* samples, int count) {
+    uint32_t noise_seed = gen->noise_seed;
+    for (int k = 0; k < count; k++) {
+        samples[k] = generate_noise_distortion(samples[k], gen->noise_amount, &noise_seed);
+    }
+    gen->noise_seed = noise_seed;
+}
+
+static void stage_biquad(pfxr_biquad_t* filter, float* samples, int count) {
+    pfxr_biquad_t f = *filter;
+    for (int k = 0; k < count; k++) {
+        float output = f.a0 * samples[k] + f.a1 * f.x1 + f.a2 * f.x2 - f.b1 * f.y1 - f.b2 * f.y2;
+        f.x2 = f.x1;
+        f.x1 = samples[k];
+        f.y2 = f.y1;
+        f.y1 = output;
+        samples[k] = output;
+    }
+    *filter = f;
+}
+
+// Envelope, tremolo, volume and clamp into the output
+static void stage_output(pfxr_generator_t* gen, const float* samples, const float* envelopes, float* out, int count) {
+    const pfxr_sound_t* config = &gen->config;
+    
+    if (gen->stages & PFXR_STAGE_TREMOLO) {
+        float lfo[PFXR_OSC_BLOCK];
+        stage_lfo(gen, &gen->tremolo, lfo, count);
+        for (int k = 0; k < count; k++) {
+            float tremolo = 1.0f - config->tremoloDepth * (1.0f + lfo[k]) * 0.5f;
+            out[k] = clamp(samples[k] * envelopes[k] * tremolo * config->volume, -1.0f, 1.0f);
+        }
+    } else {
+        for (int k = 0; k < count; k++) {
+            out[k] = clamp(samples[k] * envelopes[k] * config->volume, -1.0f, 1.0f);
+        }
+    }
+}
+
+// The phaser mixes in earlier output, so everything from the phaser on runs
+// one sample at a time
+static void stage_phaser_output(pfxr_generator_t* gen, const float* samples, const float* envelopes,
+                                float* out, int start, int count) {
+    const pfxr_sound_t* config = &gen->config;
+    unsigned int stages = gen->stages;
+    float sample_rate = gen->sample_rate;
+    float* history = gen->history ? gen->history : gen->history_storage;
+    int history_size = gen->history_size;
+    int history_pos = gen->history_pos;
+    
+    // Neither LFO depends on the output, so both are worked out up front
+    float phaser_lfo[PFXR_OSC_BLOCK];
+    float tremolo_lfo[PFXR_OSC_BLOCK];
+    stage_lfo(gen, &gen->phaser, phaser_lfo, count);
+    if (stages & PFXR_STAGE_TREMOLO) stage_lfo(gen, &gen->tremolo, tremolo_lfo, count);
+    
+    for (int k = 0; k < count; k++) {
+        int i = start + k;
+        float sample = samples[k];
+        
+        float phaser_freq = config->phaserBaseFrequency + phaser_lfo[k] * config->phaserDepth;
+        // Simplified phaser - just add a delayed version of the output
+        float delay_samples = sample_rate / (phaser_freq + 1.0f);
+        if (delay_samples >= 1.0f && delay_samples < (float)(i + 1) &&
+            delay_samples < (float)history_size) {
+            int tap = history_pos - (int)delay_samples;
+            if (tap < 0) tap += history_size;
+            sample += history[tap] * 0.5f;
+        }
+        
+        if (stages & PFXR_STAGE_LOWPASS) sample = biquad_process(&gen->lowpass, sample);
+        if (stages & PFXR_STAGE_HIGHPASS) sample = biquad_process(&gen->highpass, sample);
+        
+        sample *= envelopes[k];
+        if (stages & PFXR_STAGE_TREMOLO) {
+            sample *= 1.0f - config->tremoloDepth * (1.0f + tremolo_lfo[k]) * 0.5f;
+        }
+        sample = clamp(sample * config->volume, -1.0f, 1.0f);
+        
+        // Remember output for the phaser delay line
+        history[history_pos] = sample;
+        if (++history_pos == history_size) history_pos = 0;
+        
+        out[k] = sample;
+    }
+    
+    gen->history_pos = history_pos;
+}
+
+// Render the next block of up to n samples, returns the number written
+int pfxr_generator_render(pfxr_generator_t* gen, float* out, int n) {
+    if (!gen || !out || n <= 0) return 0;
+    
+    int remaining = gen->total_samples - gen->position;
+    if (n > remaining) n = remaining;
+    if (n <= 0) return 0;
+    
+    float envelopes[PFXR_OSC_BLOCK];
+    float freqs[PFXR_OSC_BLOCK];
+    float samples[PFXR_OSC_BLOCK];
+    unsigned int stages = gen->stages;
+    
+    for (int block = 0; block < n; block += PFXR_OSC_BLOCK) {
+        int count = n - block < PFXR_OSC_BLOCK ? n - block : PFXR_OSC_BLOCK;
+        int start = gen->position + block;
+        
+        stage_envelope(gen, envelopes, start, count);
+        stage_frequency(gen, freqs, start, count);
+        stage_oscillator(gen, freqs, samples, count);
+        
+        if (stages & PFXR_STAGE_NOISE) stage_noise(gen, samples, count);
+        
+        if (stages & PFXR_STAGE_PHASER) {
+            stage_phaser_output(gen, samples, envelopes, out + block, start, count);
+        } else {
+            if (stages & PFXR_STAGE_LOWPASS) stage_biquad(&gen->lowpass, samples, count);
+            if (stages & PFXR_STAGE_HIGHPASS) stage_biquad(&gen->highpass, samples, count);
+            stage_output(gen, samples, envelopes, out + block, count);
+        }
+        
+        if (gen->control_interval > 1) {
+            gen->control_offset = (gen->control_offset + count - 1) % gen->control_interval + 1;
+        }
+    }
+    
+    gen->position += n;
+    return n;
+}
+
+// Main sound generation function  
+void pfxr_generate_sound(const pfxr_sound_t* config, pfxr_audio_buffer_t* buffer) {
+    if (!config || !buffer) return;
+    
+    pfxr_generator_t gen;
+    generator_setup(&gen, config, render_rate(buffer->sample_rate), buffer->capacity);
+    
+    // The output buffer doubles as the phaser delay line
+    pfxr_generator_set_history(&gen, buffer->samples, buffer->capacity > 0 ? buffer->capacity : 1);
+    
+    buffer->sample_count = pfxr_generator_render(&gen, buffer->samples, gen.total_samples);
+}
+
+// ============================================================================
+// LANE-PARALLEL RENDERING IMPLEMENTATION
+// ============================================================================
+
+// pfxr_render_soa runs PFXR_LANES voices in lockstep, one per vector lane, so
+// the biquads and noise LCG, which are serial within a voice, run in
+// parallel across voices. Each lane repeats the generator's arithmetic in
+// the same order, so lane output matches pfxr_render_into sample for
+// sample. The lanes use GCC/Clang vector extensions and run in chunks of
+// the register width the compiler targets (4 with SSE2/NEON, 8 when AVX is
+// enabled with -mavx or -march=native); other compilers render the lanes one
+// at a time.
+
+#if !defined(PFXR_NO_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define PFXR_LANE_VECTORS 1
+#if defined(__AVX__)
+#define PFXR_LANE_WIDTH 8
+#else
+#define PFXR_LANE_WIDTH 4
+#endif
+#endif
+
+void pfxr_sound_soa_load(pfxr_sound_soa_t* soa, const pfxr_sound_t* configs, int count) {
+    if (!soa) return;
+    if (!configs || count < 0) count = 0;
+    if (count > PFXR_LANES) count = PFXR_LANES;
+    
+    memset(soa, 0, sizeof(*soa));
+    soa->count = count;
+    for (int l = 0; l < count; l++) {
+        const pfxr_sound_t* c = &configs[l];
+        soa->waveForm[l] = c->waveForm;
+        soa->volume[l] = c->volume;
+        soa->attackTime[l] = c->attackTime;
+        soa->sustainTime[l] = c->sustainTime;
+        soa->sustainPunch[l] = c->sustainPunch;
+        soa->decayTime[l] = c->decayTime;
+        soa->frequency[l] = c->frequency;
+        soa->pitchDelta[l] = c->pitchDelta;
+        soa->pitchDuration[l] = c->pitchDuration;
+        soa->pitchDelay[l] = c->pitchDelay;
+        soa->vibratoRate[l] = c->vibratoRate;
+        soa->vibratoDepth[l] = c->vibratoDepth;
+        soa->tremoloRate[l] = c->tremoloRate;
+        soa->tremoloDepth[l] = c->tremoloDepth;
+        soa->highPassCutoff[l] = c->highPassCutoff;
+        soa->highPassResonance[l] = c->highPassResonance;
+        soa->lowPassCutoff[l] = c->lowPassCutoff;
+        soa->lowPassResonance[l] = c->lowPassResonance;
+        soa->phaserBaseFrequency[l] = c->phaserBaseFrequency;
+        soa->phaserLfoFrequency[l] = c->phaserLfoFrequency;
+        soa->phaserDepth[l] = c->phaserDepth;
+        soa->noiseAmount[l] = c->noiseAmount;
+    }
+}
+
+void pfxr_sound_soa_get(const pfxr_sound_soa_t* soa, int lane, pfxr_sound_t* config) {
+    if (!soa || !config || lane < 0 || lane >= PFXR_LANES) return;
+    
+    config->waveForm = soa->waveForm[lane];
+    config->volume = soa->volume[lane];
+    config->attackTime = soa->attackTime[lane];
+    config->sustainTime = soa->sustainTime[lane];
+    config->sustainPunch = soa->sustainPunch[lane];
+    config->decayTime = soa->decayTime[lane];
+    config->frequency = soa->frequency[lane];
+    config->pitchDelta = soa->pitchDelta[lane];
+    config->pitchDuration = soa->pitchDuration[lane];
+    config->pitchDelay = soa->pitchDelay[lane];
+    config->vibratoRate = soa->vibratoRate[lane];
+    config->vibratoDepth = soa->vibratoDepth[lane];
+    config->tremoloRate = soa->tremoloRate[lane];
+    config->tremoloDepth = soa->tremoloDepth[lane];
+    config->highPassCutoff = soa->highPassCutoff[lane];
+    config->highPassResonance = soa->highPassResonance[lane];
+    config->lowPassCutoff = soa->lowPassCutoff[lane];
+    config->lowPassResonance = soa->lowPassResonance[lane];
+    config->phaserBaseFrequency = soa->phaserBaseFrequency[lane];
+    config->phaserLfoFrequency = soa->phaserLfoFrequency[lane];
+    config->phaserDepth = soa->phaserDepth[lane];
+    config->noiseAmount = soa->noiseAmount[lane];
+}
+
+#ifdef PFXR_LANE_VECTORS
+typedef float soa_float __attribute__((vector_size(PFXR_LANE_WIDTH * sizeof(float))));
+typedef int32_t soa_int __attribute__((vector_size(PFXR_LANE_WIDTH * sizeof(int32_t))));
+typedef uint32_t soa_uint __attribute__((vector_size(PFXR_LANE_WIDTH * sizeof(uint32_t))));
+typedef double soa_double __attribute__((vector_size(PFXR_LANE_WIDTH * sizeof(double))));
+
+// Per-lane a where mask is set, b elsewhere (masks come from comparisons)
+#define PFXR_LANE_SELECT(mask, a, b) \
+    ((soa_float)(((mask) & (soa_int)(a)) | (~(mask) & (soa_int)(b))))
+
+// Envelope or pitch curve of every lane, tracking each lane's current segment
+typedef struct {
+    soa_float value;
+    soa_float step;
+    soa_int start;
+    soa_int end;
+    pfxr_segment_t segments[PFXR_LANE_WIDTH][3];
+    int count[PFXR_LANE_WIDTH];
+    int index[PFXR_LANE_WIDTH];
+} soa_curve_t;
+
+typedef struct {
+    soa_uint phase;
+    soa_uint step;
+    soa_float from;
+    soa_float to;
+} soa_lfo_t;
+
+typedef struct {
+    soa_float a0, a1, a2, b1, b2;
+    soa_float x1, x2, y1, y2;
+} soa_biquad_t;
+
+typedef struct {
+    soa_curve_t envelope;
+    soa_curve_t pitch;
+    soa_uint phase;
+    soa_lfo_t vibrato;
+    soa_lfo_t tremolo;
+    soa_lfo_t phaser;
+    soa_uint noise_seed;
+    soa_float noise_amount;
+    soa_biquad_t lowpass;
+    soa_biquad_t highpass;
+    soa_int wave;
+    soa_int active;                 // PFXR_STAGE_* bits per lane
+    soa_float volume;
+    soa_float vibrato_depth;
+    soa_float tremolo_depth;
+    soa_float phaser_base;
+    soa_float phaser_depth;
+    int total[PFXR_LANE_WIDTH];
+    unsigned int any;               // Stages active in any lane
+    float sample_rate;
+    int control_interval;
+} soa_state_t;
+
+// Make segment index the lane's current one; past the last segment the lane
+// keeps its final line and never reaches another boundary
+static void soa_curve_select(soa_curve_t* curve, int lane, int index) {
+    if (index >= curve->count[lane]) {
+        curve->end[lane] = 0x7fffffff;
+        return;
+    }
+    const pfxr_segment_t* seg = &curve->segments[lane][index];
+    curve->index[lane] = index;
+    curve->value[lane] = seg->value;
+    curve->step[lane] = seg->step;
+    curve->start[lane] = seg->start;
+    curve->end[lane] = seg->start + seg->length;
+}
+
+static void soa_curve_load(soa_curve_t* curve, int lane, const pfxr_segment_t* segments, int count) {
+    memcpy(curve->segments[lane], segments, count * sizeof(pfxr_segment_t));
+    curve->count[lane] = count;
+    soa_curve_select(curve, lane, 0);
+}
+
+// Move lanes whose segment ends at sample i on, returns the next boundary
+static int soa_curve_advance(soa_curve_t* curve, int i) {
+    int next = 0x7fffffff;
+    for (int l = 0; l < PFXR_LANE_WIDTH; l++) {
+        if (curve->end[l] == i) soa_curve_select(curve, l, curve->index[l] + 1);
+        if (curve->end[l] < next) next = curve->end[l];
+    }
+    return next;
+}
+
+static void soa_curve_values(const soa_curve_t* curve, int i, soa_float* out) {
+    soa_float offset = __builtin_convertvector(i - curve->start, soa_float);
+    soa_float ramp = curve->value + offset * curve->step;
+    *out = PFXR_LANE_SELECT(curve->step == 0.0f, curve->value, ramp);
+}
+
+// generate_sine in every lane
+static void soa_sine(const soa_uint* phase, soa_float* out) {
+#ifdef PFXR_SINE_FAST
+    soa_int sign_bit = (soa_int)((soa_uint){0} + 0x80000000u);
+    soa_float x = __builtin_convertvector((soa_int)*phase, soa_float) * PFXR_PHASE_TO_CYCLES;
+    soa_float ax = (soa_float)((soa_int)x & ~sign_bit);
+    ax = PFXR_LANE_SELECT(ax > 0.25f, 0.5f - ax, ax);
+    x = PFXR_LANE_SELECT(x < 0.0f, -ax, ax);
+    
+    soa_float x2 = x * x;
+    soa_float p = PFXR_SIN_C7 + x2 * PFXR_SIN_C9;
+    p = PFXR_SIN_C5 + x2 * p;
+    p = PFXR_SIN_C3 + x2 * p;
+    p = PFXR_SIN_C1 + x2 * p;
+    *out = x * p;
+#else
+    soa_int odd = (soa_int)(*phase << 1) >> 31;
+    soa_int within = (soa_int)(*phase & 0x3fffffffu);
+    soa_int ax = (odd & (0x40000000 - within)) | (~odd & within);
+    
+    soa_float t = __builtin_convertvector(0x40000000 - ax, soa_float) * PFXR_PHASE_TO_QUARTERS;
+    soa_float t2 = t * t;
+    soa_float c = PFXR_SIN_K6 + t2 * PFXR_SIN_K8;
+    c = PFXR_SIN_K4 + t2 * c;
+    c = PFXR_SIN_K2 + t2 * c;
+    c = 1.0f + t2 * c;
+    
+    soa_float r = __builtin_convertvector(ax, soa_float) * PFXR_PHASE_TO_RADIANS;
+    soa_float r2 = r * r;
+    soa_float s = PFXR_SIN_S5 + r2 * PFXR_SIN_S7;
+    s = PFXR_SIN_S3 + r2 * s;
+    s = r + (r * r2) * s;
+    
+    soa_float value = PFXR_LANE_SELECT(ax > 0x20000000, c, s);
+    *out = (soa_float)((soa_int)value | (soa_int)(*phase & 0x80000000u));
+#endif
+}
+
+static void soa_lfo_load(soa_lfo_t* lanes, int lane, const pfxr_lfo_t* lfo) {
+    lanes->phase[lane] = lfo->phase;
+    lanes->step[lane] = lfo->step;
+    lanes->from[lane] = lfo->from;
+    lanes->to[lane] = lfo->to;
+}
+
+// LFO values at the given control offset (interval > 1) or every sample
+static void soa_lfo_values(soa_lfo_t* lfo, int interval, int offset, soa_float* out) {
+    if (interval <= 1) {
+        soa_sine(&lfo->phase, out);
+        lfo->phase += lfo->step;
+        return;
+    }
+    
+    if (offset == interval) {
+        lfo->from = lfo->to;
+        lfo->phase += lfo->step * (uint32_t)interval;
+        soa_sine(&lfo->phase, &lfo->to);
+        offset = 0;
+    }
+    *out = lfo->from + (lfo->to - lfo->from) * ((float)offset * (1.0f / (float)interval));
+}
+
+static void soa_biquad_load(soa_biquad_t* lanes, int lane, const pfxr_biquad_t* filter) {
+    lanes->a0[lane] = filter->a0;
+    lanes->a1[lane] = filter->a1;
+    lanes->a2[lane] = filter->a2;
+    lanes->b1[lane] = filter->b1;
+    lanes->b2[lane] = filter->b2;
+}
+
+// One biquad step in every lane where the stage is active
+static void soa_biquad(soa_biquad_t* f, soa_int active, soa_float* samples) {
+    soa_float input = *samples;
+    soa_float output = f->a0 * input + f->a1 * f->x1 + f->a2 * f->x2 - f->b1 * f->y1 - f->b2 * f->y2;
+    f->x2 = f->x1;
+    f->x1 = input;
+    f->y2 = f->y1;
+    f->y1 = output;
+    *samples = PFXR_LANE_SELECT(active, output, input);
+}
+
+// Oscillator phase increments as the generator computes them. Vector units
+// before AVX-512 have no float to 64-bit conversion, so the top bit is
+// split off by hand.
+static void soa_phase_increment(const soa_float* freqs, float sample_rate, float phase_scale, soa_uint* out) {
+    soa_float freq = PFXR_LANE_SELECT(*freqs < sample_rate, *freqs, (soa_float){0} + sample_rate);
+    soa_float increment = PFXR_LANE_SELECT(*freqs > 0.0f, freq * phase_scale, (soa_float){0});
+    
+    soa_int high = increment >= 2147483648.0f;
+    soa_float low = PFXR_LANE_SELECT(high, increment - 2147483648.0f, increment);
+    soa_uint step = (soa_uint)__builtin_convertvector(low, soa_int) + ((soa_uint)high & 0x80000000u);
+    *out = step & (soa_uint)(increment < 4294967296.0f);
+}
+
+// generate_noise_distortion in every lane
+static void soa_noise(soa_uint* noise_seed, soa_float amount, soa_float* samples) {
+    soa_float input = *samples;
+    soa_uint seed = (*noise_seed * 1103515245u + 12345u) & 0x7fffffffu;
+    soa_float rand1 = __builtin_convertvector((soa_int)seed, soa_float) / (float)0x7fffffff;
+    seed = (seed * 1103515245u + 12345u) & 0x7fffffffu;
+    soa_float rand2 = __builtin_convertvector((soa_int)seed, soa_float) / (float)0x7fffffff;
+    *noise_seed = seed;
+    
+    float deg = M_PI / 180.0f;
+    soa_float magnitude = (soa_float)((soa_int)input & 0x7fffffff);
+    soa_float noise_factor = 3.0f + rand1 * amount;
+    soa_float numerator = noise_factor * input * 20.0f * deg;
+    soa_double denominator = M_PI + __builtin_convertvector(rand2 * amount * magnitude, soa_double);
+    soa_float distortion = __builtin_convertvector(__builtin_convertvector(numerator, soa_double) / denominator,
+                                                   soa_float);
+    
+    distortion = PFXR_LANE_SELECT(distortion < -1.0f, (soa_float){0} - 1.0f, distortion);
+    *samples = PFXR_LANE_SELECT(distortion > 1.0f, (soa_float){0} + 1.0f, distortion);
+}
+
+// Plan lanes first..first + PFXR_LANE_WIDTH - 1 with the generator's own
+// setup, then transpose; lanes past count stay silent
+static void soa_setup(soa_state_t* st, const pfxr_sound_soa_t* soa, int first, int count) {
+    pfxr_generator_t gen;
+    
+    memset(st, 0, sizeof(*st));
+    st->sample_rate = render_rate(soa->sample_rate);
+    st->control_interval = soa->control_interval > 0 ? soa->control_interval : PFXR_CONTROL_INTERVAL;
+    if (st->control_interval < 1) st->control_interval = 1;
+    for (int l = 0; l < PFXR_LANE_WIDTH; l++) {
+        pfxr_sound_t config;
+        if (first + l < count) {
+            pfxr_sound_soa_get(soa, first + l, &config);
+            render_generator_init(&gen, &config, soa->sample_rate, soa->control_interval);
+        } else {
+            generator_setup(&gen, NULL, st->sample_rate, 0);
+        }
+        
+        st->total[l] = gen.total_samples;
+        st->wave[l] = gen.config.waveForm;
+        st->active[l] = (int32_t)gen.stages;
+        st->any |= gen.stages;
+        soa_curve_load(&st->envelope, l, gen.envelope, gen.envelope_count);
+        soa_curve_load(&st->pitch, l, gen.pitch, gen.pitch_count);
+        st->phase[l] = gen.phase;
+        soa_lfo_load(&st->vibrato, l, &gen.vibrato);
+        soa_lfo_load(&st->tremolo, l, &gen.tremolo);
+        soa_lfo_load(&st->phaser, l, &gen.phaser);
+        st->noise_seed[l] = gen.noise_seed;
+        st->noise_amount[l] = gen.noise_amount;
+        soa_biquad_load(&st->lowpass, l, &gen.lowpass);
+        soa_biquad_load(&st->highpass, l, &gen.highpass);
+        st->volume[l] = gen.config.volume;
+        st->vibrato_depth[l] = gen.config.vibratoDepth;
+        st->tremolo_depth[l] = gen.config.tremoloDepth;
+        st->phaser_base[l] = gen.config.phaserBaseFrequency;
+        st->phaser_depth[l] = gen.config.phaserDepth;
+    }
+}
+
+static void soa_render(soa_state_t* st, float* const* out, int capacity) {
+    float sample_rate = st->sample_rate;
+    float phase_scale = PFXR_PHASE_SCALE / sample_rate;
+    float history_size = (float)(capacity > 0 ? capacity : 1);
+    int interval = st->control_interval;
+    int lfo_offset = 0;
+    int boundary = 0;
+    int length = 0;
+    for (int l = 0; l < PFXR_LANE_WIDTH; l++) {
+        if (st->total[l] > length) length = st->total[l];
+    }
+    
+    soa_float zero = {0};
+    soa_int sawtooth = st->wave == PFXR_WAVE_SAWTOOTH;
+    soa_int square = st->wave == PFXR_WAVE_SQUARE;
+    soa_int triangle = st->wave == PFXR_WAVE_TRIANGLE;
+    soa_int any_sine = ~(sawtooth | square | triangle);
+    int sine_lanes = 0;
+    for (int l = 0; l < PFXR_LANE_WIDTH; l++) sine_lanes |= any_sine[l];
+    
+    soa_int vibrato_on = (st->active & PFXR_STAGE_VIBRATO) != 0;
+    soa_int noise_on = (st->active & PFXR_STAGE_NOISE) != 0;
+    soa_int lowpass_on = (st->active & PFXR_STAGE_LOWPASS) != 0;
+    soa_int highpass_on = (st->active & PFXR_STAGE_HIGHPASS) != 0;
+    soa_int tremolo_on = (st->active & PFXR_STAGE_TREMOLO) != 0;
+    
+    for (int i = 0; i < length; i++) {
+        soa_float envelopes, freqs, samples, lfo, shape;
+        soa_uint phases, increments;
+        
+        if (i == boundary) {
+            int env_next = soa_curve_advance(&st->envelope, i);
+            int pitch_next = soa_curve_advance(&st->pitch, i);
+            boundary = env_next < pitch_next ? env_next : pitch_next;
+        }
+        
+        soa_curve_values(&st->envelope, i, &envelopes);
+        envelopes = PFXR_LANE_SELECT(envelopes < 0.0f, zero, envelopes);
+        
+        soa_curve_values(&st->pitch, i, &freqs);
+        if (st->any & PFXR_STAGE_VIBRATO) {
+            soa_lfo_values(&st->vibrato, interval, lfo_offset, &lfo);
+            freqs = PFXR_LANE_SELECT(vibrato_on, freqs + lfo * st->vibrato_depth, freqs);
+        }
+        
+        // Oscillator: every waveform from the integer phase, then pick per lane
+        phases = st->phase;
+        soa_phase_increment(&freqs, sample_rate, phase_scale, &increments);
+        st->phase += increments;
+        
+        soa_int folded = (soa_int)phases ^ ((soa_int)phases >> 31);
+        shape = __builtin_convertvector(folded, soa_float) * PFXR_TRIANGLE_SCALE - 1.0f;
+        shape = PFXR_LANE_SELECT(sawtooth, __builtin_convertvector((soa_int)phases, soa_float) * PFXR_SAW_SCALE, shape);
+        shape = PFXR_LANE_SELECT(square, PFXR_LANE_SELECT((soa_int)phases < 0, zero + 1.0f, zero - 1.0f), shape);
+        if (sine_lanes) {
+            soa_float sine;
+            soa_sine(&phases, &sine);
+            shape = PFXR_LANE_SELECT(any_sine, sine, shape);
+        }
+        samples = PFXR_LANE_SELECT(freqs > 0.0f, shape, zero);
+        
+        if (st->any & PFXR_STAGE_NOISE) {
+            soa_float noisy = samples;
+            soa_noise(&st->noise_seed, st->noise_amount, &noisy);
+            samples = PFXR_LANE_SELECT(noise_on, noisy, samples);
+        }
+        
+        // The phaser reads each lane's own earlier output
+        if (st->any & PFXR_STAGE_PHASER) {
+            soa_lfo_values(&st->phaser, interval, lfo_offset, &lfo);
+            soa_float delays = sample_rate / (st->phaser_base + lfo * st->phaser_depth + 1.0f);
+            for (int l = 0; l < PFXR_LANE_WIDTH; l++) {
+                float delay_samples = delays[l];
+                if ((st->active[l] & PFXR_STAGE_PHASER) && delay_samples >= 1.0f &&
+                    delay_samples < (float)(i + 1) && delay_samples < history_size) {
+                    samples[l] += out[l][i - (int)delay_samples] * 0.5f;
+                }
+            }
+        }
+        
+        if (st->any & PFXR_STAGE_LOWPASS) soa_biquad(&st->lowpass, lowpass_on, &samples);
+        if (st->any & PFXR_STAGE_HIGHPASS) soa_biquad(&st->highpass, highpass_on, &samples);
+        
+        soa_float tremolo = zero + 1.0f;
+        if (st->any & PFXR_STAGE_TREMOLO) {
+            soa_lfo_values(&st->tremolo, interval, lfo_offset, &lfo);
+            tremolo = PFXR_LANE_SELECT(tremolo_on, 1.0f - st->tremolo_depth * (1.0f + lfo) * 0.5f, tremolo);
+        }
+        
+        samples = samples * envelopes * tremolo * st->volume;
+        samples = PFXR_LANE_SELECT(samples < -1.0f, zero - 1.0f, samples);
+        samples = PFXR_LANE_SELECT(samples > 1.0f, zero + 1.0f, samples);
+        
+        // Lanes whose sound has ended are masked off
+        for (int l = 0; l < PFXR_LANE_WIDTH; l++) {
+            if (i < st->total[l]) out[l][i] = samples[l];
+        }
+        
+        if (interval > 1) lfo_offset = lfo_offset % interval + 1;
+    }
+}
+#endif
+
+// Render every lane of soa into out[lane] (capacity samples each, NULL for
+// unused lanes) and store each lane's length in sample_counts when given.
+// Returns 0, or -1 without rendering if a sound needs more than capacity.
+int pfxr_render_soa(const pfxr_sound_soa_t* soa, float* const* out, int capacity, int* sample_counts) {
+    if (!soa || !out) return -1;
+    
+    int count = soa->count < PFXR_LANES ? soa->count : PFXR_LANES;
+    for (int l = 0; l < PFXR_LANES; l++) {
+        pfxr_sound_t config;
+        pfxr_sound_soa_get(soa, l, &config);
+        int samples = l < count ? pfxr_sound_sample_count_rate(&config, soa->sample_rate) : 0;
+        if (samples > capacity || (samples > 0 && !out[l])) return -1;
+        if (sample_counts) sample_counts[l] = samples;
+    }
+    
+#ifdef PFXR_LANE_VECTORS
+    for (int first = 0; first < count; first += PFXR_LANE_WIDTH) {
+        soa_state_t st;
+        soa_setup(&st, soa, first, count);
+        soa_render(&st, out + first, capacity);
+    }
+#else
+    for (int l = 0; l < count; l++) {
+        pfxr_sound_t config;
+        pfxr_sound_soa_get(soa, l, &config);
+        pfxr_render_into_interval(&config, soa->sample_rate, soa->control_interval, out[l], capacity);
+    }
+#endif
+    return 0;
+}
+
+// ============================================================================
+// SAMPLE CONVERSION IMPLEMENTATION
+// ============================================================================
+
+// PCM output clamps samples to [-1, 1], NaN going to 1, and scales them to
+// the format's range. Without dither the result is truncated toward zero.
+// With dither, TPDF noise of up to one step either way is added before
+// rounding to nearest. The noise for a sample comes from a hash of the
+// dither key and the sample's index, so vector kernels can compute it for
+// any lane, and output is the same however the samples are split up.
+
+// Bytes per sample of a format, 0 for an unknown format
+int pfxr_sample_size(pfxr_sample_format_t format) {
+    switch (format) {
+        case PFXR_FORMAT_PCM16: return (int)sizeof(int16_t);
+        case PFXR_FORMAT_FLOAT32: return (int)sizeof(float);
+        case PFXR_FORMAT_PCM8: return (int)sizeof(uint8_t);
+        case PFXR_FORMAT_PCM24: return 3;
+    }
+    return 0;
+}
+
+// Largest output step of a PCM format
+static float convert_scale(pfxr_sample_format_t format) {
+    switch (format) {
+        case PFXR_FORMAT_PCM8: return 127.0f;
+        case PFXR_FORMAT_PCM24: return 8388607.0f;
+        default: return 32767.0f;
+    }
+}
+
+// 32-bit integer hash with good avalanche
+static uint32_t dither_hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Triangular noise in steps: the difference of the hash's two 16-bit halves
+static float dither_noise(uint32_t key, uint32_t position) {
+    uint32_t h = dither_hash(key + position);
+    return (float)((int32_t)(h & 0xffff) - (int32_t)(h >> 16)) * (1.0f / 65536.0f);
+}
+
+// Reference kernel: convert n samples to a PCM format, the first being
+// sample number position of the dither stream
+static void convert_block_scalar(const float* samples, void* out, int n, pfxr_sample_format_t format,
+                                 const pfxr_dither_t* dither, uint32_t position) {
+    float scale = convert_scale(format);
+    for (int i = 0; i < n; i++) {
+        float sample = samples[i] < 1.0f ? samples[i] : 1.0f;
+        sample = sample > -1.0f ? sample : -1.0f;
+        sample *= scale;
+        
+        int32_t value;
+        if (dither) {
+            sample += dither_noise(dither->key, position + (uint32_t)i);
+            sample = sample < scale ? sample : scale;
+            sample = sample > -scale ? sample : -scale;
+            value = (int32_t)lrintf(sample);
+        } else {
+            value = (int32_t)sample;
+        }
+        
+        switch (format) {
+            case PFXR_FORMAT_PCM8:
+                ((uint8_t*)out)[i] = (uint8_t)(value + 128);
+                break;
+            case PFXR_FORMAT_PCM24: {
+                unsigned char* bytes = (unsigned char*)out + i * 3;
+                bytes[0] = (unsigned char)value;
+                bytes[1] = (unsigned char)((uint32_t)value >> 8);
+                bytes[2] = (unsigned char)((uint32_t)value >> 16);
+                break;
+            }
+            default:
+                ((int16_t*)out)[i] = (int16_t)value;
+                break;
+        }
+    }
+}
+
+// The vector kernels repeat the scalar operations in the same order, so
+// their output matches the reference bit for bit. Saturating packs narrow
+// the results; the clamps above already keep them in range.
+
+#ifdef PFXR_SIMD_SSE2
+// Low 32 bits of each lane's product (SSE2 has no pmulld)
+static __m128i mullo_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Quantize 4 samples; index holds their positions in the dither stream
+static __m128i quantize_sse2(__m128 x, __m128 scale, const pfxr_dither_t* dither, __m128i index) {
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+    x = _mm_mul_ps(x, scale);
+    if (!dither) return _mm_cvttps_epi32(x);
+    
+    __m128i h = _mm_add_epi32(_mm_set1_epi32((int32_t)dither->key), index);
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    h = mullo_sse2(h, _mm_set1_epi32(0x7feb352d));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo_sse2(h, _mm_set1_epi32((int32_t)0x846ca68bu));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+    __m128i noise = _mm_sub_epi32(_mm_and_si128(h, _mm_set1_epi32(0xffff)), _mm_srli_epi32(h, 16));
+    
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_cvtepi32_ps(noise), _mm_set1_ps(1.0f / 65536.0f)));
+    x = _mm_max_ps(_mm_min_ps(x, scale), _mm_sub_ps(_mm_setzero_ps(), scale));
+    return _mm_cvtps_epi32(x);
+}
+
+// Pack the low 24 bits of each lane into the low 12 bytes
+static __m128i pack_pcm24_sse2(__m128i value) {
+    __m128i low64 = _mm_set_epi32(0, 0, -1, -1);
+    value = _mm_and_si128(value, _mm_set1_epi32(0xffffff));
+    
+    // Each 64-bit half holds two samples in its low 6 bytes, then the upper
+    // half moves down next to the lower one
+    __m128i pairs = _mm_or_si128(_mm_and_si128(value, _mm_set_epi32(0, -1, 0, -1)),
+                                 _mm_slli_epi64(_mm_srli_epi64(value, 32), 24));
+    return _mm_or_si128(_mm_and_si128(pairs, low64), _mm_srli_si128(_mm_andnot_si128(low64, pairs), 2));
+}
+
+static void store_pcm24_sse2(unsigned char* out, __m128i packed) {
+    int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    _mm_storel_epi64((__m128i*)out, packed);
+    memcpy(out + 8, &last, 4);
+}
+
+static void convert_block_sse2(const float* samples, void* out, int n, pfxr_sample_format_t format,
+                               const pfxr_dither_t* dither, uint32_t position) {
+    __m128 scale = _mm_set1_ps(convert_scale(format));
+    __m128i index = _mm_add_epi32(_mm_set1_epi32((int32_t)position), _mm_setr_epi32(0, 1, 2, 3));
+    __m128i step = _mm_set1_epi32(4);
+    int i = 0;
+    
+    switch (format) {
+        case PFXR_FORMAT_PCM16:
+            for (; i + 8 <= n; i += 8) {
+                __m128i a = quantize_sse2(_mm_loadu_ps(samples + i), scale, dither, index);
+                index = _mm_add_epi32(index, step);
+                __m128i b = quantize_sse2(_mm_loadu_ps(samples + i + 4), scale, dither, index);
+                index = _mm_add_epi32(index, step);
+                _mm_storeu_si128((__m128i*)((int16_t*)out + i), _mm_packs_epi32(a, b));
+            }
+            break;
+        case PFXR_FORMAT_PCM8:
+            for (; i + 16 <= n; i += 16) {
+                __m128i q[4];
+                for (int k = 0; k < 4; k++) {
+                    q[k] = quantize_sse2(_mm_loadu_ps(samples + i + k * 4), scale, dither, index);
+                    q[k] = _mm_add_epi32(q[k], _mm_set1_epi32(128));
+                    index = _mm_add_epi32(index, step);
+                }
+                __m128i words = _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+                _mm_storeu_si128((__m128i*)((uint8_t*)out + i), words);
+            }
+            break;
+        case PFXR_FORMAT_PCM24:
+            for (; i + 4 <= n; i += 4) {
+                __m128i q = quantize_sse2(_mm_loadu_ps(samples + i), scale, dither, index);
+                index = _mm_add_epi32(index, step);
+                store_pcm24_sse2((unsigned char*)out + i * 3, pack_pcm24_sse2(q));
+            }
+            break;
+        default:
+            break;
+    }
+    
+    convert_block_scalar(samples + i, (char*)out + i * pfxr_sample_size(format), n - i, format, dither,
+                         position + (uint32_t)i);
+}
+#endif
+
+#ifdef PFXR_SIMD_AVX2
+PFXR_AVX2_FN static __m256i quantize_avx2(__m256 x, __m256 scale, const pfxr_dither_t* dither, __m256i index) {
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(1.0f)), _mm256_set1_ps(-1.0f));
+    x = _mm256_mul_ps(x, scale);
+    if (!dither) return _mm256_cvttps_epi32(x);
+    
+    __m256i h = _mm256_add_epi32(_mm256_set1_epi32((int32_t)dither->key), index);
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7feb352d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int32_t)0x846ca68bu));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    __m256i noise = _mm256_sub_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0xffff)), _mm256_srli_epi32(h, 16));
+    
+    x = _mm256_add_ps(x, _mm256_mul_ps(_mm256_cvtepi32_ps(noise), _mm256_set1_ps(1.0f / 65536.0f)));
+    x = _mm256_max_ps(_mm256_min_ps(x, scale), _mm256_sub_ps(_mm256_setzero_ps(), scale));
+    return _mm256_cvtps_epi32(x);
+}
+
+PFXR_AVX2_FN static void convert_block_avx2(const float* samples, void* out, int n, pfxr_sample_format_t format,
+                                            const pfxr_dither_t* dither, uint32_t position) {
+    __m256 scale = _mm256_set1_ps(convert_scale(format));
+    __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int32_t)position), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i step = _mm256_set1_epi32(8);
+    int i = 0;
+    
+    switch (format) {
+        case PFXR_FORMAT_PCM16:
+            for (; i + 16 <= n; i += 16) {
+                __m256i a = quantize_avx2(_mm256_loadu_ps(samples + i), scale, dither, index);
+                index = _mm256_add_epi32(index, step);
+                __m256i b = quantize_avx2(_mm256_loadu_ps(samples + i + 8), scale, dither, index);
+                index = _mm256_add_epi32(index, step);
+                // Packs work within 128-bit lanes, so put the quarters back in order
+                __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256((__m256i*)((int16_t*)out + i), words);
+            }
+            break;
+        case PFXR_FORMAT_PCM8:
+            for (; i + 32 <= n; i += 32) {
+                __m256i q[4];
+                for (int k = 0; k < 4; k++) {
+                    q[k] = quantize_avx2(_mm256_loadu_ps(samples + i + k * 8), scale, dither, index);
+                    q[k] = _mm256_add_epi32(q[k], _mm256_set1_epi32(128));
+                    index = _mm256_add_epi32(index, step);
+                }
+                __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(q[0], q[1]), _mm256_packs_epi32(q[2], q[3]));
+                bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+                _mm256_storeu_si256((__m256i*)((uint8_t*)out + i), bytes);
+            }
+            break;
+        case PFXR_FORMAT_PCM24:
+            for (; i + 8 <= n; i += 8) {
+                __m256i q = quantize_avx2(_mm256_loadu_ps(samples + i), scale, dither, index);
+                index = _mm256_add_epi32(index, step);
+                unsigned char* bytes = (unsigned char*)out + i * 3;
+                store_pcm24_sse2(bytes, pack_pcm24_sse2(_mm256_castsi256_si128(q)));
+                store_pcm24_sse2(bytes + 12, pack_pcm24_sse2(_mm256_extracti128_si256(q, 1)));
+            }
+            break;
+        default:
+            break;
+    }
+    
+    // Clear the upper halves before running SSE code, which stalls otherwise
+    _mm256_zeroupper();
+    convert_block_sse2(samples + i, (char*)out + i * pfxr_sample_size(format), n - i, format, dither,
+                       position + (uint32_t)i);
+}
+#endif
+
+// Convert a block of samples to a PCM format with the best kernel for this CPU
+static void convert_block(const float* samples, void* out, int n, pfxr_sample_format_t format,
+                          const pfxr_dither_t* dither, uint32_t position) {
+#if defined(PFXR_SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        convert_block_avx2(samples, out, n, format, dither, position);
+        return;
+    }
+#endif
+#if defined(PFXR_SIMD_SSE2)
+    convert_block_sse2(samples, out, n, format, dither, position);
+#else
+    convert_block_scalar(samples, out, n, format, dither, position);
+#endif
+}
+
+// Start a dither stream; the same seed always gives the same noise
+void pfxr_dither_init(pfxr_dither_t* dither, uint32_t seed) {
+    if (!dither) return;
+    dither->key = dither_hash(seed);
+    dither->position = 0;
+}
+
+// Convert float samples to a format: PCM is clamped to [-1, 1] and scaled
+// like 16-bit output, float is copied unchanged
+void pfxr_convert_samples(const float* samples, void* out, int count, pfxr_sample_format_t format) {
+    pfxr_convert_samples_dither(samples, out, count, format, NULL);
+}
+
+// Convert with TPDF dither on PCM formats (none when dither is NULL). The
+// stream advances by count samples, so consecutive calls continue it.
+void pfxr_convert_samples_dither(const float* samples, void* out, int count, pfxr_sample_format_t format,
+                                 pfxr_dither_t* dither) {
+    if (!samples || !out || count <= 0) return;
+    
+    if (format == PFXR_FORMAT_FLOAT32) {
+        if (out != samples) memcpy(out, samples, (size_t)count * sizeof(float));
+    } else if (pfxr_sample_size(format)) {
+        convert_block(samples, out, count, format, dither, dither ? dither->position : 0);
+    }
+    if (dither) dither->position += (uint32_t)count;
+}
+
+// ============================================================================
+// WAV FILE IMPLEMENTATION
+// ============================================================================
+
+// Samples rendered per chunk when writing WAV data directly
+#define PFXR_RENDER_CHUNK 256
+
+// Size of the WAV header written for a format, 0 for an unknown format
+int pfxr_wav_header_size(pfxr_sample_format_t format) {
+    if (!pfxr_sample_size(format)) return 0;
+    return format == PFXR_FORMAT_FLOAT32 ? (int)sizeof(pfxr_wav_float_header_t) : (int)sizeof(pfxr_wav_header_t);
+}
+
+// Size of a WAV file, including the pad byte RIFF puts after odd-sized data
+static int wav_file_size(int sample_count, pfxr_sample_format_t format) {
+    int data_size = sample_count * pfxr_sample_size(format);
+    return pfxr_wav_header_size(format) + data_size + (data_size & 1);
+}
+
+// Fill in a mono WAV header for sample_count samples of a known format,
+// returns its size
+static int fill_wav_header(void* out, int sample_count, int sample_rate, pfxr_sample_format_t format) {
+    int header_size = pfxr_wav_header_size(format);
+    int data_size = sample_count * pfxr_sample_size(format);
+    int file_size = wav_file_size(sample_count, format);
+    
+    // RIFF header
+    pfxr_wav_header_t* header = (pfxr_wav_header_t*)out;
+    memcpy(header->riff, "RIFF", 4);
+    header->chunk_size = file_size - 8;
+    memcpy(header->wave, "WAVE", 4);
+    
+    // Format chunk
+    memcpy(header->fmt, "fmt ", 4);
+    header->fmt_size = 16;
+    header->audio_format = 1;  // PCM
+    header->num_channels = 1;  // Mono
+    header->sample_rate = sample_rate;
+    header->bits_per_sample = pfxr_sample_size(format) * 8;
+    header->block_align = header->num_channels * header->bits_per_sample / 8;
+    header->byte_rate = header->sample_rate * header->block_align;
+    
+    // Float data needs the extended format chunk and a fact chunk
+    if (format == PFXR_FORMAT_FLOAT32) {
+        pfxr_wav_float_header_t* extended = (pfxr_wav_float_header_t*)out;
+        extended->fmt_size = 18;
+        extended->audio_format = 3;  // IEEE float
+        extended->extension_size = 0;
+        memcpy(extended->fact, "fact", 4);
+        extended->fact_size = 4;
+        extended->sample_length = sample_count;
+        memcpy(extended->data, "data", 4);
+        extended->data_size = data_size;
+        return header_size;
+    }
+    
+    // Data chunk
+    memcpy(header->data, "data", 4);
+    header->data_size = data_size;
+    return header_size;
+}
+
+// Fill in the header of a whole WAV file at out, and its pad byte
+static int write_wav_header(void* out, int sample_count, int sample_rate, pfxr_sample_format_t format) {
+    int file_size = wav_file_size(sample_count, format);
+    if ((sample_count * pfxr_sample_size(format)) & 1) {
+        ((char*)out)[file_size - 1] = 0;
+    }
+    return fill_wav_header(out, sample_count, sample_rate, format);
+}
+
+// Write a WAV header for a format into out (pfxr_wav_header_size bytes),
+// returns its size or 0 for an unknown format. Data of an odd byte count
+// must be followed by a zero pad byte, which the RIFF size counts.
+int pfxr_write_wav_header(void* out, int sample_count, int sample_rate, pfxr_sample_format_t format) {
+    if (!out || sample_count < 0 || !pfxr_sample_size(format)) return 0;
+    return fill_wav_header(out, sample_count, (int)render_rate(sample_rate), format);
+}
+
+// Write a block of bytes to a new file
+static int write_file(const char* filename, const char* data, int size) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        return -1;
+    }
+    
+    size_t written = fwrite(data, 1, size, file);
+    fclose(file);
+    
+    return (written == (size_t)size) ? 0 : -1;
+}
+
+// Allocate WAV data for samples rendered at sample_rate
+static char* create_wav_data(pfxr_context_t* ctx, const float* samples, int sample_count,
+                             int sample_rate, pfxr_sample_format_t format, int* wav_size) {
+    int sample_size = pfxr_sample_size(format);
+    if (!samples || sample_count <= 0 || !wav_size || !sample_size) {
+        return NULL;
+    }
+    
+    // Calculate sizes
+    int header_size = pfxr_wav_header_size(format);
+    if (sample_count > (INT32_MAX - header_size - 1) / sample_size) {
+        return NULL;
+    }
+    int file_size = wav_file_size(sample_count, format);
+    
+    // Allocate memory for WAV data
+    char* wav_data = pfxr_context_alloc(ctx, file_size);
+    if (!wav_data) {
+        return NULL;
+    }
+    
+    write_wav_header(wav_data, sample_count, sample_rate, format);
+    pfxr_convert_samples(samples, wav_data + header_size, sample_count, format);
+    
+    *wav_size = file_size;
+    return wav_data;
+}
+
+// Create WAV data from float samples
+char* pfxr_create_wav_data(const float* samples, int sample_count, int* wav_size) {
+    return create_wav_data(NULL, samples, sample_count, PFXR_SAMPLE_RATE, PFXR_FORMAT_PCM16, wav_size);
+}
+
+char* pfxr_create_wav_data_ctx(pfxr_context_t* ctx, const float* samples, int sample_count, int* wav_size) {
+    return create_wav_data(ctx, samples, sample_count, PFXR_SAMPLE_RATE, PFXR_FORMAT_PCM16, wav_size);
+}
+
+// Create WAV data for samples rendered at sample_rate
+char* pfxr_create_wav_data_rate(const float* samples, int sample_count, int sample_rate, int* wav_size) {
+    return create_wav_data(NULL, samples, sample_count, (int)render_rate(sample_rate), PFXR_FORMAT_PCM16, wav_size);
+}
+
+// Create WAV data in a sample format
+char* pfxr_create_wav_data_format(const float* samples, int sample_count, int sample_rate,
+                                  pfxr_sample_format_t format, int* wav_size) {
+    return create_wav_data(NULL, samples, sample_count, (int)render_rate(sample_rate), format, wav_size);
+}
+
+// Write WAV file to disk
+int pfxr_write_wav_file(const char* filename, const float* samples, int sample_count) {
+    if (!filename || !samples || sample_count <= 0) {
+        return -1;
+    }
+    
+    int wav_size;
+    char* wav_data = pfxr_create_wav_data(samples, sample_count, &wav_size);
+    if (!wav_data) {
+        return -1;
+    }
+    
+    int result = write_file(filename, wav_data, wav_size);
+    PFXR_FREE(wav_data);
+    
+    return result;
+}
+
+// Free WAV data allocated by pfxr_create_wav_data
+void pfxr_free_wav_data(char* wav_data) {
+    if (wav_data) {
+        PFXR_FREE(wav_data);
+    }
+}
+
+// ============================================================================
+// URL IMPLEMENTATION
+// ============================================================================
+
+// Helper function to set sound field by index
+static void set_sound_field(pfxr_sound_t* sound, int index, float value) {
+    switch (index) {
+        case 0: sound->waveForm = (int)value; break;
+        case 1: sound->volume = value; break;
+        case 2: sound->attackTime = value; break;
+        case 3: sound->sustainTime = value; break;
+        case 4: sound->sustainPunch = value; break;
+        case 5: sound->decayTime = value; break;
+        case 6: sound->frequency = value; break;
+        case 7: sound->pitchDelta = value; break;
+        case 8: sound->pitchDuration = value; break;
+        case 9: sound->pitchDelay = value; break;
+        case 10: sound->vibratoRate = value; break;
+        case 11: sound->vibratoDepth = value; break;
+        case 12: sound->tremoloRate = value; break;
+        case 13: sound->tremoloDepth = value; break;
+        case 14: sound->highPassCutoff = value; break;
+        case 15: sound->highPassResonance = value; break;
+        case 16: sound->lowPassCutoff = value; break;
+        case 17: sound->lowPassResonance = value; break;
+        case 18: sound->phaserBaseFrequency = value; break;
+        case 19: sound->phaserLfoFrequency = value; break;
+        case 20: sound->phaserDepth = value; break;
+        case 21: sound->noiseAmount = value; break;
+        default: break; // Ignore unknown indices
+    }
+}
+
+// Helper function to get sound field by index
+static float get_sound_field(const pfxr_sound_t* sound, int index) {
+    switch (index) {
+        case 0: return (float)sound->waveForm;
+        case 1: return sound->volume;
+        case 2: return sound->attackTime;
+        case 3: return sound->sustainTime;
+        case 4: return sound->sustainPunch;
+        case 5: return sound->decayTime;
+        case 6: return sound->frequency;
+        case 7: return sound->pitchDelta;
+        case 8: return sound->pitchDuration;
+        case 9: return sound->pitchDelay;
+        case 10: return sound->vibratoRate;
+        case 11: return sound->vibratoDepth;
+        case 12: return sound->tremoloRate;
+        case 13: return sound->tremoloDepth;
+        case 14: return sound->highPassCutoff;
+        case 15: return sound->highPassResonance;
+        case 16: return sound->lowPassCutoff;
+        case 17: return sound->lowPassResonance;
+        case 18: return sound->phaserBaseFrequency;
+        case 19: return sound->phaserLfoFrequency;
+        case 20: return sound->phaserDepth;
+        case 21: return sound->noiseAmount;
+        default: return 0.0f;
+    }
+}
+
+// Number of fields in the sound structure
+#define PFXR_FIELD_COUNT 22
+
+pfxr_sound_t* pfxr_create_params_from_url(const char* url) {
+    return pfxr_create_params_from_url_ctx(NULL, url);
+}
+
+pfxr_sound_t* pfxr_create_params_from_url_ctx(pfxr_context_t* ctx, const char* url) {
+    if (!url) return NULL;
+
+    pfxr_sound_t* sound = pfxr_context_alloc(ctx, sizeof(pfxr_sound_t));
+    if (!sound) return NULL;
+
+    // Malformed fields keep their defaults
+    pfxr_url_parse(url, sound);
+    return sound;
+}
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Plain decimals ("440", "-0.07") whose digits fit in 24 bits convert with
+// one exact float multiply or divide, which rounds the same as strtof.
+// Returns the end of the number, or NULL to leave anything else, such as
+// "1e3", "0x10" or "1.5x", to strtof.
+static const char* parse_decimal_fast(const char* str, float* value) {
+    static const float powers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    const char* p = str;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+    
+    uint32_t mantissa = 0;
+    int digits = 0;
+    int decimals = -1;
+    for (;; p++) {
+        if (*p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+            if (mantissa > (1u << 24) || ++digits > 10) return NULL;
+            if (decimals >= 0) decimals++;
+        } else if (*p == '.' && decimals < 0) {
+            decimals = 0;
+        } else {
+            break;
+        }
+    }
+    if (digits == 0 || *p != '\0') return NULL;
+    
+    float result = (float)mantissa;
+    if (decimals > 0) result /= powers[decimals];
+    *value = negative ? -result : result;
+    return p;
+}
+
+// Parse one decoded field into the config, returns 0 or -1 if malformed.
+// Blank fields keep their default.
+static int parse_url_field(pfxr_sound_t* config, int index, char* token, int length) {
+    if (length > PFXR_URL_FIELD_LENGTH) return -1;
+    while (length > 0 && token[length - 1] == ' ') length--;
+    token[length] = '\0';
+    
+    char* start = token;
+    while (*start == ' ') start++;
+    if (*start == '\0') return 0;
+    
+    float value;
+    const char* end = parse_decimal_fast(start, &value);
+    if (!end) {
+        char* strtof_end;
+        value = strtof(start, &strtof_end);
+        end = strtof_end == start ? NULL : strtof_end;
+    }
+    if (!end || *end != '\0') return -1;
+    if (index == 0 && !(value > -2147483648.0f && value < 2147483648.0f)) return -1;
+    
+    set_sound_field(config, index, value);
+    return 0;
+}
+
+// Parse the fx= query parameter of url into config, in one pass and
+// without allocating. Fields missing from the URL, and malformed ones,
+// keep their defaults; parsing carries on past a bad field and the first
+// problem is returned. Safe to call from any number of threads.
+pfxr_url_error_t pfxr_url_parse(const char* url, pfxr_sound_t* config) {
+    if (!config) return PFXR_URL_NO_FX;
+    *config = pfxr_get_default_sound();
+    if (!url) return PFXR_URL_NO_FX;
+    
+    // Find a parameter named exactly fx among the query parameters
+    size_t i = 0;
+    while (url[i] && url[i] != '?' && url[i] != '#') {
+        if (++i >= PFXR_URL_MAX_LENGTH) return PFXR_URL_TOO_LONG;
+    }
+    int found = 0;
+    while (!found && (url[i] == '?' || url[i] == '&')) {
+        i++;
+        if (url[i] == 'f' && url[i + 1] == 'x' && url[i + 2] == '=') {
+            i += 3;
+            found = 1;
+            break;
+        }
+        while (url[i] && url[i] != '&' && url[i] != '#') {
+            if (++i >= PFXR_URL_MAX_LENGTH) return PFXR_URL_TOO_LONG;
+        }
+    }
+    if (!found) return PFXR_URL_NO_FX;
+    
+    // Decode escapes into a small token buffer, one field at a time
+    char token[PFXR_URL_FIELD_LENGTH + 1];
+    int length = 0;
+    int field = 0;
+    pfxr_url_error_t result = PFXR_URL_OK;
+    for (;;) {
+        int c = (unsigned char)url[i];
+        if (c == '\0' || c == '&' || c == '#') {
+            if (field < PFXR_FIELD_COUNT && parse_url_field(config, field, token, length) != 0 &&
+                result == PFXR_URL_OK) {
+                result = PFXR_URL_BAD_NUMBER;
+            }
+            break;
+        }
+        if (++i >= PFXR_URL_MAX_LENGTH) return PFXR_URL_TOO_LONG;
+        
+        if (c == '%') {
+            int high = hex_value((unsigned char)url[i]);
+            int low = high < 0 ? -1 : hex_value((unsigned char)url[i + 1]);
+            if (low < 0) {
+                if (result == PFXR_URL_OK) result = PFXR_URL_BAD_ESCAPE;
+            } else {
+                c = high * 16 + low;
+                i += 2;
+            }
+        } else if (c == '+') {
+            c = ' ';
+        }
+        
+        if (c == ',') {
+            if (field < PFXR_FIELD_COUNT && parse_url_field(config, field, token, length) != 0 &&
+                result == PFXR_URL_OK) {
+                result = PFXR_URL_BAD_NUMBER;
+            }
+            field++;
+            length = 0;
+        } else {
+            // Fields too long for any number are counted but not stored
+            if (length < PFXR_URL_FIELD_LENGTH) token[length] = (char)c;
+            length++;
+        }
+    }
+    return result;
+}
+
+// Powers of ten for picking candidate digits. Those past 1e22 are rounded,
+// which can only cost a digit: every candidate is checked before use.
+static const double url_double_powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31,
+    1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39, 1e40, 1e41, 1e42, 1e43, 1e44, 1e45, 1e46, 1e47,
+    1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55, 1e56, 1e57, 1e58, 1e59, 1e60, 1e61, 1e62, 1e63
+};
+
+// Write the decimal digits of value, returns how many
+static int format_digits(uint64_t value, char* out) {
+    char reversed[20];
+    int count = 0;
+    do {
+        reversed[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = 0; i < count; i++) out[i] = reversed[count - 1 - i];
+    return count;
+}
+
+// Does mantissa * 10^exponent read back as exactly value? Within double
+// range the product is one correctly rounded operation, and rounding that
+// to float matches strtof unless it lands on a float midpoint; those, and
+// exponents past the exact powers, go through strtof.
+static int decimal_reads_as(float value, uint64_t mantissa, int exponent) {
+    if (mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22) {
+        double result = (double)mantissa;
+        if (exponent < 0) result /= url_double_powers[-exponent];
+        else result *= url_double_powers[exponent];
+        float rounded = (float)result;
+        uint32_t bits;
+        memcpy(&bits, &rounded, sizeof(bits));
+        bits = result > rounded ? bits + 1 : bits - 1;
+        float other;
+        memcpy(&other, &bits, sizeof(other));
+        if (fabs(result - rounded) != fabs(other - result)) return rounded == value;
+    }
+    char text[32];
+    int length = format_digits(mantissa, text);
+    text[length++] = 'e';
+    if (exponent < 0) {
+        text[length++] = '-';
+        exponent = -exponent;
+    }
+    length += format_digits((uint64_t)exponent, text + length);
+    text[length] = '\0';
+    return strtof(text, NULL) == value;
+}
+
+// Write the shortest decimal that reads back as exactly value: plain
+// notation from 1e-6 up to 1e21, an exponent outside that (like
+// JavaScript, without the '+'). Returns the length; out needs 24 bytes.
+static int format_float(float value, char* out) {
+    char* p = out;
+    if (value != value) {
+        memcpy(p, "nan", 3);
+        return 3;
+    }
+    if (signbit(value)) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(p, "inf", 3);
+        return (int)(p - out) + 3;
+    }
+    if (value == 0.0f) {
+        *p++ = '0';
+        return (int)(p - out);
+    }
+    
+    // Find the fewest significant digits that read back; nine always do,
+    // and rounding to more digits never stops a value reading back. The
+    // exponent estimate may be one low, which only adds a digit.
+    double d = value;
+    int binary_exponent;
+    frexp(d, &binary_exponent);
+    int estimate = (int)floor((binary_exponent - 1) * 0.30102999566398120);
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int low = 1, high = 9;
+    for (;;) {
+        int digits = low == high ? high : (low + high) / 2;
+        exponent = estimate - digits + 1;
+        double scaled = exponent <= 0 ? d * url_double_powers[-exponent] : d / url_double_powers[exponent];
+        mantissa = (uint64_t)(scaled + 0.5);
+        if (low == high) break;
+        if (mantissa > 0 && decimal_reads_as(value, mantissa, exponent)) high = digits;
+        else low = digits + 1;
+    }
+    while (mantissa % 10 == 0) {
+        mantissa /= 10;
+        exponent++;
+    }
+    
+    char digits[20];
+    int count = format_digits(mantissa, digits);
+    int point = exponent + count;    // Digits before the decimal point
+    if (point > 21 || point < -5) {
+        *p++ = digits[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, count - 1);
+            p += count - 1;
+        }
+        *p++ = 'e';
+        int e = point - 1;
+        if (e < 0) {
+            *p++ = '-';
+            e = -e;
+        }
+        p += format_digits((uint64_t)e, p);
+    } else if (point <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -point);
+        p += -point;
+        memcpy(p, digits, count);
+        p += count;
+    } else if (point >= count) {
+        memcpy(p, digits, count);
+        memset(p + count, '0', point - count);
+        p += point;
+    } else {
+        memcpy(p, digits, point);
+        p += point;
+        *p++ = '.';
+        memcpy(p, digits + point, count - point);
+        p += count - point;
+    }
+    return (int)(p - out);
+}
+
+// Encode config as "?fx=" and its fields separated by escaped commas, in
+// one pass. out needs PFXR_URL_WRITE_MAX bytes; returns the length, which
+// is exactly what gets written (no terminator).
+static int url_encode_sound(const pfxr_sound_t* config, char* out) {
+    char* p = out;
+    memcpy(p, "?fx=", 4);
+    p += 4;
+    
+    int wave = config->waveForm;
+    if (wave < 0) *p++ = '-';
+    p += format_digits(wave < 0 ? 0u - (uint64_t)(int64_t)wave : (uint64_t)wave, p);
+    for (int i = 1; i < PFXR_FIELD_COUNT; i++) {
+        memcpy(p, "%2C", 3);
+        p += 3 + format_float(get_sound_field(config, i), p + 3);
+    }
+    return (int)(p - out);
+}
+
+// Write the "?fx=" query for a configuration into a caller buffer. Floats
+// are written in their shortest form that parses back to the same value.
+int pfxr_url_write(const pfxr_sound_t* config, char* out, int capacity) {
+    if (!config) return 0;
+    
+    // Encode straight into out when it has room for any config
+    char scratch[PFXR_URL_WRITE_MAX];
+    char* target = out && capacity >= PFXR_URL_WRITE_MAX ? out : scratch;
+    int length = url_encode_sound(config, target);
+    if (!out || length + 1 > capacity) return length + 1;
+    
+    if (target != out) memcpy(out, scratch, length);
+    out[length] = '\0';
+    return length + 1;
+}
+
+// Write the queries for count configurations into out, each followed by a
+// newline, then a terminator. Returns the size needed like pfxr_url_write,
+// or 0 when that does not fit in an int.
+int pfxr_url_write_batch(const pfxr_sound_t* configs, int count, char* out, int capacity) {
+    if (!configs || count < 0) return 0;
+    
+    // Buffers with room for the worst case are filled in one pass; others
+    // are measured first so that nothing is written unless it all fits
+    if (!out || capacity < 1 || (size_t)count > (size_t)(capacity - 1) / PFXR_URL_WRITE_MAX) {
+        char scratch[PFXR_URL_WRITE_MAX];
+        size_t size = 1;
+        for (int i = 0; i < count; i++) {
+            size += (size_t)url_encode_sound(&configs[i], scratch) + 1;
+            if (size > INT32_MAX) return 0;
+        }
+        if (!out || size > (size_t)capacity) return (int)size;
+    }
+    
+    char* p = out;
+    for (int i = 0; i < count; i++) {
+        p += url_encode_sound(&configs[i], p);
+        *p++ = '\n';
+    }
+    *p = '\0';
+    return (int)(p - out) + 1;
+}
+
+char* pfxr_get_url_from_params(const pfxr_sound_t* config) {
+    return pfxr_get_url_from_params_ctx(NULL, config);
+}
+
+char* pfxr_get_url_from_params_ctx(pfxr_context_t* ctx, const pfxr_sound_t* config) {
+    if (!config) return NULL;
+    
+    char scratch[PFXR_URL_WRITE_MAX];
+    int length = url_encode_sound(config, scratch);
+    char* url_buffer = pfxr_context_alloc(ctx, length + 1);
+    if (!url_buffer) return NULL;
+    
+    memcpy(url_buffer, scratch, length);
+    url_buffer[length] = '\0';
+    return url_buffer;
+}
+
+void pfxr_free_sound_config(pfxr_sound_t* config) {
+    if (config) {
+        PFXR_FREE(config);
+    }
+}
+
+// ============================================================================
+// BINARY ENCODING
+// ============================================================================
+
+// Lossless: the tag byte, waveForm as 24-bit two's complement, then the 21
+// float fields as raw little-endian bits. Quantized: the tag byte, then a
+// little-endian bit stream of waveForm in 2 bits and each float field in
+// turn, zero-padded to a whole byte.
+
+// Float fields in struct order, with the range PFXR_TEMPLATE_RANDOM draws
+// each from and its quantized width. Pitches and cutoffs get 12 bits.
+typedef struct {
+    size_t offset;
+    float min;
+    float max;
+    int bits;
+} codec_field_t;
+
+static const codec_field_t codec_fields[PFXR_FIELD_COUNT - 1] = {
+    { offsetof(pfxr_sound_t, volume), 0.0f, 1.0f, 10 },
+    { offsetof(pfxr_sound_t, attackTime), 0.0f, 2.0f, 10 },
+    { offsetof(pfxr_sound_t, sustainTime), 0.0f, 2.0f, 10 },
+    { offsetof(pfxr_sound_t, sustainPunch), 0.0f, 1.0f, 10 },
+    { offsetof(pfxr_sound_t, decayTime), 0.0f, 2.0f, 10 },
+    { offsetof(pfxr_sound_t, frequency), 0.0f, 4000.0f, 12 },
+    { offsetof(pfxr_sound_t, pitchDelta), -4000.0f, 4000.0f, 12 },
+    { offsetof(pfxr_sound_t, pitchDuration), 0.0f, 1.0f, 10 },
+    { offsetof(pfxr_sound_t, pitchDelay), 0.0f, 1.0f, 10 },
+    { offsetof(pfxr_sound_t, vibratoRate), 0.0f, 70.0f, 10 },
+    { offsetof(pfxr_sound_t, vibratoDepth), 0.0f, 100.0f, 10 },
+    { offsetof(pfxr_sound_t, tremoloRate), 0.0f, 70.0f, 10 },
+    { offsetof(pfxr_sound_t, tremoloDepth), 0.0f, 1.0f, 10 },
+    { offsetof(pfxr_sound_t, highPassCutoff), 0.0f, 4000.0f, 12 },
+    { offsetof(pfxr_sound_t, highPassResonance), 0.0f, 30.0f, 10 },
+    { offsetof(pfxr_sound_t, lowPassCutoff), 0.0f, 4000.0f, 12 },
+    { offsetof(pfxr_sound_t, lowPassResonance), 0.0f, 30.0f, 10 },
+    { offsetof(pfxr_sound_t, phaserBaseFrequency), 0.0f, 1000.0f, 10 },
+    { offsetof(pfxr_sound_t, phaserLfoFrequency), 0.0f, 200.0f, 10 },
+    { offsetof(pfxr_sound_t, phaserDepth), 0.0f, 1000.0f, 10 },
+    { offsetof(pfxr_sound_t, noiseAmount), 0.0f, 500.0f, 10 }
+};
+
+#define PFXR_CODEC_WAVE_BITS 2
+#define PFXR_CODEC_WAVE_LIMIT (1 << 23)
+
+static int codec_size(pfxr_codec_mode_t mode) {
+    switch (mode) {
+        case PFXR_CODEC_LOSSLESS: return PFXR_CODEC_LOSSLESS_SIZE;
+        case PFXR_CODEC_QUANTIZED: return PFXR_CODEC_QUANTIZED_SIZE;
+        default: return 0;
+    }
+}
+
+// Can config be encoded in mode? Only lossless limits waveForm
+static int codec_accepts(const pfxr_sound_t* config, pfxr_codec_mode_t mode) {
+    if (mode == PFXR_CODEC_LOSSLESS) {
+        return config->waveForm >= -PFXR_CODEC_WAVE_LIMIT && config->waveForm < PFXR_CODEC_WAVE_LIMIT;
+    }
+    return mode == PFXR_CODEC_QUANTIZED;
+}
+
+// Codes run from 0 to an even step count, so the middle of a signed range
+// (no pitch change) is exact; the all-ones code is never written
+static uint32_t quantize_field(float value, const codec_field_t* field) {
+    uint32_t steps = (1u << field->bits) - 2;
+    if (!(value > field->min)) return 0;
+    if (value >= field->max) return steps;
+    return (uint32_t)(((double)value - field->min) / ((double)field->max - field->min) * steps + 0.5);
+}
+
+static float dequantize_field(uint32_t code, const codec_field_t* field) {
+    uint32_t steps = (1u << field->bits) - 2;
+    return (float)(field->min + ((double)field->max - field->min) * code / steps);
+}
+
+static void encode_sound(const pfxr_sound_t* config, pfxr_codec_mode_t mode, unsigned char* out) {
+    out[0] = (unsigned char)(PFXR_CODEC_VERSION << 4 | mode);
+    const char* base = (const char*)config;
+    
+    if (mode == PFXR_CODEC_LOSSLESS) {
+        uint32_t wave = (uint32_t)config->waveForm;
+        out[1] = (unsigned char)wave;
+        out[2] = (unsigned char)(wave >> 8);
+        out[3] = (unsigned char)(wave >> 16);
+        for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+            uint32_t bits;
+            memcpy(&bits, base + codec_fields[i].offset, sizeof(bits));
+            unsigned char* p = out + 4 + i * 4;
+            p[0] = (unsigned char)bits;
+            p[1] = (unsigned char)(bits >> 8);
+            p[2] = (unsigned char)(bits >> 16);
+            p[3] = (unsigned char)(bits >> 24);
+        }
+        return;
+    }
+    
+    // Waveforms outside 0..3 render as a sine, the same as 0
+    int wave = config->waveForm >= 0 && config->waveForm <= 3 ? config->waveForm : 0;
+    uint64_t pending = (uint64_t)wave;
+    int pending_bits = PFXR_CODEC_WAVE_BITS;
+    unsigned char* p = out + 1;
+    for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+        float value;
+        memcpy(&value, base + codec_fields[i].offset, sizeof(value));
+        pending |= (uint64_t)quantize_field(value, &codec_fields[i]) << pending_bits;
+        pending_bits += codec_fields[i].bits;
+        while (pending_bits >= 8) {
+            *p++ = (unsigned char)pending;
+            pending >>= 8;
+            pending_bits -= 8;
+        }
+    }
+    if (pending_bits > 0) *p = (unsigned char)pending;
+}
+
+// Encode config into out, returns the size the encoding needs (nothing is
+// written when that is larger than capacity), or 0 when config cannot be
+// encoded in mode: lossless needs waveForm to fit in 24 bits.
+int pfxr_sound_encode(const pfxr_sound_t* config, pfxr_codec_mode_t mode, void* out, int capacity) {
+    int size = codec_size(mode);
+    if (!config || size == 0 || !codec_accepts(config, mode)) return 0;
+    if (!out || size > capacity) return size;
+    
+    encode_sound(config, mode, out);
+    return size;
+}
+
+// Decode one encoding from the start of data, returns the bytes it took, or
+// 0 when data does not start with a complete encoding of a known version.
+// config is left alone on failure.
+int pfxr_sound_decode(const void* data, int size, pfxr_sound_t* config) {
+    const unsigned char* in = data;
+    if (!in || !config || size < 1 || in[0] >> 4 != PFXR_CODEC_VERSION) return 0;
+    pfxr_codec_mode_t mode = (pfxr_codec_mode_t)(in[0] & 15);
+    int needed = codec_size(mode);
+    if (needed == 0 || size < needed) return 0;
+    
+    pfxr_sound_t result;
+    char* base = (char*)&result;
+    if (mode == PFXR_CODEC_LOSSLESS) {
+        uint32_t wave = (uint32_t)in[1] | (uint32_t)in[2] << 8 | (uint32_t)in[3] << 16;
+        result.waveForm = (int)wave - (wave & 0x800000u ? 1 << 24 : 0);
+        for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+            const unsigned char* p = in + 4 + i * 4;
+            uint32_t bits = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+            memcpy(base + codec_fields[i].offset, &bits, sizeof(bits));
+        }
+    } else {
+        const unsigned char* p = in + 1;
+        uint64_t pending = 0;
+        int pending_bits = 0;
+        while (pending_bits < PFXR_CODEC_WAVE_BITS) {
+            pending |= (uint64_t)*p++ << pending_bits;
+            pending_bits += 8;
+        }
+        result.waveForm = (int)(pending & ((1u << PFXR_CODEC_WAVE_BITS) - 1));
+        pending >>= PFXR_CODEC_WAVE_BITS;
+        pending_bits -= PFXR_CODEC_WAVE_BITS;
+        for (int i = 0; i < PFXR_FIELD_COUNT - 1; i++) {
+            const codec_field_t* field = &codec_fields[i];
+            while (pending_bits < field->bits) {
+                pending |= (uint64_t)*p++ << pending_bits;
+                pending_bits += 8;
+            }
+            uint32_t code = (uint32_t)(pending & ((1u << field->bits) - 1));
+            if (code > (1u << field->bits) - 2) return 0;
+            float value = dequantize_field(code, field);
+            memcpy(base + field->offset, &value, sizeof(value));
+            pending >>= field->bits;
+            pending_bits -= field->bits;
+        }
+        if (pending != 0) return 0;    // Padding must be zero
+    }
+    
+    *config = result;
+    return needed;
+}
+
+// Encode count configs back to back. Returns the total size like
+// pfxr_sound_encode, or 0 if any config cannot be encoded.
+int pfxr_sound_encode_batch(const pfxr_sound_t* configs, int count, pfxr_codec_mode_t mode,
+                            void* out, int capacity) {
+    int size = codec_size(mode);
+    if (!configs || count < 0 || size == 0 || count > INT32_MAX / size) return 0;
+    for (int i = 0; i < count; i++) {
+        if (!codec_accepts(&configs[i], mode)) return 0;
+    }
+    if (!out || count * size > capacity) return count * size;
+    
+    unsigned char* p = out;
+    for (int i = 0; i < count; i++) {
+        encode_sound(&configs[i], mode, p + (size_t)i * size);
+    }
+    return count * size;
+}
+
+// Decode up to count back-to-back encodings, which may mix modes. Returns
+// how many were decoded, stopping early at the end of data or at one that
+// does not decode.
+int pfxr_sound_decode_batch(const void* data, int size, pfxr_sound_t* configs, int count) {
+    if (!data || !configs) return 0;
+    
+    const unsigned char* p = data;
+    int decoded = 0;
+    while (decoded < count) {
+        int used = pfxr_sound_decode(p, size, &configs[decoded]);
+        if (used == 0) break;
+        p += used;
+        size -= used;
+        decoded++;
+    }
+    return decoded;
+}
+
+// ============================================================================
+// MAIN API FUNCTIONS IMPLEMENTATION
+// ============================================================================
+
+// Main API function to create sound from template and return WAV data
+char* pfxr_create_sound_from_template(pfxr_template_t template, int seed) {
+    // Apply template to get sound configuration
+    pfxr_sound_t config = pfxr_apply_template(template, seed);
+    
+    // Generate sound from configuration
+    return pfxr_create_sound_from_config(&config);
+}
+
+char* pfxr_create_sound_from_template_ctx(pfxr_context_t* ctx, pfxr_template_t template, int seed, int* wav_size) {
+    pfxr_sound_t config = pfxr_apply_template(template, seed);
+    return pfxr_create_sound_from_config_ctx(ctx, &config, wav_size);
+}
+
+// Create sound from template and save to file
+int pfxr_create_sound_from_template_to_file(pfxr_template_t template, int seed, const char* filename) {
+    if (!filename) {
+        return -1;
+    }
+    
+    // Apply template to get sound configuration
+    pfxr_sound_t config = pfxr_apply_template(template, seed);
+    
+    // Generate sound from configuration and save to file
+    return pfxr_create_sound_from_config_to_file(&config, filename);
+}
+
+// Render the rest of a generator in a sample format, converting in small
+// chunks instead of going through a full-length float buffer
+static void render_samples(pfxr_generator_t* gen, pfxr_sample_format_t format, pfxr_dither_t* dither, char* out) {
+    float chunk[PFXR_RENDER_CHUNK];
+    int sample_size = pfxr_sample_size(format);
+    int n;
+    while ((n = pfxr_generator_render(gen, chunk, PFXR_RENDER_CHUNK)) > 0) {
+        pfxr_convert_samples_dither(chunk, out, n, format, dither);
+        out += n * sample_size;
+    }
+}
+
+// Render a configuration straight into newly allocated 16-bit WAV data
+static char* render_wav_data(pfxr_context_t* ctx, const pfxr_sound_t* config, int* wav_size) {
+    pfxr_generator_t gen;
+    pfxr_generator_init(&gen, config);
+    
+    int sample_count = gen.total_samples;
+    if (sample_count <= 0) {
+        return NULL;
+    }
+    
+    // Deep phaser sweeps reach further back than the generator keeps inline
+    float* history = NULL;
+    int history_size = generator_history_needed(&gen);
+    if (history_size > PFXR_PHASER_HISTORY) {
+        history = pfxr_context_alloc(ctx, history_size * sizeof(float));
+        if (!history) {
+            return NULL;
+        }
+        pfxr_generator_set_history(&gen, history, history_size);
+    }
+    
+    int file_size = sizeof(pfxr_wav_header_t) + sample_count * sizeof(int16_t);
+    char* wav_data = pfxr_context_alloc(ctx, file_size);
+    if (!wav_data) {
+        pfxr_context_free(ctx, history);
+        return NULL;
+    }
+    
+    write_wav_header(wav_data, sample_count, (int)gen.sample_rate, PFXR_FORMAT_PCM16);
+    render_samples(&gen, PFXR_FORMAT_PCM16, NULL, wav_data + sizeof(pfxr_wav_header_t));
+    
+    pfxr_context_free(ctx, history);
+    
+    *wav_size = file_size;
+    return wav_data;
+}
+
+// Number of samples a configuration renders to
+int pfxr_sound_sample_count(const pfxr_sound_t* config) {
+    return pfxr_sound_sample_count_rate(config, PFXR_SAMPLE_RATE);
+}
+
+int pfxr_sound_sample_count_rate(const pfxr_sound_t* config, int sample_rate) {
+    if (!config) return 0;
+    float rate = render_rate(sample_rate);
+    return sound_sample_count(config, rate, max_samples_at(rate));
+}
+
+// Render float samples into a caller buffer, returns the sample count needed
+int pfxr_render_into(const pfxr_sound_t* config, float* out, int capacity) {
+    return pfxr_render_into_rate(config, PFXR_SAMPLE_RATE, out, capacity);
+}
+
+int pfxr_render_into_rate(const pfxr_sound_t* config, int sample_rate, float* out, int capacity) {
+    return pfxr_render_into_interval(config, sample_rate, 0, out, capacity);
+}
+
+int pfxr_render_into_interval(const pfxr_sound_t* config, int sample_rate, int control_interval,
+                              float* out, int capacity) {
+    if (!config) return 0;
+    
+    pfxr_generator_t gen;
+    render_generator_init(&gen, config, sample_rate, control_interval);
+    if (!out || gen.total_samples > capacity) {
+        return gen.total_samples;
+    }
+    
+    // The output doubles as the phaser delay line
+    pfxr_generator_set_history(&gen, out, capacity > 0 ? capacity : 1);
+    pfxr_generator_render(&gen, out, gen.total_samples);
+    return gen.total_samples;
+}
+
+// Bytes of phaser delay line a generator needs beyond its inline history
+static int generator_scratch_size(const pfxr_generator_t* gen) {
+    int history_size = generator_history_needed(gen);
+    return history_size > PFXR_PHASER_HISTORY ? history_size * (int)sizeof(float) : 0;
+}
+
+// Scratch space a WAV or sample render into a caller buffer needs after its
+// output, 0 unless the sound's phaser reaches further back than
+// PFXR_PHASER_HISTORY samples
+int pfxr_render_scratch_size(const pfxr_sound_t* config, int sample_rate) {
+    if (!config) return 0;
+    
+    pfxr_generator_t gen;
+    pfxr_generator_init_rate(&gen, config, sample_rate);
+    return generator_scratch_size(&gen);
+}
+
+// Render samples, after a WAV header when with_header is set, into a caller
+// buffer and return the output size in bytes. Scratch space for a deep
+// phaser follows the output, 16-byte aligned; when the two do not fit in
+// capacity, nothing is written and the capacity needed is returned.
+static int render_format_into(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                              int control_interval, int with_header, void* out, int capacity) {
+    int sample_size = pfxr_sample_size(format);
+    if (!config || !sample_size) return 0;
+    
+    pfxr_generator_t gen;
+    render_generator_init(&gen, config, sample_rate, control_interval);
+    
+    int sample_count = gen.total_samples;
+    int header_size = with_header ? pfxr_wav_header_size(format) : 0;
+    int size = with_header ? wav_file_size(sample_count, format) : sample_count * sample_size;
+    int scratch_offset = (size + 15) & ~15;
+    int scratch_size = generator_scratch_size(&gen);
+    int needed = scratch_size ? scratch_offset + scratch_size : size;
+    
+    if (!out || needed > capacity) {
+        return needed;
+    }
+    
+    char* data = (char*)out;
+    if (scratch_size) {
+        pfxr_generator_set_history(&gen, (float*)(data + scratch_offset), scratch_size / (int)sizeof(float));
+    }
+    
+    if (with_header) {
+        write_wav_header(data, sample_count, (int)gen.sample_rate, format);
+    }
+    render_samples(&gen, format, NULL, data + header_size);
+    return size;
+}
+
+// Render 16-bit WAV data into a caller buffer, returns the byte count needed
+int pfxr_render_wav_into(const pfxr_sound_t* config, void* out, int capacity) {
+    return render_format_into(config, PFXR_SAMPLE_RATE, PFXR_FORMAT_PCM16, 0, 1, out, capacity);
+}
+
+int pfxr_render_wav_into_rate(const pfxr_sound_t* config, int sample_rate, void* out, int capacity) {
+    return render_format_into(config, sample_rate, PFXR_FORMAT_PCM16, 0, 1, out, capacity);
+}
+
+int pfxr_render_wav_into_format(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                void* out, int capacity) {
+    return render_format_into(config, sample_rate, format, 0, 1, out, capacity);
+}
+
+int pfxr_render_wav_into_interval(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                  int control_interval, void* out, int capacity) {
+    return render_format_into(config, sample_rate, format, control_interval, 1, out, capacity);
+}
+
+// Render headerless samples in a format into a caller buffer, which must be
+// aligned for the sample type. Float output renders in place like
+// pfxr_render_into; other formats convert from a small stack buffer.
+int pfxr_render_samples_into(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                             void* out, int capacity) {
+    return pfxr_render_samples_into_interval(config, sample_rate, format, 0, out, capacity);
+}
+
+int pfxr_render_samples_into_interval(const pfxr_sound_t* config, int sample_rate, pfxr_sample_format_t format,
+                                      int control_interval, void* out, int capacity) {
+    if (format == PFXR_FORMAT_FLOAT32) {
+        if (capacity < 0) capacity = 0;
+        int count = pfxr_render_into_interval(config, sample_rate, control_interval, (float*)out,
+                                              capacity / (int)sizeof(float));
+        return count * (int)sizeof(float);
+    }
+    return render_format_into(config, sample_rate, format, control_interval, 0, out, capacity);
+}
+
+// Create sound from configuration and return WAV data
+char* pfxr_create_sound_from_config(const pfxr_sound_t* config) {
+    if (!config) {
+        return NULL;
+    }
+    
+    int wav_size;
+    return render_wav_data(NULL, config, &wav_size);
+}
+
+char* pfxr_create_sound_from_config_ctx(pfxr_context_t* ctx, const pfxr_sound_t* config, int* wav_size) {
+    if (!config || !wav_size) {
+        return NULL;
+    }
+    
+    return render_wav_data(ctx, config, wav_size);
+}
+
+// Create sound from configuration and save to file
+int pfxr_create_sound_from_config_to_file(const pfxr_sound_t* config, const char* filename) {
+    if (!config || !filename) {
+        return -1;
+    }
+    
+    int wav_size;
+    char* wav_data = render_wav_data(NULL, config, &wav_size);
+    if (!wav_data) {
+        return -1;
+    }
+    
+    int result = write_file(filename, wav_data, wav_size);
+    PFXR_FREE(wav_data);
+    
+    return result;
+}
+
+// ============================================================================
+// BATCH RENDERING IMPLEMENTATION
+// ============================================================================
+
+// Jobs are sorted longest first and dealt round-robin into one queue per
+// worker. A worker takes jobs from the front of its own queue and, once it
+// runs dry, steals from the back of the others, so long sounds start early
+// and short ones fill the gaps at the end.
+
+typedef struct {
+#ifdef PFXR_THREADS
+    pthread_mutex_t lock;
+#endif
+    int head;               // Next job for the owner
+    int tail;               // One past the next job for thieves
+} batch_queue_t;
+
+typedef struct {
+    int index;
+    float cost;
+} batch_job_t;
+
+struct batch_state;
+
+// Per-worker scratch, reused across jobs
+typedef struct {
+    struct batch_state* batch;
+    int id;
+    float* history;         // Delay line for deep phaser sweeps
+    int history_capacity;
+    pfxr_generator_t gen;
+} batch_worker_t;
+
+typedef struct batch_state {
+    const pfxr_sound_t* configs;
+    pfxr_batch_result_t* results;
+    pfxr_batch_format_t format;
+    pfxr_sample_format_t sample_format;
+    uint32_t dither_seed;
+    int sample_rate;
+    int control_interval;
+    int failed;             // Set when a job runs out of memory
+    int* order;             // Job indices, each queue owns a range
+    batch_queue_t* queues;
+    int worker_count;
+} batch_state_t;
+
+static int compare_jobs(const void* a, const void* b) {
+    const batch_job_t* ja = (const batch_job_t*)a;
+    const batch_job_t* jb = (const batch_job_t*)b;
+    if (ja->cost != jb->cost) return ja->cost > jb->cost ? -1 : 1;
+    return ja->index - jb->index;
+}
+
+// Rough render time: the phaser runs a slower per-sample loop
+static float batch_job_cost(const pfxr_sound_t* config, int sample_rate) {
+    float cost = (float)pfxr_sound_sample_count_rate(config, sample_rate);
+    if (config->phaserDepth > 0.0f) cost *= 3.0f;
+    return cost;
+}
+
+static int batch_pop(batch_queue_t* queue, const int* order, int steal) {
+    int job = -1;
+#ifdef PFXR_THREADS
+    pthread_mutex_lock(&queue->lock);
+#endif
+    if (queue->head < queue->tail) {
+        job = steal ? order[--queue->tail] : order[queue->head++];
+    }
+#ifdef PFXR_THREADS
+    pthread_mutex_unlock(&queue->lock);
+#endif
+    return job;
+}
+
+// Next job from the worker's own queue, or stolen from another one
+static int batch_next_job(batch_worker_t* worker) {
+    batch_state_t* batch = worker->batch;
+    int job = batch_pop(&batch->queues[worker->id], batch->order, 0);
+    for (int k = 1; job < 0 && k < batch->worker_count; k++) {
+        int victim = (worker->id + k) % batch->worker_count;
+        job = batch_pop(&batch->queues[victim], batch->order, 1);
+    }
+    return job;
+}
+
+static void batch_render_job(batch_worker_t* worker, int index) {
+    batch_state_t* batch = worker->batch;
+    pfxr_batch_result_t* result = &batch->results[index];
+    pfxr_generator_t* gen = &worker->gen;
     
-    for (int i = 0; i < total_samples; i++) {
-        float t = (float)i / sample_rate;
-        float sample = 0.0f;
-        
-        // Calculate envelope
-        float envelope = 0.0f;
-        if (t < config->attackTime) {
-            // Attack phase
-            envelope = (1.0f - config->sustainPunch) * (t / config->attackTime);
-        } else if (t < config->attackTime + config->sustainTime) {
-            // Sustain phase
-            envelope = 1.0f;
-        } else {
-            // Decay phase
-            float decay_t = (t - config->attackTime - config->sustainTime) / config->decayTime;
-            envelope = (1.0f - config->sustainPunch) * (1.0f - decay_t);
-        }
-        
-        if (envelope < 0.0f) envelope = 0.0f;
-        
-        // Calculate frequency with pitch sweep
-        float current_freq = config->frequency;
-        if (config->pitchDelta != 0.0f && t >= config->pitchDelay) {
-            float pitch_t = (t - config->pitchDelay) / (duration - config->pitchDelay);
-            if (pitch_t > config->pitchDuration) pitch_t = config->pitchDuration;
-            current_freq += config->pitchDelta * pitch_t;
+    render_generator_init(gen, &batch->configs[index], batch->sample_rate, batch->control_interval);
+    int sample_count = gen->total_samples;
+    if (sample_count <= 0) {
+        return;
+    }
+    
+    if (batch->format == PFXR_BATCH_FLOAT) {
+        float* samples = (float*)PFXR_MALLOC(sample_count * sizeof(float));
+        if (!samples) {
+            PFXR_ATOMIC_STORE(&batch->failed, 1);
+            return;
         }
         
-        // Apply vibrato
-        if (config->vibratoRate > 0.0f && config->vibratoDepth > 0.0f) {
-            float vibrato = sinf(vibrato_phase) * config->vibratoDepth;
-            current_freq += vibrato;
-            vibrato_phase += (config->vibratoRate * 2.0f * M_PI) / sample_rate;
+        // The output doubles as the phaser delay line
+        pfxr_generator_set_history(gen, samples, sample_count);
+        pfxr_generator_render(gen, samples, sample_count);
+        result->data = samples;
+        result->size = sample_count;
+        result->sample_count = sample_count;
+        return;
+    }
+    
+    int history_size = generator_history_needed(gen);
+    if (history_size > PFXR_PHASER_HISTORY) {
+        if (history_size > worker->history_capacity) {
+            float* history = (float*)PFXR_REALLOC(worker->history, history_size * sizeof(float));
+            if (!history) {
+                PFXR_ATOMIC_STORE(&batch->failed, 1);
+                return;
+            }
+            worker->history = history;
+            worker->history_capacity = history_size;
         }
-        
-        // Generate base waveform
-        if (current_freq > 0.0f) {
-            sample = generate_waveform((pfxr_wave_type_t)config->waveForm, phase);
-            phase += current_freq / sample_rate;
-            if (phase >= 1.0f) phase -= 1.0f;
+        pfxr_generator_set_history(gen, worker->history, history_size);
+    }
+    
+    int header_size = pfxr_wav_header_size(batch->sample_format);
+    int file_size = wav_file_size(sample_count, batch->sample_format);
+    char* wav_data = (char*)PFXR_MALLOC(file_size);
+    if (!wav_data) {
+        PFXR_ATOMIC_STORE(&batch->failed, 1);
+        return;
+    }
+    
+    // Dither depends on the sound's index only, not on the worker
+    pfxr_dither_t dither;
+    pfxr_dither_init(&dither, batch->dither_seed + (uint32_t)index);
+    
+    write_wav_header(wav_data, sample_count, (int)gen->sample_rate, batch->sample_format);
+    render_samples(gen, batch->sample_format, batch->dither_seed ? &dither : NULL, wav_data + header_size);
+    result->data = wav_data;
+    result->size = file_size;
+    result->sample_count = sample_count;
+}
+
+static void* batch_worker_main(void* arg) {
+    batch_worker_t* worker = (batch_worker_t*)arg;
+    int job;
+    
+    // Once one job has failed the batch is discarded, so skip the rest
+    while (!PFXR_ATOMIC_LOAD(&worker->batch->failed) && (job = batch_next_job(worker)) >= 0) {
+        batch_render_job(worker, job);
+    }
+    return NULL;
+}
+
+static int batch_default_threads(void) {
+#ifdef PFXR_THREADS
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+#else
+    return 1;
+#endif
+}
+
+// Render a batch of sounds, returns n results in input order, or NULL if
+// any sound could not be rendered for lack of memory. Release them with
+// pfxr_free_batch.
+pfxr_batch_result_t* pfxr_render_batch(const pfxr_sound_t* configs, int n, const pfxr_batch_opts_t* opts) {
+    if (!configs || n <= 0) {
+        return NULL;
+    }
+    
+    int worker_count = opts && opts->threads > 0 ? opts->threads : batch_default_threads();
+    int sample_rate = opts ? opts->sample_rate : PFXR_SAMPLE_RATE;
+    pfxr_sample_format_t sample_format = opts ? opts->sample_format : PFXR_FORMAT_PCM16;
+    if (!pfxr_sample_size(sample_format)) {
+        return NULL;
+    }
+#ifndef PFXR_THREADS
+    worker_count = 1;
+#endif
+    if (worker_count > n) worker_count = n;
+    
+    pfxr_batch_result_t* results = (pfxr_batch_result_t*)PFXR_MALLOC(n * sizeof(pfxr_batch_result_t));
+    batch_job_t* jobs = (batch_job_t*)PFXR_MALLOC(n * sizeof(batch_job_t));
+    int* order = (int*)PFXR_MALLOC(n * sizeof(int));
+    batch_queue_t* queues = (batch_queue_t*)PFXR_MALLOC(worker_count * sizeof(batch_queue_t));
+    batch_worker_t* workers = (batch_worker_t*)PFXR_MALLOC(worker_count * sizeof(batch_worker_t));
+    if (!results || !jobs || !order || !queues || !workers) {
+        PFXR_FREE(results);
+        PFXR_FREE(jobs);
+        PFXR_FREE(order);
+        PFXR_FREE(queues);
+        PFXR_FREE(workers);
+        return NULL;
+    }
+    memset(results, 0, n * sizeof(pfxr_batch_result_t));
+    
+    for (int i = 0; i < n; i++) {
+        jobs[i].index = i;
+        jobs[i].cost = batch_job_cost(&configs[i], sample_rate);
+    }
+    qsort(jobs, n, sizeof(batch_job_t), compare_jobs);
+    
+    // Deal the sorted jobs round-robin, each queue gets a contiguous range
+    int next = 0;
+    for (int w = 0; w < worker_count; w++) {
+        queues[w].head = next;
+        for (int i = w; i < n; i += worker_count) {
+            order[next++] = jobs[i].index;
         }
-        
-        // Apply noise distortion
-        if (config->noiseAmount > 0.0f) {
-            sample = generate_noise_distortion(sample, config->noiseAmount / 100.0f, &noise_seed);
+        queues[w].tail = next;
+    }
+    PFXR_FREE(jobs);
+    
+    batch_state_t batch;
+    batch.configs = configs;
+    batch.results = results;
+    batch.format = opts ? opts->format : PFXR_BATCH_WAV;
+    batch.sample_format = sample_format;
+    batch.dither_seed = opts ? opts->dither_seed : 0;
+    batch.control_interval = opts ? opts->control_interval : 0;
+    batch.failed = 0;
+    batch.sample_rate = sample_rate;
+    batch.order = order;
+    batch.queues = queues;
+    batch.worker_count = worker_count;
+    
+    for (int w = 0; w < worker_count; w++) {
+        workers[w].batch = &batch;
+        workers[w].id = w;
+        workers[w].history = NULL;
+        workers[w].history_capacity = 0;
+    }
+    
+#ifdef PFXR_THREADS
+    // The caller works as worker 0. A worker whose thread fails to start has
+    // its queue stolen by the others.
+    pthread_t* threads = (pthread_t*)PFXR_MALLOC(worker_count * sizeof(pthread_t));
+    int* started = (int*)PFXR_MALLOC(worker_count * sizeof(int));
+    for (int w = 0; w < worker_count; w++) {
+        pthread_mutex_init(&queues[w].lock, NULL);
+    }
+    for (int w = 1; w < worker_count; w++) {
+        if (threads && started) {
+            started[w] = pthread_create(&threads[w], NULL, batch_worker_main, &workers[w]) == 0;
         }
-        
-        // Apply phaser effect (simplified)
-        if (config->phaserDepth > 0.0f) {
-            float phaser_freq = config->phaserBaseFrequency + 
-                               sinf(phaser_phase) * config->phaserDepth;
-            // Simplified phaser - just add a delayed version
-            float delay_samples = sample_rate / (phaser_freq + 1.0f);
-            if (i >= (int)delay_samples) {
-                sample += buffer->samples[i - (int)delay_samples] * 0.5f;
+    }
+    batch_worker_main(&workers[0]);
+    for (int w = 1; w < worker_count; w++) {
+        if (threads && started && started[w]) pthread_join(threads[w], NULL);
+    }
+    for (int w = 0; w < worker_count; w++) {
+        pthread_mutex_destroy(&queues[w].lock);
+    }
+    PFXR_FREE(threads);
+    PFXR_FREE(started);
+#else
+    batch_worker_main(&workers[0]);
+#endif
+    
+    for (int w = 0; w < worker_count; w++) {
+        PFXR_FREE(workers[w].history);
+    }
+    PFXR_FREE(workers);
+    PFXR_FREE(queues);
+    PFXR_FREE(order);
+    
+    if (batch.failed) {
+        pfxr_free_batch(results, n);
+        return NULL;
+    }
+    return results;
+}
+
+// Free the results of pfxr_render_batch
+void pfxr_free_batch(pfxr_batch_result_t* results, int n) {
+    if (!results) return;
+    for (int i = 0; i < n; i++) {
+        PFXR_FREE(results[i].data);
+    }
+    PFXR_FREE(results);
+}
+
+// ============================================================================
+// TIMELINE RENDERING IMPLEMENTATION
+// ============================================================================
+
+// The track is cut into segments as long as the longest sound, so a sound
+// reaches at most into the segment after the one it starts in. Sounds are
+// sorted by offset and each segment's sounds form a span. Spans of even
+// segments write disjoint parts of the track, as do odd ones, so workers
+// claim spans and mix them straight into the track without locks, even
+// segments first and then odd ones. The mixing order is the same on any
+// number of threads, so the track is identical either way.
+
+typedef struct {
+    int index;              // Event index
+    int start;              // Track samples the event covers
+    int end;
+} timeline_key_t;
+
+typedef struct {
+    int first;              // Sorted keys of the span
+    int last;
+} timeline_span_t;
+
+struct timeline_state;
+
+// Per-worker scratch, reused across events
+typedef struct {
+    struct timeline_state* timeline;
+    float* history;         // Delay line for deep phaser sweeps
+    int history_capacity;
+    int failed;
+    pfxr_generator_t gen;
+} timeline_worker_t;
+
+typedef struct timeline_state {
+    const pfxr_timeline_event_t* events;
+    const timeline_key_t* keys;
+    const timeline_span_t* spans;   // Spans of the current phase
+    int span_count;
+    int next_span;          // Next span to claim
+    int sample_rate;
+    float* out;
+} timeline_state_t;
+
+static int compare_timeline_keys(const void* a, const void* b) {
+    const timeline_key_t* ka = (const timeline_key_t*)a;
+    const timeline_key_t* kb = (const timeline_key_t*)b;
+    if (ka->start != kb->start) return ka->start < kb->start ? -1 : 1;
+    return ka->index - kb->index;
+}
+
+// Segment holding the first track sample a key writes
+static int timeline_segment(const timeline_key_t* key, int segment_length) {
+    return (key->start > 0 ? key->start : 0) / segment_length;
+}
+
+// Track length in samples for events, or -1 if it does not fit in an int.
+// Offsets are in samples at sample_rate.
+int pfxr_timeline_length(const pfxr_timeline_event_t* events, int n, int sample_rate) {
+    if (!events || n <= 0) return 0;
+    
+    int64_t length = 0;
+    for (int i = 0; i < n; i++) {
+        int64_t end = (int64_t)events[i].offset + pfxr_sound_sample_count_rate(&events[i].config, sample_rate);
+        if (end > length) length = end;
+    }
+    return length > INT32_MAX ? -1 : (int)length;
+}
+
+// Render one event in small chunks and add it into the track
+static void timeline_mix_event(timeline_worker_t* worker, const timeline_key_t* key) {
+    timeline_state_t* timeline = worker->timeline;
+    const pfxr_timeline_event_t* event = &timeline->events[key->index];
+    pfxr_generator_t* gen = &worker->gen;
+    
+    pfxr_generator_init_rate(gen, &event->config, timeline->sample_rate);
+    int history_size = generator_history_needed(gen);
+    if (history_size > PFXR_PHASER_HISTORY) {
+        if (history_size > worker->history_capacity) {
+            float* history = (float*)PFXR_REALLOC(worker->history, history_size * sizeof(float));
+            if (!history) {
+                worker->failed = 1;
+                return;
             }
-            phaser_phase += (config->phaserLfoFrequency * 2.0f * M_PI) / sample_rate;
+            worker->history = history;
+            worker->history_capacity = history_size;
         }
-        
-        // Apply filters
-        if (config->lowPassCutoff > 0.0f && config->lowPassCutoff < 4000.0f) {
-            sample = biquad_process(&lowpass_filter, sample);
+        pfxr_generator_set_history(gen, worker->history, history_size);
+    }
+    
+    float chunk[PFXR_RENDER_CHUNK];
+    float gain = event->gain;
+    int position = key->start;
+    int n;
+    while ((n = pfxr_generator_render(gen, chunk, PFXR_RENDER_CHUNK)) > 0) {
+        // Samples before the start of the track are dropped
+        int skip = position < 0 ? (-position < n ? -position : n) : 0;
+        float* track = timeline->out;
+        for (int k = skip; k < n; k++) {
+            track[position + k] += chunk[k] * gain;
         }
-        
-        if (config->highPassCutoff > 0.0f) {
-            sample = biquad_process(&highpass_filter, sample);
+        position += n;
+    }
+}
+
+static void* timeline_worker_main(void* arg) {
+    timeline_worker_t* worker = (timeline_worker_t*)arg;
+    timeline_state_t* timeline = worker->timeline;
+    for (;;) {
+        int span = PFXR_ATOMIC_ADD(&timeline->next_span, 1);
+        if (span >= timeline->span_count) break;
+        for (int i = timeline->spans[span].first; i < timeline->spans[span].last; i++) {
+            timeline_mix_event(worker, &timeline->keys[i]);
         }
-        
-        // Apply envelope
-        sample *= envelope;
-        
-        // Apply tremolo
-        if (config->tremoloRate > 0.0f && config->tremoloDepth > 0.0f) {
-            float tremolo = 1.0f - config->tremoloDepth * (1.0f + sinf(tremolo_phase)) * 0.5f;
-            sample *= tremolo;
-            tremolo_phase += (config->tremoloRate * 2.0f * M_PI) / sample_rate;
+    }
+    return NULL;
+}
+
+// Mix events into out, a mono track starting at sample 0 that is cleared
+// first. Returns the track length like pfxr_render_into (nothing is written
+// when it is larger than capacity), or -1 if it does not fit in an int or
+// scratch memory runs out. threads is the worker count including the
+// caller, 0 for one per CPU; scratch is one key per event plus a generator
+// and phaser delay line per worker.
+int pfxr_render_timeline(const pfxr_timeline_event_t* events, int n, int sample_rate,
+                         float* out, int capacity, int threads) {
+    int length = pfxr_timeline_length(events, n, sample_rate);
+    if (length <= 0 || !out || length > capacity) return length;
+    
+    timeline_key_t* keys = (timeline_key_t*)PFXR_MALLOC(n * sizeof(timeline_key_t));
+    timeline_span_t* spans = (timeline_span_t*)PFXR_MALLOC(n * sizeof(timeline_span_t));
+    if (!keys || !spans) {
+        PFXR_FREE(keys);
+        PFXR_FREE(spans);
+        return -1;
+    }
+    
+    // Sounds that are silent or end before the track starts are left out
+    int key_count = 0;
+    for (int i = 0; i < n; i++) {
+        int count = pfxr_sound_sample_count_rate(&events[i].config, sample_rate);
+        if (count <= 0 || events[i].offset + count <= 0) continue;
+        keys[key_count].index = i;
+        keys[key_count].start = events[i].offset;
+        keys[key_count].end = events[i].offset + count;
+        key_count++;
+    }
+    qsort(keys, key_count, sizeof(timeline_key_t), compare_timeline_keys);
+    
+    int segment_length = 1;
+    for (int i = 0; i < key_count; i++) {
+        int count = keys[i].end - keys[i].start;
+        if (count > segment_length) segment_length = count;
+    }
+    
+    // Even segments' spans fill spans from the front, odd ones from the back
+    int even_count = 0;
+    int odd_first = key_count;
+    for (int i = 0; i < key_count;) {
+        int segment = timeline_segment(&keys[i], segment_length);
+        int first = i++;
+        while (i < key_count && timeline_segment(&keys[i], segment_length) == segment) i++;
+        timeline_span_t* span = segment % 2 == 0 ? &spans[even_count++] : &spans[--odd_first];
+        span->first = first;
+        span->last = i;
+    }
+    int span_count = even_count + key_count - odd_first;
+    
+    memset(out, 0, (size_t)length * sizeof(float));
+    
+    int worker_count = threads > 0 ? threads : batch_default_threads();
+#if !defined(PFXR_THREADS) || !defined(PFXR_ATOMICS)
+    worker_count = 1;
+#endif
+    if (worker_count > span_count) worker_count = span_count;
+    if (worker_count < 1) worker_count = 1;
+    
+    timeline_worker_t* workers = (timeline_worker_t*)PFXR_MALLOC(worker_count * sizeof(timeline_worker_t));
+    if (!workers) {
+        PFXR_FREE(keys);
+        PFXR_FREE(spans);
+        return -1;
+    }
+    
+    timeline_state_t timeline;
+    timeline.events = events;
+    timeline.keys = keys;
+    timeline.sample_rate = sample_rate;
+    timeline.out = out;
+    
+    for (int w = 0; w < worker_count; w++) {
+        workers[w].timeline = &timeline;
+        workers[w].history = NULL;
+        workers[w].history_capacity = 0;
+        workers[w].failed = 0;
+    }
+    
+#if defined(PFXR_THREADS) && defined(PFXR_ATOMICS)
+    pthread_t* thread_ids = (pthread_t*)PFXR_MALLOC(worker_count * sizeof(pthread_t));
+    int* started = (int*)PFXR_MALLOC(worker_count * sizeof(int));
+#endif
+    for (int phase = 0; phase < 2; phase++) {
+        timeline.spans = phase == 0 ? spans : spans + odd_first;
+        timeline.span_count = phase == 0 ? even_count : key_count - odd_first;
+        timeline.next_span = 0;
+#if defined(PFXR_THREADS) && defined(PFXR_ATOMICS)
+        // The caller works as worker 0; spans left by a thread that fails
+        // to start are claimed by the others
+        for (int w = 1; w < worker_count; w++) {
+            if (thread_ids && started) {
+                started[w] = pthread_create(&thread_ids[w], NULL, timeline_worker_main, &workers[w]) == 0;
+            }
         }
-        
-        // Apply volume and clamp
-        sample *= config->volume;
-        sample = clamp(sample, -1.0f, 1.0f);
-        
-        buffer->samples[i] = sample;
+        timeline_worker_main(&workers[0]);
+        for (int w = 1; w < worker_count; w++) {
+            if (thread_ids && started && started[w]) pthread_join(thread_ids[w], NULL);
+        }
+#else
+        timeline_worker_main(&workers[0]);
+#endif
     }
+#if defined(PFXR_THREADS) && defined(PFXR_ATOMICS)
+    PFXR_FREE(thread_ids);
+    PFXR_FREE(started);
+#endif
     
-    buffer->sample_count = total_samples;
+    int failed = 0;
+    for (int w = 0; w < worker_count; w++) {
+        failed |= workers[w].failed;
+        PFXR_FREE(workers[w].history);
+    }
+    PFXR_FREE(workers);
+    PFXR_FREE(spans);
+    PFXR_FREE(keys);
+    return failed ? -1 : length;
 }
 
 // ============================================================================
-// WAV FILE IMPLEMENTATION
+// SOUND CACHE IMPLEMENTATION
 // ============================================================================
 
-// Create WAV data from float samples
-char* pfxr_create_wav_data(const float* samples, int sample_count, int* wav_size) {
-    if (!samples || sample_count <= 0 || !wav_size) {
+// Entries sit in a chained hash table and a doubly linked LRU list. Each one
+// is a single allocation: the entry, then its WAV data. An evicted entry
+// that is still held leaves the table at once and is freed on its last
+// release.
+
+#define PFXR_CACHE_BUCKETS 64
+
+typedef struct cache_entry {
+    pfxr_cached_sound_t sound;      // First, so handles convert back
+    pfxr_sound_t config;            // Canonical config, checked on lookup
+    size_t bytes;
+    void* map;                      // File mapping holding wav_data, if any
+    size_t map_size;
+    int refs;
+    int cached;                     // Still in the table and LRU list
+    struct cache_entry* chain;
+    struct cache_entry* prev;       // Towards most recently used
+    struct cache_entry* next;
+} cache_entry_t;
+
+struct pfxr_cache {
+#ifdef PFXR_THREADS
+    pthread_mutex_t lock;
+#endif
+    cache_entry_t** buckets;
+    int bucket_count;               // Power of two
+    cache_entry_t* newest;
+    cache_entry_t* oldest;
+    pfxr_cache_stats_t stats;
+    char* directory;                // Shared cache directory, NULL for none
+    unsigned int temp_serial;       // Makes temp file names unique
+};
+
+static void cache_lock(pfxr_cache_t* cache) {
+#ifdef PFXR_THREADS
+    pthread_mutex_lock(&cache->lock);
+#else
+    (void)cache;
+#endif
+}
+
+static void cache_unlock(pfxr_cache_t* cache) {
+#ifdef PFXR_THREADS
+    pthread_mutex_unlock(&cache->lock);
+#else
+    (void)cache;
+#endif
+}
+
+// One bit pattern per value: -0 hashes as +0 and every NaN alike
+static float canonical_float(float value) {
+    if (value != value) return NAN;
+    if (value == 0.0f) return 0.0f;
+    return value;
+}
+
+static pfxr_sound_t canonical_sound(const pfxr_sound_t* config) {
+    pfxr_sound_t c = *config;
+    c.volume = canonical_float(c.volume);
+    c.attackTime = canonical_float(c.attackTime);
+    c.sustainTime = canonical_float(c.sustainTime);
+    c.sustainPunch = canonical_float(c.sustainPunch);
+    c.decayTime = canonical_float(c.decayTime);
+    c.frequency = canonical_float(c.frequency);
+    c.pitchDelta = canonical_float(c.pitchDelta);
+    c.pitchDuration = canonical_float(c.pitchDuration);
+    c.pitchDelay = canonical_float(c.pitchDelay);
+    c.vibratoRate = canonical_float(c.vibratoRate);
+    c.vibratoDepth = canonical_float(c.vibratoDepth);
+    c.tremoloRate = canonical_float(c.tremoloRate);
+    c.tremoloDepth = canonical_float(c.tremoloDepth);
+    c.highPassCutoff = canonical_float(c.highPassCutoff);
+    c.highPassResonance = canonical_float(c.highPassResonance);
+    c.lowPassCutoff = canonical_float(c.lowPassCutoff);
+    c.lowPassResonance = canonical_float(c.lowPassResonance);
+    c.phaserBaseFrequency = canonical_float(c.phaserBaseFrequency);
+    c.phaserLfoFrequency = canonical_float(c.phaserLfoFrequency);
+    c.phaserDepth = canonical_float(c.phaserDepth);
+    c.noiseAmount = canonical_float(c.noiseAmount);
+    return c;
+}
+
+// FNV-1a over the little-endian bytes of a 32-bit word
+static void hash_word(uint64_t* hash, uint32_t word) {
+    for (int i = 0; i < 4; i++) {
+        *hash ^= (word >> (i * 8)) & 0xff;
+        *hash *= 0x100000001b3ull;
+    }
+}
+
+static void hash_float(uint64_t* hash, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    hash_word(hash, bits);
+}
+
+// Stable 64-bit key of a sound: the same on every platform and run, and
+// equal for configs that differ only in the sign of zero or NaN payloads
+uint64_t pfxr_sound_hash(const pfxr_sound_t* config) {
+    if (!config) return 0;
+    
+    pfxr_sound_t c = canonical_sound(config);
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash_word(&hash, (uint32_t)c.waveForm);
+    hash_float(&hash, c.volume);
+    hash_float(&hash, c.attackTime);
+    hash_float(&hash, c.sustainTime);
+    hash_float(&hash, c.sustainPunch);
+    hash_float(&hash, c.decayTime);
+    hash_float(&hash, c.frequency);
+    hash_float(&hash, c.pitchDelta);
+    hash_float(&hash, c.pitchDuration);
+    hash_float(&hash, c.pitchDelay);
+    hash_float(&hash, c.vibratoRate);
+    hash_float(&hash, c.vibratoDepth);
+    hash_float(&hash, c.tremoloRate);
+    hash_float(&hash, c.tremoloDepth);
+    hash_float(&hash, c.highPassCutoff);
+    hash_float(&hash, c.highPassResonance);
+    hash_float(&hash, c.lowPassCutoff);
+    hash_float(&hash, c.lowPassResonance);
+    hash_float(&hash, c.phaserBaseFrequency);
+    hash_float(&hash, c.phaserLfoFrequency);
+    hash_float(&hash, c.phaserDepth);
+    hash_float(&hash, c.noiseAmount);
+    
+    // Final avalanche so the low bits index buckets well
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+pfxr_cache_t* pfxr_cache_create(size_t budget) {
+    pfxr_cache_t* cache = (pfxr_cache_t*)PFXR_MALLOC(sizeof(pfxr_cache_t));
+    if (!cache) return NULL;
+    
+    memset(cache, 0, sizeof(*cache));
+    cache->buckets = (cache_entry_t**)PFXR_MALLOC(PFXR_CACHE_BUCKETS * sizeof(cache_entry_t*));
+    if (!cache->buckets) {
+        PFXR_FREE(cache);
         return NULL;
     }
+    memset(cache->buckets, 0, PFXR_CACHE_BUCKETS * sizeof(cache_entry_t*));
+    cache->bucket_count = PFXR_CACHE_BUCKETS;
+    cache->stats.budget = budget;
+#ifdef PFXR_THREADS
+    pthread_mutex_init(&cache->lock, NULL);
+#endif
+    return cache;
+}
+
+static void cache_lru_unlink(pfxr_cache_t* cache, cache_entry_t* entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else cache->newest = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else cache->oldest = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void cache_lru_push(pfxr_cache_t* cache, cache_entry_t* entry) {
+    entry->prev = NULL;
+    entry->next = cache->newest;
+    if (cache->newest) cache->newest->prev = entry;
+    else cache->oldest = entry;
+    cache->newest = entry;
+}
+
+static void cache_entry_free(cache_entry_t* entry) {
+#ifdef PFXR_MMAP
+    if (entry->map) munmap(entry->map, entry->map_size);
+#endif
+    PFXR_FREE(entry);
+}
+
+// Take an entry out of the table and LRU list; frees it unless held
+static void cache_remove(pfxr_cache_t* cache, cache_entry_t* entry) {
+    cache_entry_t** link = &cache->buckets[entry->sound.key & (uint64_t)(cache->bucket_count - 1)];
+    while (*link != entry) link = &(*link)->chain;
+    *link = entry->chain;
     
-    // Calculate sizes
-    int data_size = sample_count * sizeof(int16_t);
-    int file_size = sizeof(pfxr_wav_header_t) + data_size;
+    cache_lru_unlink(cache, entry);
+    entry->cached = 0;
+    cache->stats.bytes -= entry->bytes;
+    cache->stats.entries--;
+    if (entry->refs == 0) cache_entry_free(entry);
+}
+
+// Double the table once it holds more entries than buckets
+static void cache_grow(pfxr_cache_t* cache) {
+    int count = cache->bucket_count * 2;
+    cache_entry_t** buckets = (cache_entry_t**)PFXR_MALLOC(count * sizeof(cache_entry_t*));
+    if (!buckets) return;
     
-    // Allocate memory for WAV data
-    char* wav_data = malloc(file_size);
-    if (!wav_data) {
+    memset(buckets, 0, count * sizeof(cache_entry_t*));
+    for (int b = 0; b < cache->bucket_count; b++) {
+        cache_entry_t* entry = cache->buckets[b];
+        while (entry) {
+            cache_entry_t* chain = entry->chain;
+            cache_entry_t** head = &buckets[entry->sound.key & (uint64_t)(count - 1)];
+            entry->chain = *head;
+            *head = entry;
+            entry = chain;
+        }
+    }
+    PFXR_FREE(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = count;
+}
+
+static cache_entry_t* cache_find(pfxr_cache_t* cache, uint64_t key, const pfxr_sound_t* config) {
+    cache_entry_t* entry = cache->buckets[key & (uint64_t)(cache->bucket_count - 1)];
+    while (entry && (entry->sound.key != key || memcmp(&entry->config, config, sizeof(*config)) != 0)) {
+        entry = entry->chain;
+    }
+    return entry;
+}
+
+// Render a sound into a new, unlinked entry holding one reference
+static cache_entry_t* cache_render(const pfxr_sound_t* config, uint64_t key) {
+    size_t header = (sizeof(cache_entry_t) + 15) & ~(size_t)15;
+    int size = pfxr_render_wav_into(config, NULL, 0);
+    cache_entry_t* entry = (cache_entry_t*)PFXR_MALLOC(header + size);
+    if (!entry) return NULL;
+    
+    int wav_size = pfxr_render_wav_into(config, (char*)entry + header, size);
+    int sample_count = pfxr_sound_sample_count(config);
+    
+    // Give back the phaser scratch space that followed the WAV data
+    if (wav_size < size) {
+        cache_entry_t* shrunk = (cache_entry_t*)PFXR_REALLOC(entry, header + wav_size);
+        if (shrunk) entry = shrunk;
+    }
+    
+    char* wav_data = (char*)entry + header;
+    memset(entry, 0, sizeof(*entry));
+    entry->config = *config;
+    entry->refs = 1;
+    entry->sound.key = key;
+    entry->sound.wav_data = wav_data;
+    entry->sound.wav_size = wav_size;
+    entry->sound.samples = (const int16_t*)(wav_data + sizeof(pfxr_wav_header_t));
+    entry->sound.sample_count = sample_count;
+    entry->bytes = header + wav_size;
+    return entry;
+}
+
+// Cache directory files are named by key ("<16 hex digits>.pfxc") and hold
+// a header with the canonical config, then the WAV data exactly as
+// pfxr_create_sound_from_config returns it. Lookups map the file, so every
+// process using the directory shares one copy in the page cache. Writers
+// fill a private temp file and rename it into place, so readers only ever
+// see complete files and concurrent writers of one sound are harmless.
+
+#define PFXR_CACHE_FILE_MAGIC "PFXC"
+// Bump whenever rendering output changes. Resonant filters that saturate,
+// common in PFXR_TEMPLATE_RANDOM sounds, amplify any rounding change to full
+// scale, so even small changes move some of those sounds by up to 2.0.
+//   2: output of the render plan, linear segments and polynomial exact sine
+#define PFXR_RENDER_VERSION 2
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    pfxr_sound_t config;
+    uint32_t sample_rate;
+    uint32_t wav_size;
+} cache_file_header_t;
+
+// Offset of the WAV data, rounded up so the PCM samples stay aligned
+#define PFXR_CACHE_FILE_DATA ((sizeof(cache_file_header_t) + 15) & ~(size_t)15)
+
+// Use path as a cache directory shared with other processes, creating it
+// if needed (NULL turns it off). Call before sharing the cache between
+// threads. Returns 0, or -1 if the directory is unusable or the platform
+// has no mmap.
+int pfxr_cache_set_directory(pfxr_cache_t* cache, const char* path) {
+    if (!cache) return -1;
+    
+    PFXR_FREE(cache->directory);
+    cache->directory = NULL;
+    if (!path) return 0;
+    
+#ifdef PFXR_MMAP
+    struct stat info;
+    if (mkdir(path, 0777) != 0 && (stat(path, &info) != 0 || !S_ISDIR(info.st_mode))) {
+        return -1;
+    }
+    
+    size_t length = strlen(path);
+    cache->directory = (char*)PFXR_MALLOC(length + 1);
+    if (!cache->directory) return -1;
+    memcpy(cache->directory, path, length + 1);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+#ifdef PFXR_MMAP
+static void cache_file_path(const pfxr_cache_t* cache, uint64_t key, char* path, size_t size) {
+    snprintf(path, size, "%s/%08x%08x.pfxc", cache->directory,
+             (unsigned int)(key >> 32), (unsigned int)key);
+}
+
+// Map a sound's file into a new, unlinked entry holding one reference.
+// Missing, truncated or mismatched files read as misses.
+static cache_entry_t* cache_file_load(pfxr_cache_t* cache, const pfxr_sound_t* config, uint64_t key) {
+    if (!cache->directory) return NULL;
+    
+    char path[4096];
+    cache_file_path(cache, key, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= PFXR_CACHE_FILE_DATA + sizeof(pfxr_wav_header_t)) {
+        map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    
+    size_t map_size = (size_t)info.st_size;
+    const cache_file_header_t* header = (const cache_file_header_t*)map;
+    const char* wav_data = (const char*)map + PFXR_CACHE_FILE_DATA;
+    const pfxr_wav_header_t* wav = (const pfxr_wav_header_t*)wav_data;
+    
+    cache_entry_t* entry = NULL;
+    if (memcmp(header->magic, PFXR_CACHE_FILE_MAGIC, 4) == 0 &&
+        header->version == PFXR_RENDER_VERSION &&
+        header->key == key &&
+        memcmp(&header->config, config, sizeof(*config)) == 0 &&
+        header->sample_rate == PFXR_SAMPLE_RATE &&
+        header->wav_size == map_size - PFXR_CACHE_FILE_DATA &&
+        wav->data_size == header->wav_size - sizeof(pfxr_wav_header_t)) {
+        entry = (cache_entry_t*)PFXR_MALLOC(sizeof(cache_entry_t));
+    }
+    if (!entry) {
+        munmap(map, map_size);
         return NULL;
     }
     
-    // Create WAV header
-    pfxr_wav_header_t* header = (pfxr_wav_header_t*)wav_data;
+    memset(entry, 0, sizeof(*entry));
+    entry->config = *config;
+    entry->refs = 1;
+    entry->map = map;
+    entry->map_size = map_size;
+    entry->sound.key = key;
+    entry->sound.wav_data = wav_data;
+    entry->sound.wav_size = (int)header->wav_size;
+    entry->sound.samples = (const int16_t*)(wav_data + sizeof(pfxr_wav_header_t));
+    entry->sound.sample_count = (int)(wav->data_size / sizeof(int16_t));
+    entry->bytes = sizeof(cache_entry_t) + map_size;
     
-    // RIFF header
-    memcpy(header->riff, "RIFF", 4);
-    header->chunk_size = file_size - 8;
-    memcpy(header->wave, "WAVE", 4);
+    cache_lock(cache);
+    cache->stats.disk_hits++;
+    cache_unlock(cache);
+    return entry;
+}
+
+static int write_all(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0) return -1;
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+// Write a rendered entry to the cache directory (best effort)
+static void cache_file_store(pfxr_cache_t* cache, const cache_entry_t* entry) {
+    if (!cache->directory) return;
     
-    // Format chunk
-    memcpy(header->fmt, "fmt ", 4);
-    header->fmt_size = 16;
-    header->audio_format = 1;  // PCM
-    header->num_channels = 1;  // Mono
-    header->sample_rate = PFXR_SAMPLE_RATE;
-    header->bits_per_sample = 16;
-    header->block_align = header->num_channels * header->bits_per_sample / 8;
-    header->byte_rate = header->sample_rate * header->block_align;
+    char path[4096];
+    char temp[4096 + 64];
+    cache_file_path(cache, entry->sound.key, path, sizeof(path));
     
-    // Data chunk
-    memcpy(header->data, "data", 4);
-    header->data_size = data_size;
+    cache_lock(cache);
+    unsigned int serial = cache->temp_serial++;
+    cache_unlock(cache);
+    snprintf(temp, sizeof(temp), "%s.%ld.%u.tmp", path, (long)getpid(), serial);
     
-    // Convert float samples to 16-bit PCM
-    int16_t* pcm_data = (int16_t*)(wav_data + sizeof(pfxr_wav_header_t));
-    for (int i = 0; i < sample_count; i++) {
-        // Clamp and scale to 16-bit range
-        float sample = samples[i];
-        if (sample > 1.0f) sample = 1.0f;
-        if (sample < -1.0f) sample = -1.0f;
-        
-        pcm_data[i] = (int16_t)(sample * 32767.0f);
+    int fd = open(temp, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) return;
+    
+    char header_bytes[PFXR_CACHE_FILE_DATA];
+    cache_file_header_t* header = (cache_file_header_t*)header_bytes;
+    memset(header_bytes, 0, sizeof(header_bytes));
+    memcpy(header->magic, PFXR_CACHE_FILE_MAGIC, 4);
+    header->version = PFXR_RENDER_VERSION;
+    header->key = entry->sound.key;
+    header->config = entry->config;
+    header->sample_rate = PFXR_SAMPLE_RATE;
+    header->wav_size = (uint32_t)entry->sound.wav_size;
+    
+    int ok = write_all(fd, header_bytes, sizeof(header_bytes)) == 0 &&
+             write_all(fd, entry->sound.wav_data, (size_t)entry->sound.wav_size) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp, path) != 0) {
+        unlink(temp);
+        return;
     }
     
-    *wav_size = file_size;
-    return wav_data;
+    cache_lock(cache);
+    cache->stats.disk_writes++;
+    cache_unlock(cache);
+}
+#else
+static cache_entry_t* cache_file_load(pfxr_cache_t* cache, const pfxr_sound_t* config, uint64_t key) {
+    (void)cache;
+    (void)config;
+    (void)key;
+    return NULL;
 }
 
-// Write WAV file to disk
-int pfxr_write_wav_file(const char* filename, const float* samples, int sample_count) {
-    if (!filename || !samples || sample_count <= 0) {
-        return -1;
+static void cache_file_store(pfxr_cache_t* cache, const cache_entry_t* entry) {
+    (void)cache;
+    (void)entry;
+}
+#endif
+
+// Look a sound up, trying the cache directory and then rendering on a miss.
+// Misses are served outside the lock, so a slow one does not hold up hits
+// on other threads.
+const pfxr_cached_sound_t* pfxr_cache_get(pfxr_cache_t* cache, const pfxr_sound_t* config) {
+    if (!cache || !config) return NULL;
+    
+    pfxr_sound_t canonical = canonical_sound(config);
+    uint64_t key = pfxr_sound_hash(&canonical);
+    
+    cache_lock(cache);
+    cache_entry_t* entry = cache_find(cache, key, &canonical);
+    if (entry) {
+        entry->refs++;
+        cache_lru_unlink(cache, entry);
+        cache_lru_push(cache, entry);
+        cache->stats.hits++;
+        cache_unlock(cache);
+        return &entry->sound;
     }
+    cache->stats.misses++;
+    cache_unlock(cache);
     
-    int wav_size;
-    char* wav_data = pfxr_create_wav_data(samples, sample_count, &wav_size);
-    if (!wav_data) {
-        return -1;
+    cache_entry_t* rendered = cache_file_load(cache, &canonical, key);
+    if (!rendered) {
+        rendered = cache_render(&canonical, key);
+        if (!rendered) return NULL;
+        cache_file_store(cache, rendered);
     }
     
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        free(wav_data);
-        return -1;
+    cache_lock(cache);
+    
+    // Another thread may have rendered the same sound meanwhile
+    entry = cache_find(cache, key, &canonical);
+    if (entry) {
+        entry->refs++;
+        cache_lru_unlink(cache, entry);
+        cache_lru_push(cache, entry);
+        cache_unlock(cache);
+        cache_entry_free(rendered);
+        return &entry->sound;
     }
     
-    size_t written = fwrite(wav_data, 1, wav_size, file);
-    fclose(file);
-    free(wav_data);
+    // A sound larger than the whole budget is handed out uncached
+    if (rendered->bytes <= cache->stats.budget) {
+        while (cache->oldest && cache->stats.bytes + rendered->bytes > cache->stats.budget) {
+            cache_remove(cache, cache->oldest);
+            cache->stats.evictions++;
+        }
+        if (cache->stats.entries >= cache->bucket_count) cache_grow(cache);
+        
+        cache_entry_t** head = &cache->buckets[key & (uint64_t)(cache->bucket_count - 1)];
+        rendered->chain = *head;
+        *head = rendered;
+        cache_lru_push(cache, rendered);
+        rendered->cached = 1;
+        cache->stats.bytes += rendered->bytes;
+        cache->stats.entries++;
+    }
+    cache_unlock(cache);
+    return &rendered->sound;
+}
+
+const pfxr_cached_sound_t* pfxr_cache_get_template(pfxr_cache_t* cache, pfxr_template_t template, int seed) {
+    pfxr_sound_t config = pfxr_apply_template(template, seed);
+    return pfxr_cache_get(cache, &config);
+}
+
+// Drop a handle; the sound is freed once released by every holder and no
+// longer cached
+void pfxr_cache_release(pfxr_cache_t* cache, const pfxr_cached_sound_t* sound) {
+    if (!cache || !sound) return;
     
-    return (written == (size_t)wav_size) ? 0 : -1;
+    cache_entry_t* entry = (cache_entry_t*)sound;
+    cache_lock(cache);
+    int unused = --entry->refs == 0 && !entry->cached;
+    cache_unlock(cache);
+    if (unused) cache_entry_free(entry);
 }
 
-// Free WAV data allocated by pfxr_create_wav_data
-void pfxr_free_wav_data(char* wav_data) {
-    if (wav_data) {
-        free(wav_data);
+// Evict every sound (held ones stay valid until released)
+void pfxr_cache_clear(pfxr_cache_t* cache) {
+    if (!cache) return;
+    
+    cache_lock(cache);
+    while (cache->oldest) {
+        cache_remove(cache, cache->oldest);
+        cache->stats.evictions++;
     }
+    cache_unlock(cache);
+}
+
+void pfxr_cache_stats(pfxr_cache_t* cache, pfxr_cache_stats_t* stats) {
+    if (!cache || !stats) return;
+    
+    cache_lock(cache);
+    *stats = cache->stats;
+    cache_unlock(cache);
+}
+
+// Destroy the cache; every handle must have been released
+void pfxr_cache_destroy(pfxr_cache_t* cache) {
+    if (!cache) return;
+    
+    while (cache->oldest) cache_remove(cache, cache->oldest);
+#ifdef PFXR_THREADS
+    pthread_mutex_destroy(&cache->lock);
+#endif
+    PFXR_FREE(cache->directory);
+    PFXR_FREE(cache->buckets);
+    PFXR_FREE(cache);
 }
 
 // ============================================================================
-// URL IMPLEMENTATION
+// SOUND BANK IMPLEMENTATION
 // ============================================================================
 
-// Helper function to URL decode a string
-static char* url_decode(const char* encoded) {
-    if (!encoded) return NULL;
-
-    size_t len = strlen(encoded);
-    char* decoded = malloc(len + 1);
-    if (!decoded) return NULL;
-
-    size_t i = 0, j = 0;
-    while (i < len) {
-        if (encoded[i] == '%' && i + 2 < len) {
-            // Convert hex to char
-            char hex[3] = {encoded[i+1], encoded[i+2], '\0'};
-            char* endptr;
-            long val = strtol(hex, &endptr, 16);
-            if (*endptr == '\0') {
-                decoded[j++] = (char)val;
-                i += 3;
-            } else {
-                decoded[j++] = encoded[i++];
-            }
-        } else if (encoded[i] == '+') {
-            decoded[j++] = ' ';
-            i++;
-        } else {
-            decoded[j++] = encoded[i++];
-        }
+// Bank layout (little-endian, every section 16-byte aligned):
+//
+//   header | payloads | index | names
+//
+// The index holds one bank_entry_t per sound, sorted by name hash and then
+// name, so lookups are a binary search. Payloads come first so a builder
+// can stream them out and only keep the index in memory; the header is
+// rewritten with the index position once everything is written.
+
+#define PFXR_BANK_MAGIC "PFXB"
+#define PFXR_BANK_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+    uint64_t index_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t file_size;
+} bank_header_t;
+
+typedef struct {
+    uint64_t name_hash;
+    uint64_t offset;                // Payload position in the file
+    uint64_t checksum;              // FNV-1a of the payload
+    uint32_t size;                  // Payload bytes
+    uint32_t sample_count;
+    uint32_t sample_rate;
+    uint32_t format;
+    uint32_t name_offset;           // Into the name table, NUL-terminated
+    uint32_t name_length;
+    pfxr_sound_t config;
+} bank_entry_t;
+
+#define PFXR_BANK_ALIGN(n) (((n) + 15) & ~(uint64_t)15)
+#define PFXR_BANK_DATA PFXR_BANK_ALIGN(sizeof(bank_header_t))
+
+struct pfxr_bank {
+    const char* data;
+    size_t size;
+    const bank_entry_t* index;
+    const char* names;
+    int count;
+    void* map;                      // mmap of the file, if mapped
+    int owned;                      // data was read into a heap buffer
+};
+
+struct pfxr_bank_builder {
+    FILE* file;
+    char* path;
+    char* temp_path;
+    uint64_t offset;                // End of the payloads written so far
+    bank_entry_t* entries;
+    int count;
+    int capacity;
+    char* names;
+    size_t names_size;
+    size_t names_capacity;
+    int failed;
+};
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
     }
-    decoded[j] = '\0';
-    return decoded;
+    return hash;
 }
 
-// Helper function to URL encode a string
-static char* url_encode(const char* str) {
-    if (!str) return NULL;
+static uint64_t bank_name_hash(const char* name) {
+    uint64_t hash = hash_bytes(0xcbf29ce484222325ull, name, strlen(name));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
 
-    size_t len = strlen(str);
-    // Worst case: every character needs encoding (3 chars each)
-    char* encoded = malloc(len * 3 + 1);
-    if (!encoded) return NULL;
+static int bank_sample_size(pfxr_bank_format_t format) {
+    switch (format) {
+        case PFXR_BANK_PCM16: return (int)sizeof(int16_t);
+        case PFXR_BANK_FLOAT32: return (int)sizeof(float);
+        case PFXR_BANK_PCM8: return (int)sizeof(uint8_t);
+        case PFXR_BANK_PCM24: return 3;
+    }
+    return 0;
+}
 
-    size_t j = 0;
-    for (size_t i = 0; i < len; i++) {
-        char c = str[i];
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            encoded[j++] = c;
-        } else if (c == ' ') {
-            encoded[j++] = '+';
-        } else {
-            sprintf(&encoded[j], "%%%02X", (unsigned char)c);
-            j += 3;
+// Check that an image is a complete, well-formed bank
+static int bank_validate(const char* data, size_t size) {
+    if (size < PFXR_BANK_DATA) return -1;
+    
+    const bank_header_t* header = (const bank_header_t*)data;
+    if (memcmp(header->magic, PFXR_BANK_MAGIC, 4) != 0 || header->version != PFXR_BANK_VERSION) return -1;
+    if (header->file_size != size || header->index_offset % 16 != 0) return -1;
+    if (header->index_offset > size || header->entry_count > (size - header->index_offset) / sizeof(bank_entry_t)) {
+        return -1;
+    }
+    if (header->names_offset > size || header->names_size > size - header->names_offset) return -1;
+    
+    const bank_entry_t* index = (const bank_entry_t*)(data + header->index_offset);
+    const char* names = data + header->names_offset;
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        const bank_entry_t* entry = &index[i];
+        int sample_size = bank_sample_size((pfxr_bank_format_t)entry->format);
+        if (!sample_size || entry->offset % 16 != 0 || entry->offset > size || entry->size > size - entry->offset) {
+            return -1;
+        }
+        if ((uint64_t)entry->sample_count * sample_size != entry->size) return -1;
+        if ((uint64_t)entry->name_offset + entry->name_length >= header->names_size ||
+            names[entry->name_offset + entry->name_length] != '\0') {
+            return -1;
         }
+        if (i > 0 && index[i - 1].name_hash > entry->name_hash) return -1;
     }
-    encoded[j] = '\0';
-    return encoded;
+    return 0;
 }
 
-// Helper function to find query parameter value
-static char* get_query_param(const char* url, const char* param) {
-    if (!url || !param) return NULL;
+static pfxr_bank_t* bank_create(const char* data, size_t size) {
+    if (bank_validate(data, size) != 0) return NULL;
+    
+    pfxr_bank_t* bank = (pfxr_bank_t*)PFXR_MALLOC(sizeof(pfxr_bank_t));
+    if (!bank) return NULL;
+    
+    const bank_header_t* header = (const bank_header_t*)data;
+    memset(bank, 0, sizeof(*bank));
+    bank->data = data;
+    bank->size = size;
+    bank->index = (const bank_entry_t*)(data + header->index_offset);
+    bank->names = data + header->names_offset;
+    bank->count = (int)header->entry_count;
+    return bank;
+}
 
-    // Find the start of query string
-    const char* query_start = strchr(url, '?');
-    if (!query_start) return NULL;
-    query_start++; // Skip the '?'
+// Open a bank image the caller keeps alive (and 16-byte aligned) until
+// pfxr_bank_close
+pfxr_bank_t* pfxr_bank_open_memory(const void* data, size_t size) {
+    if (!data || ((uintptr_t)data & 15) != 0) return NULL;
+    return bank_create((const char*)data, size);
+}
 
-    // Look for the parameter
-    char param_with_eq[256];
-    snprintf(param_with_eq, sizeof(param_with_eq), "%s=", param);
+// Open a bank file: one mmap where available, otherwise one read
+pfxr_bank_t* pfxr_bank_open(const char* path) {
+    if (!path) return NULL;
+    
+#ifdef PFXR_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    
+    pfxr_bank_t* bank = bank_create((const char*)map, (size_t)info.st_size);
+    if (!bank) {
+        munmap(map, (size_t)info.st_size);
+        return NULL;
+    }
+    bank->map = map;
+    return bank;
+#else
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    
+    char* data = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (char*)PFXR_MALLOC((size_t)size);
+        if (data && fread(data, 1, (size_t)size, file) != (size_t)size) {
+            PFXR_FREE(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    if (!data) return NULL;
+    
+    pfxr_bank_t* bank = bank_create(data, (size_t)size);
+    if (!bank) {
+        PFXR_FREE(data);
+        return NULL;
+    }
+    bank->owned = 1;
+    return bank;
+#endif
+}
 
-    const char* param_pos = strstr(query_start, param_with_eq);
-    if (!param_pos) return NULL;
+void pfxr_bank_close(pfxr_bank_t* bank) {
+    if (!bank) return;
+    
+#ifdef PFXR_MMAP
+    if (bank->map) munmap(bank->map, bank->size);
+#endif
+    if (bank->owned) PFXR_FREE((void*)bank->data);
+    PFXR_FREE(bank);
+}
 
-    // Move to start of value
-    const char* value_start = param_pos + strlen(param_with_eq);
+int pfxr_bank_count(const pfxr_bank_t* bank) {
+    return bank ? bank->count : 0;
+}
 
-    // Find end of value (next & or end of string)
-    const char* value_end = value_start;
-    while (*value_end && *value_end != '&' && *value_end != '#') {
-        value_end++;
+// Index of the sound called name, or -1
+int pfxr_bank_find(const pfxr_bank_t* bank, const char* name) {
+    if (!bank || !name) return -1;
+    
+    uint64_t hash = bank_name_hash(name);
+    int low = 0;
+    int high = bank->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (bank->index[mid].name_hash < hash) low = mid + 1;
+        else high = mid;
     }
+    for (int i = low; i < bank->count && bank->index[i].name_hash == hash; i++) {
+        if (strcmp(bank->names + bank->index[i].name_offset, name) == 0) return i;
+    }
+    return -1;
+}
 
-    // Copy the value
-    size_t value_len = value_end - value_start;
-    char* value = malloc(value_len + 1);
-    if (!value) return NULL;
-
-    strncpy(value, value_start, value_len);
-    value[value_len] = '\0';
+int pfxr_bank_get(const pfxr_bank_t* bank, int index, pfxr_bank_sound_t* sound) {
+    if (!bank || !sound || index < 0 || index >= bank->count) return -1;
+    
+    const bank_entry_t* entry = &bank->index[index];
+    sound->name = bank->names + entry->name_offset;
+    sound->data = bank->data + entry->offset;
+    sound->size = (int)entry->size;
+    sound->sample_count = (int)entry->sample_count;
+    sound->sample_rate = (int)entry->sample_rate;
+    sound->format = (pfxr_bank_format_t)entry->format;
+    sound->config = entry->config;
+    return 0;
+}
 
-    return value;
+// Check a sound's samples against the checksum written with them. Returns
+// 0 if they match, -1 if the data is damaged or index is out of range.
+int pfxr_bank_verify(const pfxr_bank_t* bank, int index) {
+    if (!bank || index < 0 || index >= bank->count) return -1;
+    
+    const bank_entry_t* entry = &bank->index[index];
+    uint64_t checksum = hash_bytes(0xcbf29ce484222325ull, bank->data + entry->offset, entry->size);
+    return checksum == entry->checksum ? 0 : -1;
 }
 
-// Helper function to set sound field by index
-static void set_sound_field(pfxr_sound_t* sound, int index, float value) {
-    switch (index) {
-        case 0: sound->waveForm = (int)value; break;
-        case 1: sound->volume = value; break;
-        case 2: sound->attackTime = value; break;
-        case 3: sound->sustainTime = value; break;
-        case 4: sound->sustainPunch = value; break;
-        case 5: sound->decayTime = value; break;
-        case 6: sound->frequency = value; break;
-        case 7: sound->pitchDelta = value; break;
-        case 8: sound->pitchDuration = value; break;
-        case 9: sound->pitchDelay = value; break;
-        case 10: sound->vibratoRate = value; break;
-        case 11: sound->vibratoDepth = value; break;
-        case 12: sound->tremoloRate = value; break;
-        case 13: sound->tremoloDepth = value; break;
-        case 14: sound->highPassCutoff = value; break;
-        case 15: sound->highPassResonance = value; break;
-        case 16: sound->lowPassCutoff = value; break;
-        case 17: sound->lowPassResonance = value; break;
-        case 18: sound->phaserBaseFrequency = value; break;
-        case 19: sound->phaserLfoFrequency = value; break;
-        case 20: sound->phaserDepth = value; break;
-        case 21: sound->noiseAmount = value; break;
-        default: break; // Ignore unknown indices
+static char* bank_strdup(const char* str, const char* suffix) {
+    size_t length = strlen(str);
+    size_t suffix_length = strlen(suffix);
+    char* copy = (char*)PFXR_MALLOC(length + suffix_length + 1);
+    if (copy) {
+        memcpy(copy, str, length);
+        memcpy(copy + length, suffix, suffix_length + 1);
     }
+    return copy;
 }
 
-// Helper function to get sound field by index
-static float get_sound_field(const pfxr_sound_t* sound, int index) {
-    switch (index) {
-        case 0: return (float)sound->waveForm;
-        case 1: return sound->volume;
-        case 2: return sound->attackTime;
-        case 3: return sound->sustainTime;
-        case 4: return sound->sustainPunch;
-        case 5: return sound->decayTime;
-        case 6: return sound->frequency;
-        case 7: return sound->pitchDelta;
-        case 8: return sound->pitchDuration;
-        case 9: return sound->pitchDelay;
-        case 10: return sound->vibratoRate;
-        case 11: return sound->vibratoDepth;
-        case 12: return sound->tremoloRate;
-        case 13: return sound->tremoloDepth;
-        case 14: return sound->highPassCutoff;
-        case 15: return sound->highPassResonance;
-        case 16: return sound->lowPassCutoff;
-        case 17: return sound->lowPassResonance;
-        case 18: return sound->phaserBaseFrequency;
-        case 19: return sound->phaserLfoFrequency;
-        case 20: return sound->phaserDepth;
-        case 21: return sound->noiseAmount;
-        default: return 0.0f;
+// Start a bank at path. Sounds are written to path.tmp as they are added
+// and the finished bank is renamed into place, so readers never see a
+// partial bank.
+pfxr_bank_builder_t* pfxr_bank_builder_create(const char* path) {
+    if (!path) return NULL;
+    
+    pfxr_bank_builder_t* builder = (pfxr_bank_builder_t*)PFXR_MALLOC(sizeof(pfxr_bank_builder_t));
+    if (!builder) return NULL;
+    
+    memset(builder, 0, sizeof(*builder));
+    builder->path = bank_strdup(path, "");
+    builder->temp_path = bank_strdup(path, ".tmp");
+    if (builder->path && builder->temp_path) {
+        builder->file = fopen(builder->temp_path, "wb");
+    }
+    if (!builder->file) {
+        PFXR_FREE(builder->path);
+        PFXR_FREE(builder->temp_path);
+        PFXR_FREE(builder);
+        return NULL;
     }
+    
+    // Placeholder header, rewritten by finish
+    char header[PFXR_BANK_DATA];
+    memset(header, 0, sizeof(header));
+    if (fwrite(header, 1, sizeof(header), builder->file) != sizeof(header)) builder->failed = 1;
+    builder->offset = PFXR_BANK_DATA;
+    return builder;
 }
 
-// Number of fields in the sound structure
-#define PFXR_FIELD_COUNT 22
-
-pfxr_sound_t* pfxr_create_params_from_url(const char* url) {
-    if (!url) return NULL;
-
-    // Allocate memory for the sound configuration
-    pfxr_sound_t* sound = malloc(sizeof(pfxr_sound_t));
-    if (!sound) return NULL;
-
-    // Initialize with default values
-    *sound = pfxr_get_default_sound();
+// Write zeros up to the next 16-byte boundary
+static void bank_builder_pad(pfxr_bank_builder_t* builder) {
+    static const char zeros[16] = {0};
+    size_t padding = (size_t)(PFXR_BANK_ALIGN(builder->offset) - builder->offset);
+    if (padding && fwrite(zeros, 1, padding, builder->file) != padding) builder->failed = 1;
+    builder->offset += padding;
+}
 
-    // Get the 'fx' query parameter
-    char* fx_param = get_query_param(url, "fx");
-    if (!fx_param) {
-        return sound; // Return default sound if no fx parameter
+// Add already-rendered samples. The data is written out at once, so the
+// builder only keeps the index in memory.
+int pfxr_bank_builder_add_data(pfxr_bank_builder_t* builder, const char* name, const pfxr_sound_t* config,
+                               pfxr_bank_format_t format, int sample_rate, const void* data, int sample_count) {
+    int sample_size = bank_sample_size(format);
+    if (!builder || builder->failed || !name || !config || !sample_size || sample_count < 0 ||
+        (sample_count > 0 && !data) || sample_count > INT32_MAX / sample_size) {
+        return -1;
     }
-
-    // URL decode the parameter
-    char* decoded = url_decode(fx_param);
-    free(fx_param);
-    if (!decoded) {
-        return sound; // Return default sound if decoding fails
+    
+    size_t name_length = strlen(name);
+    if (builder->names_size + name_length + 1 > UINT32_MAX) return -1;
+    
+    if (builder->count == builder->capacity) {
+        int capacity = builder->capacity ? builder->capacity * 2 : 64;
+        bank_entry_t* entries = (bank_entry_t*)PFXR_REALLOC(builder->entries, capacity * sizeof(bank_entry_t));
+        if (!entries) return -1;
+        builder->entries = entries;
+        builder->capacity = capacity;
+    }
+    if (builder->names_size + name_length + 1 > builder->names_capacity) {
+        size_t capacity = builder->names_capacity ? builder->names_capacity * 2 : 4096;
+        while (capacity < builder->names_size + name_length + 1) capacity *= 2;
+        char* names = (char*)PFXR_REALLOC(builder->names, capacity);
+        if (!names) return -1;
+        builder->names = names;
+        builder->names_capacity = capacity;
     }
+    
+    size_t size = (size_t)sample_count * sample_size;
+    if (size && fwrite(data, 1, size, builder->file) != size) {
+        builder->failed = 1;
+        return -1;
+    }
+    
+    bank_entry_t* entry = &builder->entries[builder->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->name_hash = bank_name_hash(name);
+    entry->offset = builder->offset;
+    entry->checksum = hash_bytes(0xcbf29ce484222325ull, data, size);
+    entry->size = (uint32_t)size;
+    entry->sample_count = (uint32_t)sample_count;
+    entry->sample_rate = (uint32_t)sample_rate;
+    entry->format = (uint32_t)format;
+    entry->name_offset = (uint32_t)builder->names_size;
+    entry->name_length = (uint32_t)name_length;
+    entry->config = *config;
+    
+    memcpy(builder->names + builder->names_size, name, name_length + 1);
+    builder->names_size += name_length + 1;
+    builder->offset += size;
+    bank_builder_pad(builder);
+    return builder->failed ? -1 : 0;
+}
 
-    // Split by comma and parse values
-    char* token = strtok(decoded, ",");
-    int index = 0;
+// Render a config to 16-bit PCM and add it
+int pfxr_bank_builder_add(pfxr_bank_builder_t* builder, const char* name, const pfxr_sound_t* config) {
+    if (!builder || !config) return -1;
+    
+    int wav_size = 0;
+    char* wav_data = render_wav_data(NULL, config, &wav_size);
+    int sample_count = wav_data ? (wav_size - (int)sizeof(pfxr_wav_header_t)) / (int)sizeof(int16_t) : 0;
+    if (!wav_data && pfxr_sound_sample_count(config) > 0) return -1;
+    
+    int result = pfxr_bank_builder_add_data(builder, name, config, PFXR_BANK_PCM16, PFXR_SAMPLE_RATE,
+                                            wav_data ? wav_data + sizeof(pfxr_wav_header_t) : NULL, sample_count);
+    PFXR_FREE(wav_data);
+    return result;
+}
 
-    while (token && index < PFXR_FIELD_COUNT) {
-        char* endptr;
-        float value = strtof(token, &endptr);
+// Sort by name hash for pfxr_bank_find, which compares names within a run
+// of equal hashes; ties keep the order sounds were added in
+static int compare_bank_entries(const void* a, const void* b) {
+    const bank_entry_t* ea = (const bank_entry_t*)a;
+    const bank_entry_t* eb = (const bank_entry_t*)b;
+    if (ea->name_hash != eb->name_hash) return ea->name_hash < eb->name_hash ? -1 : 1;
+    return ea->name_offset < eb->name_offset ? -1 : ea->name_offset > eb->name_offset;
+}
 
-        // Only set the value if it's a valid number
-        if (*endptr == '\0' || *endptr == ' ') {
-            set_sound_field(sound, index, value);
-        }
+static void bank_builder_free(pfxr_bank_builder_t* builder) {
+    PFXR_FREE(builder->entries);
+    PFXR_FREE(builder->names);
+    PFXR_FREE(builder->path);
+    PFXR_FREE(builder->temp_path);
+    PFXR_FREE(builder);
+}
 
-        token = strtok(NULL, ",");
-        index++;
+// Write the index and name table, then move the bank into place. Fails
+// (leaving no bank) on write errors or duplicate names. Frees the builder.
+int pfxr_bank_builder_finish(pfxr_bank_builder_t* builder) {
+    if (!builder) return -1;
+    
+    if (builder->count > 1) {
+        qsort(builder->entries, builder->count, sizeof(bank_entry_t), compare_bank_entries);
+    }
+    for (int i = 0; i < builder->count; i++) {
+        const bank_entry_t* entry = &builder->entries[i];
+        for (int j = i + 1; j < builder->count && builder->entries[j].name_hash == entry->name_hash; j++) {
+            if (strcmp(builder->names + entry->name_offset, builder->names + builder->entries[j].name_offset) == 0) {
+                builder->failed = 1;
+            }
+        }
+    }
+    
+    bank_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PFXR_BANK_MAGIC, 4);
+    header.version = PFXR_BANK_VERSION;
+    header.entry_count = (uint32_t)builder->count;
+    header.index_offset = builder->offset;
+    header.names_offset = builder->offset + (uint64_t)builder->count * sizeof(bank_entry_t);
+    header.names_size = builder->names_size;
+    header.file_size = header.names_offset + builder->names_size;
+    
+    size_t index_size = builder->count * sizeof(bank_entry_t);
+    if (!builder->failed &&
+        (fwrite(builder->entries, 1, index_size, builder->file) != index_size ||
+         fwrite(builder->names, 1, builder->names_size, builder->file) != builder->names_size ||
+         fseek(builder->file, 0, SEEK_SET) != 0 ||
+         fwrite(&header, 1, sizeof(header), builder->file) != sizeof(header))) {
+        builder->failed = 1;
     }
+    if (fclose(builder->file) != 0) builder->failed = 1;
+    
+    int result = 0;
+    if (builder->failed || rename(builder->temp_path, builder->path) != 0) {
+        remove(builder->temp_path);
+        result = -1;
+    }
+    bank_builder_free(builder);
+    return result;
+}
 
-    free(decoded);
-    return sound;
+// Abandon a bank, removing its partial file
+void pfxr_bank_builder_discard(pfxr_bank_builder_t* builder) {
+    if (!builder) return;
+    
+    fclose(builder->file);
+    remove(builder->temp_path);
+    bank_builder_free(builder);
 }
 
-char* pfxr_get_url_from_params(const pfxr_sound_t* config) {
-    if (!config) return NULL;
+// ============================================================================
+// MIXER IMPLEMENTATION
+// ============================================================================
 
-    // Calculate buffer size needed
-    // Each float can be up to ~15 characters, plus comma
-    size_t buffer_size = PFXR_FIELD_COUNT * 16 + 100; // Extra space for URL parts
-    char* url_buffer = malloc(buffer_size);
-    if (!url_buffer) return NULL;
+#if (PFXR_MIXER_QUEUE & (PFXR_MIXER_QUEUE - 1)) != 0
+#error "PFXR_MIXER_QUEUE must be a power of two"
+#endif
 
-    // Create comma-separated values string
-    char values_buffer[PFXR_FIELD_COUNT * 16];
-    values_buffer[0] = '\0';
+typedef enum {
+    MIXER_TRIGGER,
+    MIXER_STOP_ALL
+} mixer_command_kind_t;
 
-    for (int i = 0; i < PFXR_FIELD_COUNT; i++) {
-        float value = get_sound_field(config, i);
-        char value_str[16];
+// Queue cell of a bounded multi-producer queue. sequence equals the
+// position while the cell is free for the producer claiming it, and the
+// position + 1 once the command is filled in.
+typedef struct {
+    uint32_t sequence;
+    mixer_command_kind_t kind;
+    pfxr_sound_t config;
+    float gain;
+    float pan;
+    int priority;
+} mixer_command_t;
 
-        // Format the value, removing unnecessary decimal places
-        if (i == 0) { // waveForm is an integer
-            snprintf(value_str, sizeof(value_str), "%d", (int)value);
-        } else {
-            snprintf(value_str, sizeof(value_str), "%.6g", value);
-        }
+typedef struct {
+    pfxr_generator_t gen;
+    float left;             // Gain and pan folded into per-channel gains
+    float right;
+    int priority;
+    uint32_t serial;        // Trigger order, to steal the oldest first
+    int active;
+} mixer_voice_t;
 
-        if (i > 0) {
-            strcat(values_buffer, ",");
-        }
-        strcat(values_buffer, value_str);
-    }
+struct pfxr_mixer {
+    mixer_voice_t* voices;
+    int voice_count;
+    int sample_rate;
+    uint32_t serial;
+    mixer_command_t queue[PFXR_MIXER_QUEUE];
+    uint32_t tail;          // Next cell for producers, claimed by CAS
+    uint32_t head;          // Next cell for the renderer
+    pfxr_mixer_stats_t stats;
+};
 
-    // URL encode the values
-    char* encoded_values = url_encode(values_buffer);
-    if (!encoded_values) {
-        free(url_buffer);
+// Create a mixer with a fixed number of voices, all allocated up front.
+// Voices render at sample_rate, 0 for PFXR_SAMPLE_RATE.
+pfxr_mixer_t* pfxr_mixer_create(int voices, int sample_rate) {
+    if (voices <= 0) return NULL;
+    
+    pfxr_mixer_t* mixer = (pfxr_mixer_t*)PFXR_MALLOC(sizeof(pfxr_mixer_t));
+    if (!mixer) return NULL;
+    memset(mixer, 0, sizeof(*mixer));
+    
+    mixer->voices = (mixer_voice_t*)PFXR_MALLOC((size_t)voices * sizeof(mixer_voice_t));
+    if (!mixer->voices) {
+        PFXR_FREE(mixer);
         return NULL;
     }
+    for (int i = 0; i < voices; i++) mixer->voices[i].active = 0;
+    mixer->voice_count = voices;
+    mixer->sample_rate = sample_rate;
+    mixer->stats.voices = voices;
+    
+    for (uint32_t i = 0; i < PFXR_MIXER_QUEUE; i++) mixer->queue[i].sequence = i;
+    return mixer;
+}
 
-    // Create the URL string with the fx parameter
-    snprintf(url_buffer, buffer_size, "?fx=%s", encoded_values);
-
-    free(encoded_values);
-    return url_buffer;
+void pfxr_mixer_destroy(pfxr_mixer_t* mixer) {
+    if (!mixer) return;
+    PFXR_FREE(mixer->voices);
+    PFXR_FREE(mixer);
 }
 
-void pfxr_free_sound_config(pfxr_sound_t* config) {
-    if (config) {
-        free(config);
+// Claim a queue cell and publish a command, returns -1 if the queue is full
+static int mixer_push(pfxr_mixer_t* mixer, mixer_command_kind_t kind, const pfxr_sound_t* config,
+                      float gain, float pan, int priority) {
+    uint32_t pos = PFXR_ATOMIC_LOAD(&mixer->tail);
+    mixer_command_t* cell;
+    for (;;) {
+        cell = &mixer->queue[pos & (PFXR_MIXER_QUEUE - 1)];
+        int32_t diff = (int32_t)(PFXR_ATOMIC_LOAD(&cell->sequence) - pos);
+        if (diff == 0) {
+            if (PFXR_ATOMIC_CAS(&mixer->tail, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            PFXR_ATOMIC_ADD(&mixer->stats.dropped, 1);
+            return -1;
+        } else {
+            pos = PFXR_ATOMIC_LOAD(&mixer->tail);
+        }
     }
+    
+    cell->kind = kind;
+    if (config) cell->config = *config;
+    cell->gain = gain;
+    cell->pan = pan;
+    cell->priority = priority;
+    PFXR_ATOMIC_STORE(&cell->sequence, pos + 1);
+    return 0;
 }
 
-// ============================================================================
-// MAIN API FUNCTIONS IMPLEMENTATION
-// ============================================================================
-
-// Main API function to create sound from template and return WAV data
-char* pfxr_create_sound_from_template(pfxr_template_t template, int seed) {
-    // Apply template to get sound configuration
-    pfxr_sound_t config = pfxr_apply_template(template, seed);
-    
-    // Generate sound from configuration
-    return pfxr_create_sound_from_config(&config);
+// Queue a sound to start at the next render. pan runs from -1 (left) to 1
+// (right) with constant power; when every voice is busy the lowest priority,
+// oldest voice is stolen, unless all of them outrank this trigger. Never
+// blocks; returns -1 if the queue is full.
+int pfxr_mixer_trigger(pfxr_mixer_t* mixer, const pfxr_sound_t* config, float gain, float pan, int priority) {
+    if (!mixer || !config) return -1;
+    return mixer_push(mixer, MIXER_TRIGGER, config, gain, pan, priority);
 }
 
-// Create sound from template and save to file
-int pfxr_create_sound_from_template_to_file(pfxr_template_t template, int seed, const char* filename) {
-    if (!filename) {
-        return -1;
-    }
-    
-    // Apply template to get sound configuration
-    pfxr_sound_t config = pfxr_apply_template(template, seed);
-    
-    // Generate sound from configuration and save to file
-    return pfxr_create_sound_from_config_to_file(&config, filename);
+// Queue a stop of every voice at the next render
+int pfxr_mixer_stop_all(pfxr_mixer_t* mixer) {
+    if (!mixer) return -1;
+    return mixer_push(mixer, MIXER_STOP_ALL, NULL, 0.0f, 0.0f, 0);
 }
 
-// Create sound from configuration and return WAV data
-char* pfxr_create_sound_from_config(const pfxr_sound_t* config) {
-    if (!config) {
-        return NULL;
-    }
+static void mixer_start(pfxr_mixer_t* mixer, const mixer_command_t* command) {
+    if (pfxr_sound_sample_count_rate(&command->config, mixer->sample_rate) <= 0) return;
     
-    // Create audio buffer
-    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
-    if (!buffer) {
-        return NULL;
+    // A free voice, or else the lowest priority and oldest one
+    mixer_voice_t* voice = NULL;
+    for (int i = 0; i < mixer->voice_count; i++) {
+        mixer_voice_t* candidate = &mixer->voices[i];
+        if (!candidate->active) {
+            voice = candidate;
+            break;
+        }
+        if (!voice || candidate->priority < voice->priority ||
+            (candidate->priority == voice->priority && (int32_t)(candidate->serial - voice->serial) < 0)) {
+            voice = candidate;
+        }
+    }
+    if (voice->active) {
+        if (voice->priority > command->priority) {
+            PFXR_ATOMIC_ADD(&mixer->stats.dropped, 1);
+            return;
+        }
+        PFXR_ATOMIC_ADD(&mixer->stats.stolen, 1);
     }
     
-    // Generate sound
-    pfxr_generate_sound(config, buffer);
-    
-    // Convert to WAV data
-    int wav_size;
-    char* wav_data = pfxr_create_wav_data(buffer->samples, buffer->sample_count, &wav_size);
-    
-    // Clean up
-    pfxr_free_audio_buffer(buffer);
-    
-    return wav_data;
+    float pan = command->pan < -1.0f ? -1.0f : command->pan > 1.0f ? 1.0f : command->pan;
+    float angle = (pan + 1.0f) * (float)(M_PI / 4.0);
+    voice->left = command->gain * cosf(angle);
+    voice->right = command->gain * sinf(angle);
+    voice->priority = command->priority;
+    voice->serial = mixer->serial++;
+    voice->active = 1;
+    pfxr_generator_init_rate(&voice->gen, &command->config, mixer->sample_rate);
+    PFXR_ATOMIC_ADD(&mixer->stats.triggered, 1);
 }
 
-// Create sound from configuration and save to file
-int pfxr_create_sound_from_config_to_file(const pfxr_sound_t* config, const char* filename) {
-    if (!config || !filename) {
-        return -1;
-    }
-    
-    // Create audio buffer
-    pfxr_audio_buffer_t* buffer = pfxr_create_audio_buffer(PFXR_MAX_SAMPLES);
-    if (!buffer) {
-        return -1;
+// Apply queued commands, at most one queue's worth so a render stays
+// bounded however fast other threads trigger
+static void mixer_drain(pfxr_mixer_t* mixer) {
+    for (int i = 0; i < PFXR_MIXER_QUEUE; i++) {
+        mixer_command_t* cell = &mixer->queue[mixer->head & (PFXR_MIXER_QUEUE - 1)];
+        if (PFXR_ATOMIC_LOAD(&cell->sequence) != mixer->head + 1) break;
+        
+        if (cell->kind == MIXER_STOP_ALL) {
+            for (int v = 0; v < mixer->voice_count; v++) mixer->voices[v].active = 0;
+        } else {
+            mixer_start(mixer, cell);
+        }
+        PFXR_ATOMIC_STORE(&cell->sequence, mixer->head + PFXR_MIXER_QUEUE);
+        mixer->head++;
     }
+}
+
+// Mix the next frames into out as interleaved stereo (2 * frames floats,
+// overwritten). Call from one thread at a time; it takes no locks and
+// allocates nothing. Returns the number of voices still playing.
+int pfxr_mixer_render(pfxr_mixer_t* mixer, float* out, int frames) {
+    if (!mixer || !out || frames <= 0) return 0;
     
-    // Generate sound
-    pfxr_generate_sound(config, buffer);
+    mixer_drain(mixer);
+    memset(out, 0, (size_t)frames * 2 * sizeof(float));
     
-    // Write to file
-    int result = pfxr_write_wav_file(filename, buffer->samples, buffer->sample_count);
+    float block[PFXR_RENDER_CHUNK];
+    int active = 0;
+    for (int v = 0; v < mixer->voice_count; v++) {
+        mixer_voice_t* voice = &mixer->voices[v];
+        if (!voice->active) continue;
+        
+        float left = voice->left;
+        float right = voice->right;
+        for (int done = 0; done < frames;) {
+            int n = frames - done < PFXR_RENDER_CHUNK ? frames - done : PFXR_RENDER_CHUNK;
+            int rendered = pfxr_generator_render(&voice->gen, block, n);
+            float* dst = out + (size_t)done * 2;
+            for (int k = 0; k < rendered; k++) {
+                dst[2 * k] += block[k] * left;
+                dst[2 * k + 1] += block[k] * right;
+            }
+            done += rendered;
+            if (rendered < n) break;
+        }
+        
+        if (pfxr_generator_remaining(&voice->gen) > 0) active++;
+        else voice->active = 0;
+    }
     
-    // Clean up
-    pfxr_free_audio_buffer(buffer);
+    PFXR_ATOMIC_STORE(&mixer->stats.active, active);
+    return active;
+}
+
+// Read the mixer counters; safe from any thread
+void pfxr_mixer_stats(pfxr_mixer_t* mixer, pfxr_mixer_stats_t* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!mixer) return;
     
-    return result;
+    stats->triggered = PFXR_ATOMIC_LOAD(&mixer->stats.triggered);
+    stats->stolen = PFXR_ATOMIC_LOAD(&mixer->stats.stolen);
+    stats->dropped = PFXR_ATOMIC_LOAD(&mixer->stats.dropped);
+    stats->active = PFXR_ATOMIC_LOAD(&mixer->stats.active);
+    stats->voices = mixer->voice_count;
 }
 
 #endif // PFXR_IMPLEMENTATION
@@ -0,0 +1,578 @@
+// pfxr-bank: render a manifest of sounds into one packed sound bank
+//
+// Manifest lines (blank lines and # comments are ignored):
+//
+//   <template> <seed>[-<last seed>]    sounds named <template>_<seed>
+//   url <name> <url>                   a sound from a ?fx= URL
+//
+// Sounds render in parallel with pfxr_render_batch. Next to the bank,
+// BANK.hashes lists every sound's pfxr_sound_hash; a rebuild copies sounds
+// whose hash has not changed from the previous bank instead of rendering
+// them again.
+//
+// --format picks the sample format sounds are stored in: pcm16 (the
+// default), pcm8, pcm24 or float.
+//
+// For render farms, --shard I/N builds only every Nth sound of the
+// manifest, starting at the Ith, so N nodes render disjoint slices. The
+// merge command combines the shard banks into one. It checks that every
+// shard of the same manifest is present, that each shard holds exactly
+// the sounds its hashes list, and that every payload matches its checksum.
+//
+// Usage: pfxr-bank [-j THREADS] [--format FORMAT] [--shard I/N] -o BANK MANIFEST
+//        pfxr-bank merge -o BANK SHARD_BANK...
+
+#define _POSIX_C_SOURCE 199309L
+#define PFXR_IMPLEMENTATION
+#include "../pfxr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Hashes only carry over between builds with the same renderer output
+#define HASHES_VERSION 1
+#define RENDER_CHUNK 256        // Sounds rendered per batch
+#define MAX_LINE 8192
+
+typedef struct {
+    char* name;
+    pfxr_sound_t config;
+    uint64_t key;
+} job_t;
+
+typedef struct {
+    char* name;
+    uint64_t key;
+} old_hash_t;
+
+static const char* template_names[] = {
+    "default", "pickup", "laser", "jump", "fall", "powerup",
+    "explosion", "blip", "hit", "fart", "random"
+};
+#define TEMPLATE_COUNT ((int)(sizeof(template_names) / sizeof(template_names[0])))
+
+static job_t* jobs;
+static int job_count = 0;
+static int job_capacity = 0;
+
+static const char* format_names[] = { "pcm16", "float", "pcm8", "pcm24" };
+#define FORMAT_COUNT ((int)(sizeof(format_names) / sizeof(format_names[0])))
+
+// Sample format of rendered sounds
+static pfxr_sample_format_t sample_format = PFXR_FORMAT_PCM16;
+
+// This build's slice of the manifest, and what identifies the manifest
+static int shard_index = 0;
+static int shard_count = 1;
+static int manifest_sounds = 0;
+static uint64_t manifest_digest = 0xcbf29ce484222325ull;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static char* copy_string(const char* str) {
+    size_t length = strlen(str);
+    char* copy = (char*)malloc(length + 1);
+    if (copy) memcpy(copy, str, length + 1);
+    return copy;
+}
+
+static int push_job(const char* name, const pfxr_sound_t* config, uint64_t key) {
+    if (job_count == job_capacity) {
+        int capacity = job_capacity ? job_capacity * 2 : 256;
+        job_t* grown = (job_t*)realloc(jobs, capacity * sizeof(job_t));
+        if (!grown) return -1;
+        jobs = grown;
+        job_capacity = capacity;
+    }
+    
+    job_t* job = &jobs[job_count];
+    job->name = copy_string(name);
+    if (!job->name) return -1;
+    job->config = *config;
+    job->key = key;
+    job_count++;
+    return 0;
+}
+
+// Every manifest sound goes into the digest; only this shard's are built
+static int add_job(const char* name, const pfxr_sound_t* config) {
+    uint64_t key = pfxr_sound_hash(config);
+    manifest_digest = hash_bytes(manifest_digest, name, strlen(name) + 1);
+    manifest_digest = hash_bytes(manifest_digest, &key, sizeof(key));
+    if (manifest_sounds++ % shard_count != shard_index) return 0;
+    return push_job(name, config, key);
+}
+
+static int find_template(const char* name) {
+    for (int t = 0; t < TEMPLATE_COUNT; t++) {
+        if (strcmp(template_names[t], name) == 0) return t;
+    }
+    return -1;
+}
+
+// ============================================================================
+// MANIFEST
+// ============================================================================
+
+static int parse_line(char* line, const char* path, int line_number) {
+    char* comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+    
+    char* word = strtok(line, " \t\r\n");
+    if (!word) return 0;
+    
+    if (strcmp(word, "url") == 0) {
+        char* name = strtok(NULL, " \t\r\n");
+        char* url = strtok(NULL, " \t\r\n");
+        pfxr_sound_t* config = url ? pfxr_create_params_from_url(url) : NULL;
+        if (!name || !config) {
+            fprintf(stderr, "%s:%d: expected: url <name> <url>\n", path, line_number);
+            pfxr_free_sound_config(config);
+            return -1;
+        }
+        int result = add_job(name, config);
+        pfxr_free_sound_config(config);
+        return result;
+    }
+    
+    int template = find_template(word);
+    char* range = strtok(NULL, " \t\r\n");
+    long first = 0, last = 0;
+    char* end = NULL;
+    if (range) {
+        first = strtol(range, &end, 10);
+        last = first;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+    }
+    if (template < 0 || !range || *end != '\0' || first < 1 || last < first || last > INT32_MAX) {
+        fprintf(stderr, "%s:%d: expected: <template> <seed>[-<last seed>] (seeds from 1)\n", path, line_number);
+        return -1;
+    }
+    
+    for (long seed = first; seed <= last; seed++) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s_%ld", word, seed);
+        pfxr_sound_t config = pfxr_apply_template((pfxr_template_t)template, (int)seed);
+        if (add_job(name, &config) != 0) return -1;
+    }
+    return 0;
+}
+
+static int read_manifest(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open manifest %s\n", path);
+        return -1;
+    }
+    
+    char line[MAX_LINE];
+    int line_number = 0;
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), file)) {
+        result = parse_line(line, path, ++line_number);
+    }
+    fclose(file);
+    return result;
+}
+
+// ============================================================================
+// INCREMENTAL REBUILDS
+// ============================================================================
+
+static old_hash_t* old_hashes;
+static int old_hash_count = 0;
+
+static int compare_old_hashes(const void* a, const void* b) {
+    return strcmp(((const old_hash_t*)a)->name, ((const old_hash_t*)b)->name);
+}
+
+// Sounds only carry over within one format; 16-bit builds keep the header
+// older versions wrote
+static void hashes_header(char* header, size_t size) {
+    int length = snprintf(header, size, "# pfxr-bank hashes %d render %d rate %d", HASHES_VERSION,
+                          PFXR_RENDER_VERSION, PFXR_SAMPLE_RATE);
+    if (sample_format != PFXR_FORMAT_PCM16) {
+        length += snprintf(header + length, size - length, " format %s", format_names[sample_format]);
+    }
+    snprintf(header + length, size - length, "\n");
+}
+
+// Load BANK.hashes from the previous build, if any
+static void read_hashes(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+    
+    char header[128];
+    char line[MAX_LINE];
+    int capacity = 0;
+    hashes_header(header, sizeof(header));
+    if (!fgets(line, sizeof(line), file) || strcmp(line, header) != 0) {
+        fclose(file);
+        return;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        unsigned long long key;
+        char name[MAX_LINE];
+        if (sscanf(line, "%16llx %8191s", &key, name) != 2) continue;
+        if (old_hash_count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            old_hash_t* grown = (old_hash_t*)realloc(old_hashes, capacity * sizeof(old_hash_t));
+            if (!grown) break;
+            old_hashes = grown;
+        }
+        old_hashes[old_hash_count].name = copy_string(name);
+        old_hashes[old_hash_count].key = (uint64_t)key;
+        if (old_hashes[old_hash_count].name) old_hash_count++;
+    }
+    fclose(file);
+    
+    if (old_hash_count > 1) qsort(old_hashes, old_hash_count, sizeof(old_hash_t), compare_old_hashes);
+}
+
+// Index of a job's unchanged sound in the previous bank, or -1
+static int find_reusable(const pfxr_bank_t* old_bank, const job_t* job) {
+    if (!old_bank) return -1;
+    
+    old_hash_t probe = { job->name, 0 };
+    old_hash_t* old = (old_hash_t*)bsearch(&probe, old_hashes, old_hash_count, sizeof(old_hash_t),
+                                           compare_old_hashes);
+    if (!old || old->key != job->key) return -1;
+    return pfxr_bank_find(old_bank, job->name);
+}
+
+static int write_hashes(const char* path) {
+    char temp[4096 + 16];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE* file = fopen(temp, "w");
+    if (!file) return -1;
+    
+    char header[128];
+    hashes_header(header, sizeof(header));
+    int ok = fputs(header, file) >= 0;
+    ok = ok && fprintf(file, "# shard %d/%d sounds %d manifest %016llx\n", shard_index, shard_count,
+                       manifest_sounds, (unsigned long long)manifest_digest) > 0;
+    for (int i = 0; ok && i < job_count; i++) {
+        ok = fprintf(file, "%016llx %s\n", (unsigned long long)jobs[i].key, jobs[i].name) > 0;
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temp, path) != 0) {
+        remove(temp);
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+// Render or copy jobs [first, first + count) into the bank
+static int build_chunk(pfxr_bank_builder_t* builder, const pfxr_bank_t* old_bank, int first, int count,
+                       int threads, int* rendered) {
+    int reuse[RENDER_CHUNK];
+    pfxr_sound_t configs[RENDER_CHUNK];
+    int render_count = 0;
+    
+    for (int i = 0; i < count; i++) {
+        reuse[i] = find_reusable(old_bank, &jobs[first + i]);
+        if (reuse[i] < 0) configs[render_count++] = jobs[first + i].config;
+    }
+    
+    pfxr_batch_opts_t opts = { threads, PFXR_BATCH_WAV, PFXR_SAMPLE_RATE, sample_format, 0, 0 };
+    pfxr_batch_result_t* results = NULL;
+    if (render_count > 0) {
+        results = pfxr_render_batch(configs, render_count, &opts);
+        if (!results) return -1;
+    }
+    
+    int result = 0;
+    int next = 0;
+    for (int i = 0; result == 0 && i < count; i++) {
+        const job_t* job = &jobs[first + i];
+        if (reuse[i] >= 0) {
+            pfxr_bank_sound_t sound;
+            pfxr_bank_get(old_bank, reuse[i], &sound);
+            result = pfxr_bank_builder_add_data(builder, job->name, &job->config, sound.format,
+                                                sound.sample_rate, sound.data, sound.sample_count);
+            continue;
+        }
+        
+        const pfxr_batch_result_t* wav = &results[next++];
+        const char* samples = wav->data ? (const char*)wav->data + pfxr_wav_header_size(sample_format) : NULL;
+        result = pfxr_bank_builder_add_data(builder, job->name, &job->config, (pfxr_bank_format_t)sample_format,
+                                            PFXR_SAMPLE_RATE, samples, wav->sample_count);
+        (*rendered)++;
+    }
+    pfxr_free_batch(results, render_count);
+    return result;
+}
+
+// ============================================================================
+// MERGE
+// ============================================================================
+
+typedef struct {
+    int index;
+    int count;
+    int sounds;
+    unsigned long long digest;
+} shard_info_t;
+
+// Open BANK.hashes and read its header and shard line
+static FILE* open_shard_hashes(const char* bank_path, shard_info_t* info) {
+    char path[4096 + 16];
+    char header[128];
+    char line[MAX_LINE];
+    snprintf(path, sizeof(path), "%s.hashes", bank_path);
+    hashes_header(header, sizeof(header));
+    
+    FILE* file = fopen(path, "r");
+    if (!file) return NULL;
+    if (!fgets(line, sizeof(line), file) || strcmp(line, header) != 0 ||
+        !fgets(line, sizeof(line), file) ||
+        sscanf(line, "# shard %d/%d sounds %d manifest %16llx", &info->index, &info->count, &info->sounds,
+               &info->digest) != 4) {
+        fclose(file);
+        return NULL;
+    }
+    return file;
+}
+
+// Take the sample format from a shard's hashes, so every shard and the
+// merged bank must share it
+static void read_shard_format(const char* bank_path) {
+    char path[4096 + 16];
+    char header[128];
+    char line[MAX_LINE];
+    snprintf(path, sizeof(path), "%s.hashes", bank_path);
+    
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+    if (fgets(line, sizeof(line), file)) {
+        for (int format = FORMAT_COUNT - 1; format >= 0; format--) {
+            sample_format = (pfxr_sample_format_t)format;
+            hashes_header(header, sizeof(header));
+            if (strcmp(line, header) == 0) break;
+        }
+    }
+    fclose(file);
+}
+
+// Copy one shard into the merged bank, checking every sound it lists
+static int merge_shard(pfxr_bank_builder_t* builder, const char* bank_path, FILE* hashes) {
+    pfxr_bank_t* bank = pfxr_bank_open(bank_path);
+    if (!bank) {
+        fprintf(stderr, "%s: not a valid bank\n", bank_path);
+        return -1;
+    }
+    
+    char line[MAX_LINE];
+    int listed = 0;
+    int result = 0;
+    while (result == 0 && fgets(line, sizeof(line), hashes)) {
+        unsigned long long key;
+        char name[MAX_LINE];
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%16llx %8191s", &key, name) != 2) {
+            result = -1;
+            break;
+        }
+        listed++;
+        
+        pfxr_bank_sound_t sound;
+        int index = pfxr_bank_find(bank, name);
+        if (index < 0 || pfxr_bank_get(bank, index, &sound) != 0) {
+            fprintf(stderr, "%s: missing %s\n", bank_path, name);
+            result = -1;
+        } else if (pfxr_sound_hash(&sound.config) != (uint64_t)key || pfxr_bank_verify(bank, index) != 0) {
+            fprintf(stderr, "%s: %s fails its checksum\n", bank_path, name);
+            result = -1;
+        } else if (pfxr_bank_builder_add_data(builder, name, &sound.config, sound.format, sound.sample_rate,
+                                              sound.data, sound.sample_count) != 0 ||
+                   push_job(name, &sound.config, (uint64_t)key) != 0) {
+            result = -1;
+        }
+    }
+    if (result == 0 && listed != pfxr_bank_count(bank)) {
+        fprintf(stderr, "%s: holds %d sounds but lists %d\n", bank_path, pfxr_bank_count(bank), listed);
+        result = -1;
+    }
+    pfxr_bank_close(bank);
+    return result;
+}
+
+static int merge_main(const char* output, char** shards, int count) {
+    double start = now_seconds();
+    shard_info_t first = { 0, 0, 0, 0 };
+    char* seen = NULL;
+    
+    // All shards must come from one manifest and cover every slice once
+    read_shard_format(shards[0]);
+    for (int s = 0; s < count; s++) {
+        shard_info_t info;
+        FILE* hashes = open_shard_hashes(shards[s], &info);
+        if (!hashes) {
+            fprintf(stderr, "%s: missing or unreadable %s.hashes\n", shards[s], shards[s]);
+            return 1;
+        }
+        fclose(hashes);
+        if (s == 0) {
+            first = info;
+            seen = (char*)calloc(info.count > 0 ? info.count : 1, 1);
+            if (!seen) return 1;
+        }
+        if (info.count != first.count || info.sounds != first.sounds || info.digest != first.digest ||
+            info.index < 0 || info.index >= info.count || seen[info.index]) {
+            fprintf(stderr, "%s: shard %d/%d does not belong with %s\n", shards[s], info.index, info.count,
+                    shards[0]);
+            free(seen);
+            return 1;
+        }
+        seen[info.index] = 1;
+    }
+    free(seen);
+    if (count != first.count) {
+        fprintf(stderr, "Have %d of %d shards\n", count, first.count);
+        return 1;
+    }
+    
+    pfxr_bank_builder_t* builder = pfxr_bank_builder_create(output);
+    if (!builder) {
+        fprintf(stderr, "Cannot create %s\n", output);
+        return 1;
+    }
+    for (int s = 0; s < count; s++) {
+        shard_info_t info;
+        FILE* hashes = open_shard_hashes(shards[s], &info);
+        int result = hashes ? merge_shard(builder, shards[s], hashes) : -1;
+        if (hashes) fclose(hashes);
+        if (result != 0) {
+            pfxr_bank_builder_discard(builder);
+            return 1;
+        }
+    }
+    if (job_count != first.sounds) {
+        fprintf(stderr, "Shards hold %d sounds, the manifest has %d\n", job_count, first.sounds);
+        pfxr_bank_builder_discard(builder);
+        return 1;
+    }
+    
+    if (pfxr_bank_builder_finish(builder) != 0) {
+        fprintf(stderr, "Failed to write %s (duplicate sound names?)\n", output);
+        return 1;
+    }
+    
+    char hashes_path[4096];
+    snprintf(hashes_path, sizeof(hashes_path), "%s.hashes", output);
+    manifest_sounds = first.sounds;
+    manifest_digest = (uint64_t)first.digest;
+    if (write_hashes(hashes_path) != 0) {
+        fprintf(stderr, "Failed to write %s\n", hashes_path);
+        return 1;
+    }
+    
+    printf("Merged %d shards into %s: %d sounds, all checksums verified, in %.2f s\n", count, output,
+           job_count, now_seconds() - start);
+    return 0;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-j THREADS] [--format FORMAT] [--shard I/N] -o BANK MANIFEST\n", program);
+    fprintf(stderr, "       %s merge -o BANK SHARD_BANK...\n", program);
+    fprintf(stderr, "  -j THREADS       Render threads (default: one per CPU)\n");
+    fprintf(stderr, "  --format FORMAT  pcm16 (default), pcm8, pcm24 or float\n");
+    fprintf(stderr, "  --shard I/N      Build slice I (from 0) of N\n");
+    fprintf(stderr, "  -o BANK          Bank to write; BANK.hashes is written next to it\n");
+}
+
+int main(int argc, char** argv) {
+    const char* output = NULL;
+    const char* manifest = NULL;
+    int threads = 0;
+    
+    if (argc > 1 && strcmp(argv[1], "merge") == 0) {
+        if (argc > 4 && strcmp(argv[2], "-o") == 0) {
+            return merge_main(argv[3], argv + 4, argc - 4);
+        }
+        usage(argv[0]);
+        return 1;
+    }
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            int format = 0;
+            while (format < FORMAT_COUNT && strcmp(format_names[format], name) != 0) format++;
+            if (format == FORMAT_COUNT) {
+                usage(argv[0]);
+                return 1;
+            }
+            sample_format = (pfxr_sample_format_t)format;
+        } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            char extra;
+            if (sscanf(argv[++i], "%d/%d%c", &shard_index, &shard_count, &extra) != 2 ||
+                shard_count < 1 || shard_index < 0 || shard_index >= shard_count) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] != '-' && !manifest) {
+            manifest = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!output || !manifest) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    double start = now_seconds();
+    if (read_manifest(manifest) != 0) return 1;
+    
+    char hashes_path[4096];
+    snprintf(hashes_path, sizeof(hashes_path), "%s.hashes", output);
+    pfxr_bank_t* old_bank = pfxr_bank_open(output);
+    if (old_bank) read_hashes(hashes_path);
+    
+    pfxr_bank_builder_t* builder = pfxr_bank_builder_create(output);
+    if (!builder) {
+        fprintf(stderr, "Cannot create %s\n", output);
+        return 1;
+    }
+    
+    int rendered = 0;
+    for (int first = 0; first < job_count; first += RENDER_CHUNK) {
+        int count = job_count - first < RENDER_CHUNK ? job_count - first : RENDER_CHUNK;
+        if (build_chunk(builder, old_bank, first, count, threads, &rendered) != 0) {
+            fprintf(stderr, "Failed to render or write sounds\n");
+            pfxr_bank_builder_discard(builder);
+            return 1;
+        }
+    }
+    
+    // The old bank stays mapped until the new one has replaced it
+    int result = pfxr_bank_builder_finish(builder);
+    pfxr_bank_close(old_bank);
+    if (result != 0) {
+        fprintf(stderr, "Failed to write %s (duplicate sound names?)\n", output);
+        return 1;
+    }
+    if (write_hashes(hashes_path) != 0) {
+        fprintf(stderr, "Failed to write %s\n", hashes_path);
+        return 1;
+    }
+    
+    printf("Wrote %s: %d sounds (%d rendered, %d unchanged) in %.2f s\n", output, job_count, rendered,
+           job_count - rendered, now_seconds() - start);
+    return 0;
+}